@@ -0,0 +1,145 @@
+/*  Tests of the shift estimation of image guiding
+    Copyright (C) 2026 agent <agent@local>
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+ */
+
+#include "test_imageautoguiding.h"
+
+#include "ekos/guide/internalguide/imageautoguiding.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+/// Side of the guide regions, in pixels
+int const regionAxis = 64;
+
+/// Largest error allowed on an estimated shift, in pixels
+double const shiftTolerance = 0.05;
+
+/// Stars of the synthetic field: x, y, amplitude, sigma. All stay inside the region when shifted by the test data.
+struct Star
+{
+    double x, y, amplitude, sigma;
+} const stars[] = {
+    { 20, 22, 1000, 1.5 }, { 40, 18, 600, 1.8 }, { 30, 40, 800, 1.3 }, { 45, 44, 400, 2.0 }, { 24, 34, 300, 1.6 },
+};
+}
+
+QVector<float> TestImageAutoGuiding::starField(int n, double dx, double dy) const
+{
+    QVector<float> image(n * n);
+
+    for (int y = 0; y < n; y++)
+    {
+        for (int x = 0; x < n; x++)
+        {
+            double value = 100;
+            for (const Star &star : stars)
+            {
+                double const rx = x - star.x - dx, ry = y - star.y - dy;
+                value += star.amplitude * std::exp(-(rx * rx + ry * ry) / (2 * star.sigma * star.sigma));
+            }
+            image[y * n + x] = static_cast<float>(value);
+        }
+    }
+
+    return image;
+}
+
+void TestImageAutoGuiding::testFFTRoundTrip()
+{
+    ImageAutoGuiding::FFT2D fft(regionAxis);
+    int const size = regionAxis * regionAxis;
+
+    QVector<float> const image = starField(regionAxis, 0.3, -0.7);
+    QVector<float> data(2 * size);
+    for (int i = 0; i < size; i++)
+    {
+        data[2 * i]     = image[i];
+        data[2 * i + 1] = static_cast<float>(std::sin(0.1 * i));
+    }
+
+    QVector<float> const original = data;
+    float largest = 0;
+    for (float value : original)
+        largest = std::max(largest, std::fabs(value));
+
+    fft.forward(data.data());
+    fft.inverse(data.data());
+
+    // The inverse transform is scaled by n * n, rounding errors scale with the largest value
+    for (int i = 0; i < 2 * size; i++)
+    {
+        float const value = data[i] / size;
+        if (std::fabs(value - original[i]) > 1e-5f * largest)
+            QFAIL(qPrintable(QString("Value %1 is %2 after the round trip, instead of %3").arg(i).arg(value).arg(original[i])));
+    }
+}
+
+void TestImageAutoGuiding::testFFTImpulse()
+{
+    ImageAutoGuiding::FFT2D fft(regionAxis);
+    int const size = regionAxis * regionAxis;
+
+    // An impulse at x, y transforms to e^(-2 pi i (kx x + ky y) / n)
+    int const x = 5, y = 3;
+    QVector<float> data(2 * size, 0.0f);
+    data[2 * (y * regionAxis + x)] = 1;
+    fft.forward(data.data());
+
+    for (int ky = 0; ky < regionAxis; ky++)
+    {
+        for (int kx = 0; kx < regionAxis; kx++)
+        {
+            double const angle = -2 * M_PI * (kx * x + ky * y) / regionAxis;
+            int const i = ky * regionAxis + kx;
+            QVERIFY(std::fabs(data[2 * i] - std::cos(angle)) < 1e-5);
+            QVERIFY(std::fabs(data[2 * i + 1] - std::sin(angle)) < 1e-5);
+        }
+    }
+}
+
+void TestImageAutoGuiding::testShift_data()
+{
+    QTest::addColumn<double>("dx");
+    QTest::addColumn<double>("dy");
+
+    QTest::newRow("none") << 0.0 << 0.0;
+    QTest::newRow("subpixel") << 0.3 << -0.2;
+    QTest::newRow("half pixel") << 0.5 << 0.5;
+    QTest::newRow("subpixel negative") << -0.25 << 0.75;
+    QTest::newRow("whole pixels") << 3.0 << -5.0;
+    QTest::newRow("multipixel") << 7.4 << 2.6;
+    QTest::newRow("multipixel negative") << -10.2 << -6.8;
+}
+
+void TestImageAutoGuiding::testShift()
+{
+    QFETCH(double, dx);
+    QFETCH(double, dy);
+
+    ImageAutoGuiding::ShiftEstimator estimator(regionAxis);
+    QVERIFY(estimator.hasReference() == false);
+
+    estimator.setReference(starField(regionAxis, 0, 0).constData());
+    QVERIFY(estimator.hasReference());
+
+    // Twice, the work buffers of the estimator are reused for the second frame
+    for (int frame = 0; frame < 2; frame++)
+    {
+        float xshift = 0, yshift = 0;
+        estimator.estimate(starField(regionAxis, dx, dy).constData(), &xshift, &yshift);
+
+        qDebug() << "Shift" << dx << dy << "estimated" << xshift << yshift;
+        QVERIFY(std::fabs(xshift - dx) < shiftTolerance);
+        QVERIFY(std::fabs(yshift - dy) < shiftTolerance);
+    }
+}
+
+QTEST_GUILESS_MAIN(TestImageAutoGuiding)
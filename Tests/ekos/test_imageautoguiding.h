@@ -0,0 +1,40 @@
+/*  Tests of the shift estimation of image guiding
+    Copyright (C) 2026 agent <agent@local>
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+ */
+
+#pragma once
+
+#include <QtTest/QtTest>
+#include <QVector>
+
+/**
+ * @class TestImageAutoGuiding
+ * @short Tests of ImageAutoGuiding::FFT2D and ImageAutoGuiding::ShiftEstimator
+ *
+ * A synthetic field of Gaussian stars is shifted by known amounts, from a fraction of pixel to
+ * several pixels, and the shifts estimated from the reference field must match them.
+ */
+class TestImageAutoGuiding : public QObject
+{
+    Q_OBJECT
+
+  public:
+    TestImageAutoGuiding() : QObject() {}
+    ~TestImageAutoGuiding() override = default;
+
+  private slots:
+    void testFFTRoundTrip();
+    void testFFTImpulse();
+
+    void testShift_data();
+    void testShift();
+
+  private:
+    /** @short Render the star field of n * n pixels, moved by dx, dy pixels */
+    QVector<float> starField(int n, double dx, double dy) const;
+};
@@ -0,0 +1,218 @@
+/*  Tests of the XY lists of stars sent to the solver
+    Copyright (C) 2026 agent <agent@local>
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+ */
+
+#include "test_fitsxylist.h"
+
+#include "fitsviewer/fitsdata.h"
+
+#include <QProcess>
+#include <QStandardPaths>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+
+#include <fitsio.h>
+
+namespace
+{
+/// Largest error allowed on the position of a synthetic star, in pixels
+double const positionTolerance = 0.1;
+
+/// Largest difference allowed between the solved centers, in pixels
+double const centerTolerance = 0.1;
+
+/// Angular distance between two RA, Dec positions, in degrees
+double angularDistance(const QPointF &a, const QPointF &b)
+{
+    double const d2r  = M_PI / 180.0;
+    double const cosd = std::sin(a.y() * d2r) * std::sin(b.y() * d2r) +
+                        std::cos(a.y() * d2r) * std::cos(b.y() * d2r) * std::cos((a.x() - b.x()) * d2r);
+    return std::acos(std::min(1.0, cosd)) / d2r;
+}
+}
+
+void TestFITSXYList::initTestCase()
+{
+    QVERIFY(m_Dir.isValid());
+}
+
+bool TestFITSXYList::writeStarField(const QString &filename, int width, int height, const QVector<QPointF> &stars)
+{
+    double const background = 1000, noise = 10, amplitude = 20000, sigma = 1.5;
+
+    std::mt19937 generator(42);
+    std::normal_distribution<double> gaussian(0, noise);
+
+    QVector<unsigned short> image(width * height);
+    for (int j = 0; j < height; j++)
+    {
+        for (int i = 0; i < width; i++)
+        {
+            double value = background + gaussian(generator);
+            for (const QPointF &star : stars)
+            {
+                // The center of pixel i, j is at i + 1, j + 1 in FITS pixel coordinates
+                double const dx = i + 1 - star.x(), dy = j + 1 - star.y();
+                value += amplitude * std::exp(-(dx * dx + dy * dy) / (2 * sigma * sigma));
+            }
+            image[j * width + i] = static_cast<unsigned short>(std::lround(std::min(value, 65535.0)));
+        }
+    }
+
+    fitsfile *fptr = nullptr;
+    int status = 0;
+    long naxes[2] = { width, height };
+
+    if (fits_create_file(&fptr, QString('!' + filename).toLocal8Bit(), &status) ||
+            fits_create_img(fptr, USHORT_IMG, 2, naxes, &status) ||
+            fits_write_img(fptr, TUSHORT, 1, image.size(), image.data(), &status))
+    {
+        fits_report_error(stderr, status);
+        status = 0;
+        if (fptr)
+            fits_close_file(fptr, &status);
+        return false;
+    }
+
+    fits_close_file(fptr, &status);
+    return status == 0;
+}
+
+QVector<QPointF> TestFITSXYList::readXYList(const QString &filename)
+{
+    QVector<QPointF> stars;
+    fitsfile *fptr = nullptr;
+    int status = 0, hdutype = 0;
+    long rows = 0;
+
+    if (fits_open_file(&fptr, filename.toLocal8Bit(), READONLY, &status) ||
+            fits_movabs_hdu(fptr, 2, &hdutype, &status) ||
+            fits_get_num_rows(fptr, &rows, &status))
+    {
+        fits_report_error(stderr, status);
+        status = 0;
+        if (fptr)
+            fits_close_file(fptr, &status);
+        return stars;
+    }
+
+    QVector<float> x(rows), y(rows);
+    if (fits_read_col(fptr, TFLOAT, 1, 1, 1, rows, nullptr, x.data(), nullptr, &status) ||
+            fits_read_col(fptr, TFLOAT, 2, 1, 1, rows, nullptr, y.data(), nullptr, &status))
+        fits_report_error(stderr, status);
+    else
+    {
+        for (long i = 0; i < rows; i++)
+            stars.append(QPointF(x[i], y[i]));
+    }
+
+    status = 0;
+    fits_close_file(fptr, &status);
+    return stars;
+}
+
+bool TestFITSXYList::solve(const QString &filename, const QStringList &extraArgs, QPointF &center, double &scale)
+{
+    QString const base = QFileInfo(filename).completeBaseName();
+    QStringList args;
+    args << "--no-plots" << "--overwrite" << "--crpix-center" << "--new-fits" << "none"
+         << "--dir" << m_Dir.path() << "--out" << base << extraArgs << filename;
+
+    QProcess solver;
+    solver.start(QStandardPaths::findExecutable("solve-field"), args);
+    if (!solver.waitForFinished(300000) || solver.exitCode() != 0)
+        return false;
+
+    QString const wcsFile = m_Dir.filePath(base + ".wcs");
+    if (!QFile::exists(wcsFile))
+        return false;
+
+    fitsfile *fptr = nullptr;
+    int status = 0;
+    double crval1 = 0, crval2 = 0, cd11 = 0, cd21 = 0;
+
+    fits_open_file(&fptr, wcsFile.toLocal8Bit(), READONLY, &status);
+    fits_read_key(fptr, TDOUBLE, "CRVAL1", &crval1, nullptr, &status);
+    fits_read_key(fptr, TDOUBLE, "CRVAL2", &crval2, nullptr, &status);
+    fits_read_key(fptr, TDOUBLE, "CD1_1", &cd11, nullptr, &status);
+    fits_read_key(fptr, TDOUBLE, "CD2_1", &cd21, nullptr, &status);
+    if (status)
+        fits_report_error(stderr, status);
+    int closeStatus = 0;
+    if (fptr)
+        fits_close_file(fptr, &closeStatus);
+
+    // The reference pixel is at the center of the frame
+    center = QPointF(crval1, crval2);
+    scale  = std::hypot(cd11, cd21);
+    return status == 0;
+}
+
+void TestFITSXYList::testStarPositions()
+{
+    QVector<QPointF> const stars = { QPointF(40.0, 30.0), QPointF(120.25, 45.5), QPointF(75.7, 110.3),
+                                     QPointF(160.5, 120.0)
+                                   };
+    QString const frame  = m_Dir.filePath("stars.fits");
+    QString const xyList = m_Dir.filePath("stars.xyls");
+
+    QVERIFY(writeStarField(frame, 200, 150, stars));
+
+    FITSData data(FITS_FOCUS);
+    QVERIFY(data.loadFITS(frame).result());
+    QCOMPARE(data.saveXYList(xyList, 100), stars.size());
+
+    QVector<QPointF> const listed = readXYList(xyList);
+    QCOMPARE(listed.size(), stars.size());
+
+    for (const QPointF &star : stars)
+    {
+        double nearest = std::numeric_limits<double>::max();
+        for (const QPointF &entry : listed)
+            nearest = std::min(nearest, std::hypot(entry.x() - star.x(), entry.y() - star.y()));
+
+        if (nearest > positionTolerance)
+            QFAIL(qPrintable(QString("Star at %1, %2 is listed %3 pixels away").arg(star.x()).arg(star.y()).arg(nearest)));
+    }
+}
+
+void TestFITSXYList::testSolvedCenter()
+{
+    QString const frame = QString::fromLocal8Bit(qgetenv("KSTARS_TEST_SOLVER_IMAGE"));
+
+    if (QStandardPaths::findExecutable("solve-field").isEmpty())
+        QSKIP("astrometry.net solve-field is not installed");
+    if (frame.isEmpty() || !QFile::exists(frame))
+        QSKIP("KSTARS_TEST_SOLVER_IMAGE does not name a frame to solve");
+
+    // Focus frames skip reading the WCS of the frame, which the XY list does not need
+    FITSData data(FITS_FOCUS);
+    QVERIFY(data.loadFITS(frame).result());
+
+    QString const xyList = m_Dir.filePath("solver.xyls");
+    QVERIFY(data.saveXYList(xyList, 300) > 0);
+
+    QPointF frameCenter, listCenter;
+    double frameScale = 0, listScale = 0;
+
+    QVERIFY(solve(frame, QStringList(), frameCenter, frameScale));
+    QVERIFY(solve(xyList,
+                  QStringList() << "--width" << QString::number(data.width()) << "--height" << QString::number(data.height())
+                  << "--x-column" << "X" << "--y-column" << "Y" << "--sort-column" << "FLUX",
+                  listCenter, listScale));
+
+    double const distance = angularDistance(frameCenter, listCenter);
+    if (distance > centerTolerance * frameScale)
+        QFAIL(qPrintable(QString("Centers solved from the frame and from its stars are %1 pixels apart")
+                         .arg(distance / frameScale)));
+}
+
+QTEST_GUILESS_MAIN(TestFITSXYList)
@@ -0,0 +1,58 @@
+/*  Tests of the XY lists of stars sent to the solver
+    Copyright (C) 2026 agent <agent@local>
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+ */
+
+#pragma once
+
+#include <QtTest/QtTest>
+#include <QPointF>
+#include <QString>
+#include <QTemporaryDir>
+#include <QVector>
+
+/**
+ * @class TestFITSXYList
+ * @short Tests of FITSData::saveXYList()
+ *
+ * Stars of a synthetic frame must be listed at their FITS pixel coordinates, where the center of
+ * the first pixel is at 1,1.
+ *
+ * If astrometry.net solve-field is installed and KSTARS_TEST_SOLVER_IMAGE names a FITS frame it
+ * can solve, the center solved from the XY list of the frame is also compared with the center
+ * solved from the frame itself.
+ */
+class TestFITSXYList : public QObject
+{
+    Q_OBJECT
+
+  public:
+    TestFITSXYList() : QObject() {}
+    ~TestFITSXYList() override = default;
+
+  private slots:
+    void initTestCase();
+
+    void testStarPositions();
+    void testSolvedCenter();
+
+  private:
+    /** @short Write a 16-bit frame with Gaussian stars at the given FITS pixel coordinates */
+    bool writeStarField(const QString &filename, int width, int height, const QVector<QPointF> &stars);
+
+    /** @short Read the X and Y columns of an XY list */
+    QVector<QPointF> readXYList(const QString &filename);
+
+    /**
+     * @short Solve a frame or an XY list with solve-field
+     * @param center set to the RA and Dec of the center of the frame, in degrees
+     * @param scale set to the pixel scale, in degrees
+     */
+    bool solve(const QString &filename, const QStringList &extraArgs, QPointF &center, double &scale);
+
+    QTemporaryDir m_Dir;
+};
@@ -0,0 +1,231 @@
+/*  Ekos Scheduler simulation tests
+    Copyright (C) 2026 agent <agent@local>
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+ */
+
+#include "test_schedulersimulation.h"
+
+#include "kstarsdata.h"
+#include "Options.h"
+#include "ekos/scheduler/schedulerjob.h"
+#include "time/simclock.h"
+
+#include <QDir>
+#include <QElapsedTimer>
+#include <QStandardPaths>
+
+#include <algorithm>
+#include <numeric>
+
+namespace
+{
+/// Folder of the sequence files referenced by the scheduler lists, see readme.txt
+QString const sequenceFolder("/tmp/kstars_tests");
+
+/// Folder of the captures of the sequence files
+QString const captureFolder("/var/tmp/kstars_tests");
+
+/// Safeguard against a scheduler that would never advance the simulation
+int const maxEvaluations = 500;
+}
+
+void TestSchedulerSimulation::initTestCase()
+{
+    // Do not pollute the configuration and data of the user
+    QStandardPaths::setTestModeEnabled(true);
+
+    KStarsData * const data = KStarsData::Create();
+    QVERIFY(data != nullptr);
+    if (!data->initialize())
+        QSKIP("KStars data files are not installed, cannot simulate the scheduler.");
+
+    // Captures are simulated, so there is no progress to remember from storage
+    Options::setRememberJobProgress(false);
+    Options::setSortSchedulerJobs(false);
+
+    // Copy test vectors to a folder of our own, pointing them at it instead of the folders of readme.txt
+    QVERIFY(testFolder.isValid());
+    QDir const source(KSTARS_SCHEDULER_TEST_DIR);
+    for (QString const &file : source.entryList(QStringList() << "*.esq" << "*.esl", QDir::Files))
+    {
+        QFile input(source.filePath(file));
+        QVERIFY(input.open(QIODevice::ReadOnly | QIODevice::Text));
+        QString contents = QString::fromUtf8(input.readAll());
+
+        // The capture folder is replaced first, as it contains the sequence folder
+        contents.replace(captureFolder, testFolder.filePath("captures"));
+        contents.replace(sequenceFolder, testFolder.path());
+
+        QFile output(testFolder.filePath(file));
+        QVERIFY(output.open(QIODevice::WriteOnly | QIODevice::Text));
+        QVERIFY(output.write(contents.toUtf8()) >= 0);
+    }
+
+    // The simulated night starts at local noon and lasts a full day, twilight included
+    nightStart = QDateTime(QDate(2019, 11, 15), QTime(12, 0), Qt::LocalTime);
+    nightEnd = nightStart.addDays(1);
+
+    // Freeze the clock, the harness moves it manually
+    data->clock()->setManualMode(true);
+    data->clock()->stop();
+}
+
+void TestSchedulerSimulation::setLocalTime(QDateTime const &lt)
+{
+    KStarsData * const data = KStarsData::Instance();
+    data->changeDateTime(data->geo()->LTtoUT(KStarsDateTime(lt)));
+}
+
+void TestSchedulerSimulation::addSchedulerFiles()
+{
+    QTest::addColumn<QString>("file");
+
+    for (QString const &file : QDir(testFolder.path()).entryList(QStringList() << "*.esl", QDir::Files, QDir::Name))
+        QTest::newRow(file.toLatin1().constData()) << testFolder.filePath(file);
+}
+
+QDateTime TestSchedulerSimulation::simulateJob(Ekos::Scheduler &scheduler, QDateTime const &end)
+{
+    SchedulerJob * const job = scheduler.currentJob;
+    QDateTime const startup = KStarsData::Instance()->lt();
+
+    job->setState(SchedulerJob::JOB_BUSY);
+
+    // Stub devices complete the job in exactly the time that was estimated for it
+    QDateTime completion;
+    switch (job->getCompletionCondition())
+    {
+        case SchedulerJob::FINISH_AT:
+            completion = job->getCompletionTime();
+            break;
+
+        case SchedulerJob::FINISH_LOOP:
+            completion = end;
+            break;
+
+        case SchedulerJob::FINISH_SEQUENCE:
+        case SchedulerJob::FINISH_REPEAT:
+        default:
+            if (0 < job->getEstimatedTime())
+                completion = startup.addSecs(job->getEstimatedTime());
+            break;
+    }
+
+    // Unknown durations still consume one minute, so that the simulation moves forward
+    if (!completion.isValid() || completion <= startup)
+        completion = startup.addSecs(60);
+    if (end < completion)
+        completion = end;
+
+    setLocalTime(completion);
+
+    job->setRepeatsRemaining(0);
+    job->setState(SchedulerJob::JOB_COMPLETE);
+    job->setStage(SchedulerJob::STAGE_IDLE);
+    scheduler.setCurrentJob(nullptr);
+
+    return completion;
+}
+
+void TestSchedulerSimulation::testNight_data()
+{
+    addSchedulerFiles();
+}
+
+void TestSchedulerSimulation::testNight()
+{
+    QFETCH(QString, file);
+
+    Ekos::Scheduler scheduler;
+    QVERIFY(scheduler.loadScheduler(file));
+
+    setLocalTime(nightStart);
+    scheduler.state = Ekos::SCHEDULER_RUNNING;
+
+    QList<Pick> picks;
+    QList<qint64> latencies;
+    qint64 idleSeconds = 0;
+
+    QDateTime now = KStarsData::Instance()->lt();
+    while (now < nightEnd && latencies.size() < maxEvaluations)
+    {
+        QElapsedTimer timer;
+        timer.start();
+        scheduler.evaluateJobs();
+        latencies.append(timer.nsecsElapsed());
+
+        SchedulerJob const * const job = scheduler.currentJob;
+        if (job == nullptr)
+            break;
+
+        // Stub mount is there instantly, the scheduler would sleep until startup otherwise
+        QDateTime const startup = std::max(now, job->getStartupTime());
+        if (!startup.isValid() || nightEnd <= startup)
+            break;
+
+        idleSeconds += now.secsTo(startup);
+        setLocalTime(startup);
+
+        QString const name = job->getName();
+        QDateTime const completion = simulateJob(scheduler, nightEnd);
+
+        // Jobs are run one at a time, and never before they are picked
+        QVERIFY(picks.isEmpty() || picks.last().completion <= startup);
+        QVERIFY(now <= startup);
+
+        picks.append({ name, startup, completion });
+        now = completion;
+    }
+
+    QVERIFY(!latencies.isEmpty());
+    QVERIFY(latencies.size() < maxEvaluations);
+
+    qint64 const total = std::accumulate(latencies.begin(), latencies.end(), static_cast<qint64>(0));
+    qint64 const worst = *std::max_element(latencies.begin(), latencies.end());
+
+    qInfo() << QString("%1: %2 evaluations, %3 ms average, %4 ms worst, %5 jobs picked, %6 minutes idle.")
+            .arg(QFileInfo(file).fileName())
+            .arg(latencies.size())
+            .arg(total / latencies.size() / 1e6, 0, 'f', 2)
+            .arg(worst / 1e6, 0, 'f', 2)
+            .arg(picks.size())
+            .arg(idleSeconds / 60);
+
+    for (Pick const &pick : picks)
+        qInfo() << QString("  %1 - %2 %3")
+                .arg(pick.startup.toString("hh:mm"))
+                .arg(pick.completion.toString("hh:mm"))
+                .arg(pick.name);
+}
+
+void TestSchedulerSimulation::benchmarkEvaluation_data()
+{
+    addSchedulerFiles();
+}
+
+void TestSchedulerSimulation::benchmarkEvaluation()
+{
+    QFETCH(QString, file);
+
+    Ekos::Scheduler scheduler;
+    QVERIFY(scheduler.loadScheduler(file));
+
+    // Evaluate from dusk, where the search for a startup time covers the whole night
+    setLocalTime(nightStart.addSecs(6 * 3600));
+
+    QBENCHMARK
+    {
+        // Reset states so that each evaluation starts from scratch
+        for (SchedulerJob * const job : scheduler.jobs)
+            job->reset();
+
+        scheduler.jobEvaluationOnly = true;
+        scheduler.evaluateJobs();
+    }
+}
+
+QTEST_MAIN(TestSchedulerSimulation)
@@ -0,0 +1,72 @@
+/*  Ekos Scheduler simulation tests
+    Copyright (C) 2026 agent <agent@local>
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+ */
+
+#pragma once
+
+#include <QtTest/QtTest>
+#include <QDateTime>
+#include <QList>
+#include <QString>
+#include <QTemporaryDir>
+
+#define UNIT_TEST
+
+#include "ekos/scheduler/scheduler.h"
+
+/**
+ * @class TestSchedulerSimulation
+ * @short Headless harness driving the Ekos Scheduler through a simulated night.
+ *
+ * Each scheduler list of the test folder is loaded in a scheduler, and the KStars simulation clock
+ * is moved manually from one evaluation to the next. Mount, guide and capture modules are not
+ * involved: once a job is selected, the harness jumps to its startup time and plays its capture
+ * as if devices had run it for its estimated duration.
+ *
+ * The harness reports latency of each evaluation, the jobs that were picked and the idle gaps
+ * between them, so that scheduling regressions become visible in the test output.
+ */
+class TestSchedulerSimulation : public QObject
+{
+    Q_OBJECT
+
+  public:
+    TestSchedulerSimulation() : QObject() {}
+    ~TestSchedulerSimulation() override = default;
+
+  private slots:
+    void initTestCase();
+
+    void testNight_data();
+    void testNight();
+
+    void benchmarkEvaluation_data();
+    void benchmarkEvaluation();
+
+  private:
+    typedef struct
+    {
+        QString name;
+        QDateTime startup;
+        QDateTime completion;
+    } Pick;
+
+    /** @brief Move the simulation clock to the argument local time. */
+    void setLocalTime(QDateTime const &lt);
+
+    /** @brief Play the capture of the current job, as stub devices would, and return its completion time. */
+    QDateTime simulateJob(Ekos::Scheduler &scheduler, QDateTime const &nightEnd);
+
+    void addSchedulerFiles();
+
+    QDateTime nightStart;
+    QDateTime nightEnd;
+
+    /** Copies of the test vectors, and their captures */
+    QTemporaryDir testFolder;
+};
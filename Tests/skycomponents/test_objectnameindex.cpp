@@ -0,0 +1,163 @@
+/***************************************************************************
+                 test_objectnameindex.cpp  -  KStars Planetarium
+                             -------------------
+    begin                : 2026-10-18
+    copyright            : (C) 2026 by agent
+    email                : agent@local
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "test_objectnameindex.h"
+
+#include <QThreadPool>
+
+void TestObjectNameIndex::init()
+{
+    addObject(SkyObject::GALAXY, "M 31", "Andromeda Galaxy");
+    addObject(SkyObject::GALAXY, "M 33", "Triangulum Galaxy");
+    addObject(SkyObject::GALAXY, "NGC 7331");
+    addObject(SkyObject::GLOBULAR_CLUSTER, "M 3");
+    addObject(SkyObject::GLOBULAR_CLUSTER, "NGC 5139", "Omega Centauri");
+    addObject(SkyObject::STAR, "Vega", "alpha Lyrae");
+    addObject(SkyObject::STAR, "Mirach", "beta Andromedae");
+}
+
+void TestObjectNameIndex::cleanup()
+{
+    m_Lists.clear();
+    m_Objects.clear();
+}
+
+void TestObjectNameIndex::addObject(int type, const QString &name, const QString &name2)
+{
+    std::shared_ptr<SkyObject> object(new SkyObject(type, 0.0, 0.0, 0.0, name, name2));
+    m_Objects.append(object);
+
+    m_Lists[type].append(ObjectNameIndex::Entry(name, object.get()));
+    if (!name2.isEmpty())
+        m_Lists[type].append(ObjectNameIndex::Entry(name2, object.get()));
+}
+
+QStringList TestObjectNameIndex::names(const QVector<ObjectNameIndex::Entry> &entries)
+{
+    QStringList result;
+    for (const ObjectNameIndex::Entry &entry : entries)
+        result.append(entry.first);
+    return result;
+}
+
+QStringList TestObjectNameIndex::sortedNames(const QVector<ObjectNameIndex::Entry> &entries)
+{
+    QStringList result = names(entries);
+    result.sort();
+    return result;
+}
+
+QVector<ObjectNameIndex::Entry> TestObjectNameIndex::search(const QString &text, const QList<int> &types)
+{
+    ObjectNameIndex index(m_Lists);
+
+    // The lists are scanned until the tables are built in the background
+    QVector<ObjectNameIndex::Entry> const scanned = index.search(text, types);
+
+    index.update();
+    QThreadPool::globalInstance()->waitForDone();
+    QVector<ObjectNameIndex::Entry> const indexed = index.search(text, types);
+
+    // Matches are sorted by name in the tables only, so compare the names found
+    if (sortedNames(scanned) != sortedNames(indexed))
+    {
+        QString const message = QString("Searching '%1' found %2 in the lists, and %3 in the tables")
+                                .arg(text, names(scanned).join(", "), names(indexed).join(", "));
+        QTest::qFail(qPrintable(message), __FILE__, __LINE__);
+    }
+
+    return indexed;
+}
+
+void TestObjectNameIndex::testPrefix()
+{
+    // Names are compared without case and spaces
+    QCOMPARE(sortedNames(search("m3")), QStringList({ "M 3", "M 31", "M 33" }));
+    QCOMPARE(sortedNames(search("M 3")), QStringList({ "M 3", "M 31", "M 33" }));
+    QCOMPARE(names(search("m31")), QStringList({ "M 31" }));
+    QCOMPARE(sortedNames(search("ngc")), QStringList({ "NGC 5139", "NGC 7331" }));
+
+    // Names of the same type are sorted
+    QCOMPARE(names(search("m3", { SkyObject::GALAXY })), QStringList({ "M 31", "M 33" }));
+
+    // A single character finds the start of names only, not "NGC 7331", "Andromeda Galaxy" or "Omega Centauri"
+    QCOMPARE(sortedNames(search("m")), QStringList({ "M 3", "M 31", "M 33", "Mirach" }));
+
+    QVERIFY(search("x").isEmpty());
+    QVERIFY(search("").isEmpty());
+}
+
+void TestObjectNameIndex::testSubstring()
+{
+    QCOMPARE(names(search("331")), QStringList({ "NGC 7331" }));
+    QCOMPARE(sortedNames(search("galaxy")), QStringList({ "Andromeda Galaxy", "Triangulum Galaxy" }));
+
+    // Names starting with the text come first, then names containing it
+    QCOMPARE(names(search("andromed")), QStringList({ "Andromeda Galaxy", "beta Andromedae" }));
+
+    // Texts shorter than 3 characters are not searched inside names
+    QVERIFY(search("31").isEmpty());
+    QVERIFY(search("313").isEmpty());
+}
+
+void TestObjectNameIndex::testName2()
+{
+    QVector<ObjectNameIndex::Entry> const omega = search("omega cen");
+    QCOMPARE(omega.size(), 1);
+    QCOMPARE(omega.first().first, QString("Omega Centauri"));
+    QCOMPARE(omega.first().second->name(), QString("NGC 5139"));
+
+    QVector<ObjectNameIndex::Entry> const lyrae = search("lyrae");
+    QCOMPARE(lyrae.size(), 1);
+    QCOMPARE(lyrae.first().second->name(), QString("Vega"));
+
+    ObjectNameIndex index(m_Lists);
+    for (int pass = 0; pass < 2; pass++)
+    {
+        const SkyObject *vega = index.find("Alpha Lyrae");
+        QVERIFY(vega != nullptr);
+        QCOMPARE(vega->name(), QString("Vega"));
+        QVERIFY(index.find("vega") == vega);
+        QVERIFY(index.find("alpha") == nullptr);
+
+        // Second pass with the tables
+        index.update();
+        QThreadPool::globalInstance()->waitForDone();
+    }
+}
+
+void TestObjectNameIndex::testTypes()
+{
+    QCOMPARE(names(search("m3", { SkyObject::GLOBULAR_CLUSTER })), QStringList({ "M 3" }));
+    QCOMPARE(names(search("galaxy", { SkyObject::GALAXY, SkyObject::STAR })).size(), 2);
+    QVERIFY(search("m3", { SkyObject::STAR }).isEmpty());
+    QVERIFY(search("galaxy", { SkyObject::GLOBULAR_CLUSTER }).isEmpty());
+}
+
+void TestObjectNameIndex::testApproximate()
+{
+    ObjectNameIndex index(m_Lists);
+    index.update();
+    QThreadPool::globalInstance()->waitForDone();
+
+    // No name contains the text, the names sharing most of its trigrams are returned
+    QVector<ObjectNameIndex::Entry> const found = index.search("triangulum galxy");
+    QVERIFY(!found.isEmpty());
+    QCOMPARE(found.first().first, QString("Triangulum Galaxy"));
+}
+
+QTEST_GUILESS_MAIN(TestObjectNameIndex)
@@ -0,0 +1,67 @@
+/***************************************************************************
+                 test_objectnameindex.h  -  KStars Planetarium
+                             -------------------
+    begin                : 2026-10-18
+    copyright            : (C) 2026 by agent
+    email                : agent@local
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#pragma once
+
+#include <QtTest/QtTest>
+
+#define UNIT_TEST
+
+#include "skycomponents/objectnameindex.h"
+#include "skyobjects/skyobject.h"
+
+#include <memory>
+
+/**
+ * @class TestObjectNameIndex
+ * @short Tests of the name searches of ObjectNameIndex
+ *
+ * Each search runs twice: while the tables are not built, when the object lists are scanned, and
+ * once the tables are built. Both must give the same objects. Approximate searches only use the tables.
+ */
+class TestObjectNameIndex : public QObject
+{
+    Q_OBJECT
+
+  public:
+    TestObjectNameIndex() : QObject() {}
+    ~TestObjectNameIndex() override = default;
+
+  private slots:
+    void init();
+    void cleanup();
+
+    void testPrefix();
+    void testSubstring();
+    void testName2();
+    void testTypes();
+    void testApproximate();
+
+  private:
+    /** @short Add an object to the lists, under its name and its secondary name */
+    void addObject(int type, const QString &name, const QString &name2 = QString());
+
+    /** @short Search without tables, then with tables, and check both give the same objects */
+    QVector<ObjectNameIndex::Entry> search(const QString &text, const QList<int> &types = QList<int>());
+
+    /** @return the names of the entries */
+    static QStringList names(const QVector<ObjectNameIndex::Entry> &entries);
+    static QStringList sortedNames(const QVector<ObjectNameIndex::Entry> &entries);
+
+    QList<std::shared_ptr<SkyObject>> m_Objects;
+    ObjectNameIndex::ObjectLists m_Lists;
+};
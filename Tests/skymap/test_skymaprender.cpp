@@ -0,0 +1,200 @@
+/*  Sky map rendering benchmark
+    Copyright (C) 2026 agent <agent@local>
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+ */
+
+#include "test_skymaprender.h"
+
+#include "binfilehelper.h"
+#include "kstars.h"
+#include "kstarsdata.h"
+#include "Options.h"
+#include "skymap.h"
+#include "skymapprofiler.h"
+#include "starcomponent.h"
+#include "hips/hipsmanager.h"
+#include "projections/projector.h"
+
+#include <KTipDialog>
+
+#include <QElapsedTimer>
+#include <QImage>
+#include <QStandardPaths>
+
+namespace
+{
+/// Size of the rendered sky image, in pixels
+QSize const imageSize(1280, 800);
+
+/// Number of renders allowed for the background loading of deep stars to settle before measuring
+int const maxLoadPasses = 10;
+
+/// HiPS source used by the HiPS view, installed with the default sources
+QString const hipsSource("DSS colored");
+
+/// Kinds of views, some of which need optional data
+enum ViewKind
+{
+    CATALOG_VIEW,
+    USNO_VIEW,
+    HIPS_VIEW
+};
+
+/// Show every component the sky map can draw
+void showAllComponents(bool show)
+{
+    Options::setShowStars(show);
+    Options::setShowDeepSky(show);
+    Options::setShowMessier(show);
+    Options::setShowNGC(show);
+    Options::setShowIC(show);
+    Options::setShowSolarSystem(show);
+    Options::setShowAsteroids(show);
+    Options::setShowComets(show);
+    Options::setShowMilkyWay(show);
+    Options::setShowCLines(show);
+    Options::setShowCNames(show);
+    Options::setShowCBounds(show);
+    Options::setShowEquatorialGrid(show);
+    Options::setShowHorizontalGrid(show);
+    Options::setShowEcliptic(show);
+    Options::setShowEquator(show);
+    Options::setShowGround(show);
+    Options::setShowSatellites(show);
+    Options::setShowSupernovae(show);
+    Options::setShowStarNames(show);
+}
+}
+
+Q_DECLARE_METATYPE(ViewKind)
+
+void TestSkyMapRender::initTestCase()
+{
+    // Do not pollute the configuration and data of the user
+    QStandardPaths::setTestModeEnabled(true);
+
+    KTipDialog::setShowOnStart(false);
+    kstars = KStars::createInstance(false, false);
+    QVERIFY(kstars != nullptr);
+    QTRY_VERIFY_WITH_TIMEOUT(kstars->isGUIReady(), 60000);
+
+    if (KStarsData::Instance()->skyComposite() == nullptr)
+        QSKIP("KStars data files are not installed, cannot render the sky map.");
+
+    // Render every frame in full, at the most expensive settings
+    Options::setUseAltAz(true);
+    Options::setHideOnSlew(false);
+    Options::setStarDensity(5);
+    Options::setShowHIPS(false);
+
+    SkyMapProfiler::Instance()->setEnabled(true);
+}
+
+void TestSkyMapRender::cleanupTestCase()
+{
+    SkyMapProfiler::Instance()->setEnabled(false);
+
+    if (kstars)
+    {
+        kstars->close();
+        delete kstars;
+        kstars = nullptr;
+    }
+}
+
+void TestSkyMapRender::benchmarkRender_data()
+{
+    QTest::addColumn<ViewKind>("kind");
+    QTest::addColumn<int>("projection");
+    QTest::addColumn<double>("zoom");
+
+    QTest::newRow("wide field, all catalogs") << CATALOG_VIEW << static_cast<int>(Projector::Lambert) << double(MINZOOM);
+    QTest::newRow("deep zoom, USNO NOMAD") << USNO_VIEW << static_cast<int>(Projector::Lambert) << 250000.0;
+    QTest::newRow("HiPS") << HIPS_VIEW << static_cast<int>(Projector::Lambert) << 5000.0;
+
+    QTest::newRow("Lambert") << CATALOG_VIEW << static_cast<int>(Projector::Lambert) << 1000.0;
+    QTest::newRow("Azimuthal equidistant") << CATALOG_VIEW << static_cast<int>(Projector::AzimuthalEquidistant) << 1000.0;
+    QTest::newRow("Orthographic") << CATALOG_VIEW << static_cast<int>(Projector::Orthographic) << 1000.0;
+    QTest::newRow("Equirectangular") << CATALOG_VIEW << static_cast<int>(Projector::Equirectangular) << 1000.0;
+    QTest::newRow("Stereographic") << CATALOG_VIEW << static_cast<int>(Projector::Stereographic) << 1000.0;
+    QTest::newRow("Gnomonic") << CATALOG_VIEW << static_cast<int>(Projector::Gnomonic) << 1000.0;
+}
+
+void TestSkyMapRender::benchmarkRender()
+{
+    if (kstars == nullptr || KStarsData::Instance()->skyComposite() == nullptr)
+        QSKIP("KStars is not running, cannot render the sky map.");
+
+    QFETCH(ViewKind, kind);
+    QFETCH(int, projection);
+    QFETCH(double, zoom);
+
+    if (kind == USNO_VIEW && !BinFileHelper::testFileExists("USNO-NOMAD-1e8.dat"))
+        QSKIP("USNO NOMAD catalog is not installed, skipping the deep zoom view.");
+
+    showAllComponents(true);
+    if (kind == HIPS_VIEW)
+    {
+        if (!HIPSManager::Instance()->setCurrentSource(hipsSource))
+            QSKIP("HiPS source is not available, skipping the HiPS view.");
+        Options::setShowHIPS(true);
+    }
+    Options::setProjection(projection);
+
+    SkyMap *map = SkyMap::Instance();
+    map->resize(imageSize);
+    map->setFocusAltAz(dms(45.0), dms(180.0));
+    map->setZoomFactor(zoom);
+    map->setupProjector();
+
+    QImage image(imageSize, QImage::Format_ARGB32_Premultiplied);
+    SkyMapProfiler *profiler = SkyMapProfiler::Instance();
+
+    // Render outside the benchmark until the deep star catalogs have nothing left to load in the background,
+    // so that neither catalog loading nor a partially filled view is measured
+    for (int pass = 0; pass < maxLoadPasses; pass++)
+    {
+        map->exportSkyImage(&image);
+        if (!StarComponent::Instance()->waitForPendingLoads())
+            break;
+    }
+
+    QMap<QString, double> sections;
+    double totalTime = 0;
+    qint64 totalDrawn = 0;
+    int frames = 0;
+
+    QBENCHMARK
+    {
+        QElapsedTimer timer;
+        timer.start();
+
+        profiler->beginFrame();
+        map->exportSkyImage(&image);
+        profiler->endFrame();
+
+        totalTime += timer.nsecsElapsed() / 1.0e6;
+        totalDrawn += profiler->lastFrameCount(SkyMapProfiler::DRAWN);
+        for (const auto &section : profiler->lastFrameSections())
+            sections[section.first] += section.second;
+        frames++;
+    }
+
+    if (kind == HIPS_VIEW)
+    {
+        Options::setShowHIPS(false);
+        HIPSManager::Instance()->setCurrentSource("None");
+    }
+
+    QVERIFY(frames > 0);
+    qInfo("%s: %.1f fps, %lld objects drawn", QTest::currentDataTag(), totalTime > 0 ? 1000.0 * frames / totalTime : 0.0,
+          static_cast<long long>(totalDrawn / frames));
+    for (auto section = sections.constBegin(); section != sections.constEnd(); ++section)
+        qInfo("    %-20s %8.2f ms", qPrintable(section.key()), section.value() / frames);
+}
+
+QTEST_MAIN(TestSkyMapRender)
@@ -0,0 +1,49 @@
+/*  Sky map rendering benchmark
+    Copyright (C) 2026 agent <agent@local>
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+ */
+
+#pragma once
+
+#include <QtTest/QtTest>
+#include <QMap>
+#include <QString>
+
+class KStars;
+
+/**
+ * @class TestSkyMapRender
+ * @short Headless benchmark of the sky map rendering.
+ *
+ * A KStars instance is started offscreen, and scripted views are rendered with SkyQPainter into
+ * an offscreen image, through SkyMapDrawAbstract::exportSkyImage(). Views cover a wide field with
+ * all catalogs, a deep zoom into the USNO NOMAD catalog, HiPS, and each projection.
+ *
+ * QBENCHMARK reports the time per frame. The harness also reports the frame rate, the objects
+ * drawn and the average time spent in each sky component, as timed by SkyMapProfiler.
+ *
+ * Views depending on optional data, the USNO NOMAD catalog or HiPS sources, are skipped if the
+ * data is not installed.
+ */
+class TestSkyMapRender : public QObject
+{
+    Q_OBJECT
+
+  public:
+    TestSkyMapRender() : QObject() {}
+    ~TestSkyMapRender() override = default;
+
+  private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void benchmarkRender_data();
+    void benchmarkRender();
+
+  private:
+    KStars *kstars { nullptr };
+};
@@ -20,6 +20,8 @@
 #include "ksnumbers.h"
 #include "time/kstarsdatetime.h"
 #include "auxiliary/dms.h"
+#include "skyobjects/starobject.h"
+#include "Options.h"
 
 void TestSkyPoint::testPrecession()
 {
@@ -93,4 +95,96 @@ void TestSkyPoint::testPrecession()
     verify(p, 169.71785991, 45.30132855, arcsecPrecision);
 }
 
+void TestSkyPoint::testAberration()
+{
+    /*
+     * NOTE: This is example 23.a of Jean Meeus, "Astronomical Algorithms", 2nd edition:
+     * theta Persei at 2028 November 13.19 TD, from its mean place of date.
+     */
+
+    constexpr double arcsecPrecision = 0.01;
+
+    KSNumbers num(2462088.69);
+    double const ra  = 15.0 * (2 + 46 / 60.0 + 11.331 / 3600.0);
+    double const dec = 49 + 20 / 60.0 + 54.54 / 3600.0;
+
+    SkyPoint p(dms(ra), dms(dec));
+    p.aberrate(&num);
+
+    double const dRA  = (p.ra().Degrees() - ra) * 3600.0;
+    double const dDec = (p.dec().Degrees() - dec) * 3600.0;
+    qDebug() << "Aberration:" << dRA << dDec;
+    QVERIFY(fabs(dRA - 30.045) < arcsecPrecision);
+    QVERIFY(fabs(dDec - 6.697) < arcsecPrecision);
+}
+
+void TestSkyPoint::testStarApparentVector()
+{
+    // The deflection of light needs the Sun, and is not computed in vector form
+    Options::setUseRelativistic(false);
+
+    // Angular distance between a unit vector and equatorial coordinates, in milliarcseconds
+    auto distance = [](const Eigen::Vector3d &v, const dms &ra, const dms &dec) {
+        double sinRA, cosRA, sinDec, cosDec;
+        ra.SinCos(sinRA, cosRA);
+        dec.SinCos(sinDec, cosDec);
+        Eigen::Vector3d const w(cosDec * cosRA, cosDec * sinRA, sinDec);
+        return 2.0 * asin((v - w).norm() / 2.0) / dms::DegToRad * 3600.0e3;
+    };
+
+    // RA [hours], Dec [degrees], proper motion in RA and Dec [mas/yr]
+    // The spherical computation ignores proper motions moving a star by less than an arcsecond,
+    // so the sample only has stars that do not move, or move fast enough.
+    struct Sample
+    {
+        double ra, dec, pmRA, pmDec;
+    } const samples[] = {
+        { 0.0, 0.0, 0, 0 },
+        { 2.7698, 49.2277, 1262.4, -91.2 },
+        { 6.7525, -16.7161, -546.0, -1223.1 },
+        { 10.1395, 11.9672, -249.4, 4.9 },
+        { 12.4433, -59.8000, 0, 0 },
+        { 14.2612, 19.1825, -1093.4, -2000.1 },
+        { 17.9633, 4.6934, -798.6, 10328.1 },
+        { 18.6156, 38.7837, 200.9, 286.2 },
+        { 20.0, 59.5, -150.0, 150.0 },
+        { 21.0589, 38.7497, 4156.9, 3259.0 },
+        { 22.9608, -29.6222, 328.9, -164.7 },
+    };
+
+    // The spherical computation is only first order in the constant of aberration and in nutation,
+    // the terms it neglects reach about 2 mas at 60 degrees of declination
+    constexpr double vectorPrecision    = 1.0;
+    constexpr double sphericalPrecision = 3.0;
+
+    for (long double jd : { KStarsDateTime::epochToJd(1900.0), KStarsDateTime::epochToJd(2028.87),
+                            KStarsDateTime::epochToJd(2100.3) })
+    {
+        KSNumbers num(jd);
+
+        for (const Sample &sample : samples)
+        {
+            StarObject star(sample.ra, sample.dec, 0.0, QString(), QString(), "--", sample.pmRA, sample.pmDec);
+
+            Eigen::Vector3d const v = star.apparentVector(&num);
+            QVERIFY(fabs(v.norm() - 1.0) < 1e-12);
+
+            // updateCoords() converts the apparent vector to equatorial coordinates
+            star.updateCoords(&num, false, nullptr, nullptr, true);
+            double const vectorDistance = distance(v, star.ra(), star.dec());
+
+            // Reference: proper motion along a great circle, then precession, nutation and aberration
+            CachingDms ra, dec;
+            star.getIndexCoords(&num, ra, dec);
+            SkyPoint reference(ra, dec);
+            reference.updateCoords(&num, false, nullptr, nullptr, true);
+            double const sphericalDistance = distance(v, reference.ra(), reference.dec());
+
+            qDebug() << sample.ra << sample.dec << vectorDistance << sphericalDistance;
+            QVERIFY(vectorDistance < vectorPrecision);
+            QVERIFY(sphericalDistance < sphericalPrecision);
+        }
+    }
+}
+
 QTEST_GUILESS_MAIN(TestSkyPoint)
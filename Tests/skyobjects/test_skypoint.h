@@ -41,6 +41,8 @@ class TestSkyPoint : public QObject
 
   private slots:
     void testPrecession();
+    void testAberration();
+    void testStarApparentVector();
 };
 
 #endif
@@ -23,6 +23,13 @@
 
 #include <QStandardPaths>
 
+#include <algorithm>
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
 class BinFileHelper;
 
 BinFileHelper::BinFileHelper()
@@ -40,6 +47,7 @@ BinFileHelper::~BinFileHelper()
 
 void BinFileHelper::init()
 {
+    unmapFile();
     if (fileHandle)
         fclose(fileHandle);
 
@@ -89,6 +97,7 @@ FILE *BinFileHelper::openFile(const QString &fileName)
     const char *filepath = b.data();
 
     fileHandle = fopen(filepath, "rb");
+    filePath   = FilePath;
 
     if (!fileHandle)
     {
@@ -287,10 +296,70 @@ bool BinFileHelper::readHeader()
 
 void BinFileHelper::closeFile()
 {
+    unmapFile();
     fclose(fileHandle);
     fileHandle = nullptr;
 }
 
+bool BinFileHelper::mapFile()
+{
+    if (mappedData)
+        return true;
+    if (!fileHandle)
+        return false;
+
+    mappedFile.setFileName(filePath);
+    if (!mappedFile.open(QIODevice::ReadOnly))
+        return false;
+
+    mappedSize = mappedFile.size();
+    mappedData = (mappedSize > 0 ? mappedFile.map(0, mappedSize) : nullptr);
+
+    if (!mappedData)
+    {
+        mappedFile.close();
+        mappedSize = 0;
+        return false;
+    }
+
+#ifndef _WIN32
+    // Records of a trixel are read in sequence, but trixels are visited in no particular order
+    posix_madvise(mappedData, mappedSize, POSIX_MADV_RANDOM);
+#endif
+
+    return true;
+}
+
+void BinFileHelper::unmapFile()
+{
+    if (mappedData)
+        mappedFile.unmap(mappedData);
+    if (mappedFile.isOpen())
+        mappedFile.close();
+
+    mappedData = nullptr;
+    mappedSize = 0;
+}
+
+void BinFileHelper::prefetch(quint64 offset, quint64 size) const
+{
+#ifndef _WIN32
+    if (!mappedData || offset >= mappedSize)
+        return;
+
+    size = std::min(size, mappedSize - offset);
+
+    // The advice applies to whole pages
+    static const quint64 pageSize = sysconf(_SC_PAGESIZE);
+    quint64 const start           = offset - offset % pageSize;
+
+    posix_madvise(mappedData + start, size + (offset - start), POSIX_MADV_WILLNEED);
+#else
+    Q_UNUSED(offset)
+    Q_UNUSED(size)
+#endif
+}
+
 int BinFileHelper::getErrorNumber()
 {
     int err = errnum;
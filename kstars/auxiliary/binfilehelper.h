@@ -18,6 +18,7 @@
 
 #pragma once
 
+#include <QFile>
 #include <QString>
 #include <QVector>
 
@@ -192,6 +193,46 @@ class BinFileHelper
      */
     inline long getIndexTableOffset() const { return (FDUpdated ? itableOffset : 0); }
 
+    /**
+     * @short Map the currently open file in memory
+     *
+     * Once mapped, records can be reached through getMappedData() without any read or seek
+     * on the file handle, which stays open. Mapping may fail, e.g. when the address space is
+     * too small for the file, in which case the file must be read through the file handle.
+     *
+     * @return true if the file is mapped, false otherwise
+     */
+    bool mapFile();
+
+    /**
+     * @short  Check whether the file is mapped in memory
+     * @return true if mapFile() succeeded and the file is still open
+     */
+    inline bool isMapped() const { return mappedData != nullptr; }
+
+    /**
+     * @short  Get a pointer to mapped file data
+     * @param  offset Offset of the data in the file
+     * @param  size   Size of the data that will be accessed
+     * @return Pointer to the data, or nullptr if the file is not mapped or the range exceeds the file
+     */
+    inline const char *getMappedData(quint64 offset, quint64 size) const
+    {
+        return ((mappedData && offset + size <= mappedSize) ? reinterpret_cast<const char *>(mappedData + offset) :
+                                                                nullptr);
+    }
+
+    /**
+     * @short Hint that a range of the mapped file will be read soon
+     *
+     * The pages are read ahead in the background by the operating system. This does nothing if
+     * the file is not mapped, or if the platform has no such hint.
+     *
+     * @param offset Offset of the range in the file
+     * @param size   Size of the range in bytes
+     */
+    void prefetch(quint64 offset, quint64 size) const;
+
     /**
      * @short Wrapper around fseek for large offsets
      *
@@ -239,8 +280,21 @@ class BinFileHelper
      */
     void init();
 
+    /**
+     * @short  Helper function that releases the memory map of the file, if any
+     */
+    void unmapFile();
+
     /// Handle to the file.
     FILE *fileHandle { nullptr};
+    /// Path of the open file
+    QString filePath;
+    /// File used for the memory map
+    QFile mappedFile;
+    /// Start of the memory map of the whole file, nullptr if not mapped
+    uchar *mappedData { nullptr };
+    /// Size of the memory map
+    quint64 mappedSize { 0 };
     /// Stores offsets corresponding to each index table entry
     QVector<unsigned long> indexOffset;
     /// Stores number of records under each index table entry
@@ -26,7 +26,7 @@
 
 #pragma once
 
-#include "dms.h"
+#include "cachingdms.h"
 
 #include <QPointF>
 #include <QSharedPointer>
@@ -112,6 +112,24 @@ inline Eigen::Vector3d fromSperical(const dms &longitude, const dms &latitude)
     return Eigen::Vector3d(cosB * cosL, cosB * sinL, sinB);
 }
 
+/** Rotation from equatorial to horizontal unit vectors, the same transformation as
+ *  SkyPoint::EquatorialToHorizontal(). Horizontal vectors point North, East and to the
+ *  zenith, so that azimuth is counted from North through East.
+ */
+inline Eigen::Matrix3d equatorialToHorizontal(const CachingDms &LST, const CachingDms &lat)
+{
+    double sinLST, cosLST, sinLat, cosLat;
+
+    LST.SinCos(sinLST, cosLST);
+    lat.SinCos(sinLat, cosLat);
+
+    Eigen::Matrix3d rotation;
+    rotation << -sinLat * cosLST, -sinLat * sinLST, cosLat,
+             -sinLST, cosLST, 0,
+             cosLat * cosLST, cosLat * sinLST, sinLat;
+    return rotation;
+}
+
 /** Convert a vector to a point */
 inline QPointF vecToPoint(const Eigen::Vector2f &vec)
 {
@@ -25,6 +25,7 @@
 #include "skymap.h"
 #include "skyobjects/skyobject.h"
 #include "skyobjects/deepskyobject.h"
+#include "skycomponents/objectnameindex.h"
 #include "skycomponents/starcomponent.h"
 #include "skycomponents/syncedcatalogcomponent.h"
 #include "skycomponents/skymapcomposite.h"
@@ -227,78 +228,65 @@ void FindDialog::initSelection()
     listFiltered = true;
 }
 
-void FindDialog::filterByType()
+QList<int> FindDialog::filterTypes() const
 {
-    KStarsData *data = KStarsData::Instance();
-
     switch (ui->FilterType->currentIndex())
     {
-        case 0: // All object types
-        {
-            QVector<QPair<QString, const SkyObject *>> allObjects;
-            foreach (int type, data->skyComposite()->objectLists().keys())
-            {
-                allObjects.append(data->skyComposite()->objectLists(SkyObject::TYPE(type)));
-            }
-            fModel->setSkyObjectsList(allObjects);
-            break;
-        }
         case 1: //Stars
-        {
-            QVector<QPair<QString, const SkyObject *>> starObjects;
-            starObjects.append(data->skyComposite()->objectLists(SkyObject::STAR));
-            starObjects.append(data->skyComposite()->objectLists(SkyObject::CATALOG_STAR));
-            fModel->setSkyObjectsList(starObjects);
-            break;
-        }
+            return QList<int>() << SkyObject::STAR << SkyObject::CATALOG_STAR;
         case 2: //Solar system
-        {
-            QVector<QPair<QString, const SkyObject *>> ssObjects;
-            ssObjects.append(data->skyComposite()->objectLists(SkyObject::PLANET));
-            ssObjects.append(data->skyComposite()->objectLists(SkyObject::COMET));
-            ssObjects.append(data->skyComposite()->objectLists(SkyObject::ASTEROID));
-            ssObjects.append(data->skyComposite()->objectLists(SkyObject::MOON));
-
-            fModel->setSkyObjectsList(ssObjects);
-            break;
-        }
+            return QList<int>() << SkyObject::PLANET << SkyObject::COMET << SkyObject::ASTEROID << SkyObject::MOON;
         case 3: //Open Clusters
-            fModel->setSkyObjectsList(data->skyComposite()->objectLists(SkyObject::OPEN_CLUSTER));
-            break;
+            return QList<int>() << SkyObject::OPEN_CLUSTER;
         case 4: //Globular Clusters
-            fModel->setSkyObjectsList(data->skyComposite()->objectLists(SkyObject::GLOBULAR_CLUSTER));
-            break;
+            return QList<int>() << SkyObject::GLOBULAR_CLUSTER;
         case 5: //Gaseous nebulae
-            fModel->setSkyObjectsList(data->skyComposite()->objectLists(SkyObject::GASEOUS_NEBULA));
-            break;
+            return QList<int>() << SkyObject::GASEOUS_NEBULA;
         case 6: //Planetary nebula
-            fModel->setSkyObjectsList(data->skyComposite()->objectLists(SkyObject::PLANETARY_NEBULA));
-            break;
+            return QList<int>() << SkyObject::PLANETARY_NEBULA;
         case 7: //Galaxies
-            fModel->setSkyObjectsList(data->skyComposite()->objectLists(SkyObject::GALAXY));
-            break;
+            return QList<int>() << SkyObject::GALAXY;
         case 8: //Comets
-            fModel->setSkyObjectsList(data->skyComposite()->objectLists(SkyObject::COMET));
-            break;
+            return QList<int>() << SkyObject::COMET;
         case 9: //Asteroids
-            fModel->setSkyObjectsList(data->skyComposite()->objectLists(SkyObject::ASTEROID));
-            break;
+            return QList<int>() << SkyObject::ASTEROID;
         case 10: //Constellations
-            fModel->setSkyObjectsList(data->skyComposite()->objectLists(SkyObject::CONSTELLATION));
-            break;
+            return QList<int>() << SkyObject::CONSTELLATION;
         case 11: //Supernovae
-            fModel->setSkyObjectsList(data->skyComposite()->objectLists(SkyObject::SUPERNOVA));
-            break;
+            return QList<int>() << SkyObject::SUPERNOVA;
         case 12: //Satellites
-            fModel->setSkyObjectsList(data->skyComposite()->objectLists(SkyObject::SATELLITE));
-            break;
+            return QList<int>() << SkyObject::SATELLITE;
+        default: // All object types
+            return QList<int>();
     }
 }
 
+void FindDialog::filterByType()
+{
+    SkyMapComposite *composite = KStarsData::Instance()->skyComposite();
+    QList<int> types = filterTypes();
+
+    // Only list the objects matching the search text, as found by the name index
+    QString const searchText = processSearchText();
+    if (!searchText.isEmpty())
+    {
+        fModel->setSkyObjectsList(composite->nameIndex()->search(searchText, types));
+        return;
+    }
+
+    if (types.isEmpty())
+        types = composite->objectLists().keys();
+
+    QVector<QPair<QString, const SkyObject *>> objects;
+    for (int type : types)
+        objects.append(composite->objectLists(SkyObject::TYPE(type)));
+
+    fModel->setSkyObjectsList(objects);
+}
+
 void FindDialog::filterList()
 {
     QString SearchText = processSearchText();
-    sortModel->setFilterFixedString(SearchText);
     ui->InternetSearchButton->setText(i18n("or search the Internet for %1", SearchText));
     filterByType();
     initSelection();
@@ -64,7 +64,8 @@ class FindDialog : public QDialog
   public slots:
     /**
      * When Text is entered in the QLineEdit, filter the List of objects
-     * so that only objects which start with the filter text are shown.
+     * so that only objects whose name contains the filter text are shown.
+     * If there is none, objects with a similar name are shown.
      */
     void filterList();
 
@@ -124,9 +125,12 @@ class FindDialog : public QDialog
     /** @short Finishes the processing towards closing the dialog initiated by slotOk() or slotResolve() */
     void finishProcessing(SkyObject *selObj = nullptr, bool resolve = true);
 
-    /** @short pre-filter the list of objects according to the selected object type. */
+    /** @short List the objects of the selected object type, matching the search text if any. */
     void filterByType();
 
+    /** @return the object types selected in the filter, or an empty list for all types. */
+    QList<int> filterTypes() const;
+
     FindDialogUI *ui { nullptr };
     SkyObjectListModel *fModel { nullptr };
     QSortFilterProxyModel *sortModel { nullptr };
@@ -45,6 +45,8 @@
 #include <KConfigDialog>
 #include <KActionCollection>
 
+#include <QTemporaryFile>
+
 #include <basedevice.h>
 #include <indicom.h>
 
@@ -55,6 +57,7 @@
 #define PAH_CUTOFF_FOV            10 // Minimum FOV width in arcminutes for PAH to work
 #define MAXIMUM_SOLVER_ITERATIONS 10
 #define CAPTURE_RETRY_DELAY       10000
+#define MINIMUM_XYLIST_STARS      10 // Minimum number of detected stars to solve them instead of the image
 
 #define AL_FORMAT_VERSION 1.0
 
@@ -1823,6 +1826,9 @@ void Align::checkAlignmentTimeout()
         appendLogText(i18n("Solver timed out."));
         parser->stopSolver();
 
+        if (Options::astrometryAutoHints())
+            m_SolverHints.failed();
+
         int currentRow = solutionTable->rowCount() - 1;
         solutionTable->setCellWidget(currentRow, 3, new QWidget());
         QTableWidgetItem *statusReport = new QTableWidgetItem();
@@ -2629,6 +2635,9 @@ void Align::generateArgs()
             optionsMap["radius"] = Options::astrometryRadius();
         }
 
+        if (Options::astrometryAutoHints())
+            applySolverHints(optionsMap);
+
         if (Options::astrometryCustomOptions().isEmpty() == false)
             optionsMap["custom"] = Options::astrometryCustomOptions();
     }
@@ -2653,6 +2662,41 @@ void Align::generateArgs()
     solverOptions->setToolTip(options);
 }
 
+void Align::applySolverHints(QVariantMap &optionsMap)
+{
+    if (currentCCD == nullptr)
+        return;
+
+    m_SolverHints.setTrain(QString("%1/%2/%3").arg(currentCCD->getDeviceName()).arg(FOVScopeCombo->currentIndex())
+                           .arg(focal_length, 0, 'f', 0));
+
+    SolverHints::Bracket const bracket = m_SolverHints.bracket();
+
+    for (const QString &key : { "scaleL", "scaleH", "scaleUnits", "ra", "de", "radius" })
+        optionsMap.remove(key);
+
+    // Solved scale of the unbinned camera, or the scale of the optics until solved
+    uint8_t const bin = qMax(Options::solverBinningIndex() + 1, 1u);
+    double const scale = (m_SolverHints.scale() > 0) ? m_SolverHints.scale() * bin : fov_pixscale;
+
+    if (bracket.scaleTolerance > 0 && scale > 0)
+    {
+        optionsMap["scaleL"]     = scale * (1 - bracket.scaleTolerance);
+        optionsMap["scaleH"]     = scale * (1 + bracket.scaleTolerance);
+        optionsMap["scaleUnits"] = "app";
+    }
+
+    if (bracket.radius > 0 && currentTelescope != nullptr)
+    {
+        double ra = 0, dec = 0;
+        currentTelescope->getEqCoords(&ra, &dec);
+
+        optionsMap["ra"]     = ra * 15.0;
+        optionsMap["de"]     = dec;
+        optionsMap["radius"] = bracket.radius;
+    }
+}
+
 bool Align::captureAndSolve()
 {
     m_AlignTimer.stop();
@@ -2710,6 +2754,10 @@ bool Align::captureAndSolve()
         return false;
     }
 
+    // Hints follow the mount position and the last solutions, so refresh them for each solve
+    if (Options::astrometryAutoHints() && solverBackendGroup->checkedId() == SOLVER_ASTROMETRYNET)
+        generateArgs();
+
     if (currentFilter != nullptr)
     {
         if (currentFilter->isConnected() == false)
@@ -2996,6 +3044,46 @@ void Align::setCaptureComplete()
 
     emit newImage(alignView);
 
+    bool useXYList = false;
+
+    // Solve the brightest stars of the frame, which spares writing the frame and sending it to the solver
+    if (blobType == ISD::CCD::BLOB_FITS && alignView->getImageData() != nullptr && Options::astrometryUseXYList() &&
+            solverBackendGroup->checkedId() == SOLVER_ASTROMETRYNET &&
+            (astrometryTypeCombo->currentIndex() == SOLVER_OFFLINE || astrometryTypeCombo->currentIndex() == SOLVER_REMOTE))
+    {
+        // Use a list of our own, other KStars instances may be solving at the same time
+        xyListFile.reset(new QTemporaryFile(QDir::tempPath() + "/alignXXXXXX.xyls"));
+        int starCount = -1;
+        if (xyListFile->open())
+        {
+            xyListFile->close();
+            starCount = alignView->getImageData()->saveXYList(xyListFile->fileName(), Options::astrometryXYListStars());
+        }
+
+        // Too few stars to solve, let the solver look for fainter ones in the frame
+        if (starCount >= MINIMUM_XYLIST_STARS)
+        {
+            appendLogText(i18n("Solving %1 detected stars.", starCount));
+            blobFileName = xyListFile->fileName();
+            useXYList    = true;
+        }
+        else if (starCount >= 0)
+            appendLogText(i18n("Detected %1 stars only, solving the full image.", starCount));
+    }
+
+    // FITS frames are received in memory, the solvers need them on disk
+    if (blobType == ISD::CCD::BLOB_FITS && alignView->getImageData() != nullptr && useXYList == false)
+    {
+        if (alignView->getImageData()->ensureFileOnDisk() == false)
+        {
+            appendLogText(i18n("Failed to save image %1 for solving.", blobFileName));
+            abort();
+            return;
+        }
+
+        blobFileName = alignView->getImageData()->filename();
+    }
+
     if (solverBackendGroup->checkedId() == SOLVER_ASTROMETRYNET &&
             astrometryTypeCombo->currentIndex() == SOLVER_ONLINE &&
             Options::astrometryUseJPEG())
@@ -3092,6 +3180,14 @@ void Align::startSolving(const QString &filename, bool isGenerated)
         }
     }
 
+    // XY lists hold the stars only, so the solver needs the size of the image they were extracted from
+    if (filename.endsWith(QLatin1String(".xyls")) && alignView->getImageData() != nullptr)
+    {
+        solverArgs << "--width" << QString::number(alignView->getImageData()->width())
+                   << "--height" << QString::number(alignView->getImageData()->height())
+                   << "--x-column" << "X" << "--y-column" << "Y" << "--sort-column" << "FLUX";
+    }
+
     if (solverIterations == 0 && mountModelReset == false)
     {
         double ra, dec;
@@ -3177,6 +3273,11 @@ void Align::solverFinished(double orientation, double ra, double dec, double pix
     // Get horizontal coords
     alignCoord.EquatorialToHorizontal(KStarsData::Instance()->lst(), KStarsData::Instance()->geo()->lat());
 
+    // Images loaded from files may come from other equipment, so only captures feed the solver hints
+    if (Options::astrometryAutoHints() && loadSlewState == IPS_IDLE)
+        m_SolverHints.solved(pixscale / binx, orientation,
+                             currentTelescope ? telescopeCoord.angularDistanceTo(&alignCoord).Degrees() : 0);
+
     double raDiff = (alignCoord.ra().deltaAngle(targetCoord.ra())).Degrees() * 3600;
     double deDiff = (alignCoord.dec().deltaAngle(targetCoord.dec())).Degrees() * 3600;
 
@@ -3486,6 +3587,9 @@ void Align::solverFailed()
 
     m_AlignTimer.stop();
 
+    if (Options::astrometryAutoHints() && loadSlewState == IPS_IDLE)
+        m_SolverHints.failed();
+
     azStage  = AZ_INIT;
     altStage = ALT_INIT;
 
@@ -5086,7 +5190,7 @@ void Align::showFITSViewer()
 {
     FITSData *data = alignView->getImageData();
 
-    if (data)
+    if (data && data->ensureFileOnDisk())
     {
         QUrl url = QUrl::fromLocalFile(data->filename());
 
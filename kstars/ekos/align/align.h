@@ -17,6 +17,7 @@
 #include "indi/inditelescope.h"
 #include "indi/indidome.h"
 #include "ekos/auxiliary/filtermanager.h"
+#include "ekos/align/solverhints.h"
 
 #include <QTime>
 #include <QTimer>
@@ -30,6 +31,7 @@
 #include <memory>
 
 class QProgressIndicator;
+class QTemporaryFile;
 
 class AlignView;
 class FOV;
@@ -660,6 +662,13 @@ class Align : public QWidget, public Ui::Align
 
         uint8_t getSolverDownsample(uint16_t binnedW);
 
+        /**
+             * @brief applySolverHints Replace the position and scale options by the search bracket of the solver hints
+             * of the current camera and telescope.
+             * @param optionsMap solver options to update.
+             */
+        void applySolverHints(QVariantMap &optionsMap);
+
         /**
              * @brief setWCSEnabled enables/disables World Coordinate System settings in the CCD driver.
              * @param enable true to enable WCS, false to disable.
@@ -843,6 +852,8 @@ class Align : public QWidget, public Ui::Align
         // BLOB Type
         ISD::CCD::BlobType blobType;
         QString blobFileName;
+        // XY list of the stars of the align frame, when solving them instead of the frame
+        std::unique_ptr<QTemporaryFile> xyListFile;
 
         // Align Frame
         AlignView *alignView { nullptr };
@@ -918,6 +929,9 @@ class Align : public QWidget, public Ui::Align
         // Filter Manager
         QSharedPointer<FilterManager> filterManager;
 
+        // Solver search hints from previous solutions
+        SolverHints m_SolverHints;
+
         // Active Profile
         ProfileInfo *m_ActiveProfile { nullptr };
 
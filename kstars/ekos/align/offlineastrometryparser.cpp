@@ -10,12 +10,24 @@
 #include "offlineastrometryparser.h"
 
 #include "align.h"
+#include "dms.h"
 #include "ekos_align_debug.h"
 #include "ksutils.h"
 #include "Options.h"
 #include "kspaths.h"
 #include "ksnotification.h"
 
+#include <QRegularExpression>
+#include <QTextStream>
+
+#include <fitsio.h>
+#include <indicom.h>
+
+#include <algorithm>
+
+// Interval to check for the solutions of the warm solver jobs, in milliseconds
+#define JOB_CHECK_INTERVAL 250
+
 namespace Ekos
 {
 OfflineAstrometryParser::OfflineAstrometryParser() : AstrometryParser()
@@ -47,6 +59,21 @@ OfflineAstrometryParser::OfflineAstrometryParser() : AstrometryParser()
         parity = QString();
     });
 
+    jobTimer.setInterval(JOB_CHECK_INTERVAL);
+    connect(&jobTimer, &QTimer::timeout, this, &OfflineAstrometryParser::checkJobs);
+}
+
+OfflineAstrometryParser::~OfflineAstrometryParser()
+{
+    stopEngine();
+}
+
+QString OfflineAstrometryParser::getSolverPath() const
+{
+    if (Options::astrometrySolverIsInternal())
+        return QCoreApplication::applicationDirPath() + "/astrometry/bin/solve-field";
+
+    return Options::astrometrySolverBinary();
 }
 
 bool OfflineAstrometryParser::init()
@@ -69,12 +96,7 @@ bool OfflineAstrometryParser::init()
 
     astrometryFilesOK = true;
 
-    QString solverPath;
-
-    if (Options::astrometrySolverIsInternal())
-        solverPath = QCoreApplication::applicationDirPath() + "/astrometry/bin/solve-field";
-    else
-        solverPath = Options::astrometrySolverBinary();
+    QString solverPath = getSolverPath();
 
     QProcess solveField;
 
@@ -214,6 +236,20 @@ bool OfflineAstrometryParser::startSovler(const QString &filename, const QString
             (args.contains("-3") || args.contains("-L")))
         solverArgs << "--parity" << parity;
 
+    if (Options::astrometryUseWarmSolver())
+    {
+        if (readEngineConfig())
+            return startWarmSolver(filename, solverArgs);
+
+        if (warmSolverWarned == false)
+        {
+            align->appendLogText(i18n("The warm solver needs inparallel in the astrometry.net configuration, solving without it."));
+            warmSolverWarned = true;
+        }
+    }
+
+    stopEngine();
+
     QString confPath = KSUtils::getAstrometryConfFilePath();
     solverArgs << "--config" << confPath;
 
@@ -264,12 +300,7 @@ bool OfflineAstrometryParser::startSovler(const QString &filename, const QString
 
     solverTimer.start();
 
-    QString solverPath;
-
-    if (Options::astrometrySolverIsInternal())
-        solverPath = QCoreApplication::applicationDirPath() + "/astrometry/bin/solve-field";
-    else
-        solverPath = Options::astrometrySolverBinary();
+    QString solverPath = getSolverPath();
 
     solver->start(solverPath, solverArgs);
 
@@ -294,11 +325,400 @@ bool OfflineAstrometryParser::stopSolver()
 
         // 2019-04-25: When inparallel option is enabled in astrometry.cfg
         // astrometry-engine is not killed after solve-field is terminated
-        QProcess p;
-        p.start("killall astrometry-engine");
-        p.waitForFinished();
+        // The warm solver engine is kept running, only its jobs are cancelled
+        if (engine.isNull())
+        {
+            QProcess p;
+            p.start("killall astrometry-engine");
+            p.waitForFinished();
+        }
+    }
+
+    // The engine stops solving a job as soon as its cancel file exists. It is then stopped, so that the end of the
+    // cancelled jobs it would still report is not taken for the end of the next ones.
+    if (jobs.isEmpty() == false)
+    {
+        for (const SolverJob &job : jobs)
+        {
+            QFile cancel(job.cancelFile);
+            cancel.open(QIODevice::WriteOnly);
+        }
+        stopEngine();
+    }
+
+    return true;
+}
+
+bool OfflineAstrometryParser::startWarmSolver(const QString &filename, const QStringList &args)
+{
+    if (engine.isNull() && startEngine() == false)
+    {
+        emit solverFailed();
+        return false;
+    }
+
+    QString const jobPath = jobDir->filePath(QString("solution-%1").arg(++jobCounter));
+
+    SolverJob job;
+    job.axyFile    = jobPath + ".axy";
+    job.wcsFile    = jobPath + ".wcs";
+    job.solvedFile = jobPath + ".solved";
+    job.cancelFile = jobPath + ".cancel";
+    job.matchFile  = jobPath + ".match";
+
+    // solve-field only extracts the stars and writes the job file, the engine solves it
+    QStringList augmentArgs = args;
+    augmentArgs << "--config" << KSUtils::getAstrometryConfFilePath() << "--just-augment" << "--axy" << job.axyFile
+                << "-W" << job.wcsFile << "--solved" << job.solvedFile << "--cancel" << job.cancelFile
+                << "--match" << job.matchFile << "--cpulimit" << QString::number(Options::astrometryTimeout())
+                << filename;
+
+    fitsFile = filename;
+
+    QProcess *augment = new QProcess(this);
+    solver = augment;
+
+    augment->setProcessChannelMode(QProcess::MergedChannels);
+    connect(augment, &QProcess::readyReadStandardOutput, this, &OfflineAstrometryParser::logSolver);
+    connect(augment, static_cast<void (QProcess::*)(int, QProcess::ExitStatus)>(&QProcess::finished), this,
+            [this, augment, job](int exitCode, QProcess::ExitStatus exitStatus) mutable
+    {
+        augment->deleteLater();
+
+        if (exitCode != 0 || exitStatus != QProcess::NormalExit || QFile::exists(job.axyFile) == false || engine.isNull())
+        {
+            removeJobFiles(job);
+            align->appendLogText(i18n("Solver failed. Try again."));
+            emit solverFailed();
+            return;
+        }
+
+        job.lastStar = readLastStar(job.axyFile);
+        jobs.enqueue(job);
+        engine->write(QFile::encodeName(job.axyFile) + '\n');
+        jobTimer.start();
+    });
+
+    solverTimer.start();
+
+    QString const solverPath = getSolverPath();
+    augment->start(solverPath, augmentArgs);
+
+    align->appendLogText(i18n("Starting solver..."));
+
+    if (Options::alignmentLogging())
+        align->appendLogText(solverPath + ' ' + augmentArgs.join(' '));
+
+    return true;
+}
+
+bool OfflineAstrometryParser::startEngine()
+{
+    QString enginePath;
+
+    if (Options::astrometrySolverIsInternal())
+        enginePath = QCoreApplication::applicationDirPath() + "/astrometry/bin/astrometry-engine";
+    else
+        enginePath = QFileInfo(getSolverPath()).absoluteDir().filePath("astrometry-engine");
+
+    jobDir.reset(new QTemporaryDir(QDir::tempPath() + "/kstars-solver-XXXXXX"));
+    if (jobDir->isValid() == false)
+    {
+        align->appendLogText(i18n("Error creating the solver job directory: %1", jobDir->errorString()));
+        jobDir.reset();
+        return false;
+    }
+
+    engine = new QProcess(this);
+    engine->setProcessChannelMode(QProcess::MergedChannels);
+
+    connect(engine.data(), &QProcess::readyReadStandardOutput, this, &OfflineAstrometryParser::readEngineOutput);
+
+    connect(engine.data(), static_cast<void (QProcess::*)(int, QProcess::ExitStatus)>(&QProcess::finished), this,
+            [this]()
+    {
+        align->appendLogText(i18n("Solver engine stopped."));
+
+        QProcess *stopped = engine;
+        engine.clear();
+        stopped->deleteLater();
+
+        jobTimer.stop();
+        bool const failed = (jobs.isEmpty() == false);
+        jobs.clear();
+        jobDir.reset();
+
+        if (failed)
+            emit solverFailed();
+    });
+
+    // Without job files as arguments, the engine reads the job file names from its standard input
+    engine->start(enginePath, QStringList() << "--config" << KSUtils::getAstrometryConfFilePath());
+
+    if (engine->waitForStarted() == false)
+    {
+        align->appendLogText(i18n("Error starting solver engine %1: %2", enginePath, engine->errorString()));
+        engine->disconnect(this);
+        delete engine;
+        jobDir.reset();
+        return false;
     }
 
+    align->appendLogText(i18n("Solver engine started."));
+    return true;
+}
+
+void OfflineAstrometryParser::stopEngine()
+{
+    if (engine.isNull())
+        return;
+
+    engine->disconnect(this);
+
+    // The engine exits once it reads the end of its input, after its current job
+    engine->closeWriteChannel();
+    if (engine->waitForFinished(1000) == false)
+        engine->kill();
+
+    // This may be called from a slot of the engine, while reading its output
+    engine->deleteLater();
+    engine.clear();
+    jobs.clear();
+    jobTimer.stop();
+    jobDir.reset();
+}
+
+void OfflineAstrometryParser::readEngineOutput()
+{
+    // Passes are reported as "Field 1: solved with index ..." or "Field 1 did not solve (index ..., field objects 11-20)."
+    static QRegularExpression const solvedPass("^Field \\d+: solved with");
+    static QRegularExpression const failedPass("^Field \\d+ did not solve(?:.*field objects \\d+-(\\d+))?");
+
+    while (engine->canReadLine())
+    {
+        QString const line = QString::fromLocal8Bit(engine->readLine()).trimmed();
+        if (Options::alignmentLogging() && line.isEmpty() == false)
+            align->appendLogText(line);
+
+        // The engine solves the jobs in order, the report is for the oldest one it is not done with
+        auto job = std::find_if(jobs.begin(), jobs.end(), [](const SolverJob & j)
+        {
+            return j.ended == false;
+        });
+        if (job == jobs.end())
+            continue;
+
+        if (solvedPass.match(line).hasMatch())
+        {
+            job->ended  = true;
+            job->solved = true;
+            continue;
+        }
+
+        // The job is over once the pass over the last star it may use did not solve
+        QRegularExpressionMatch const failed = failedPass.match(line);
+        if (failed.hasMatch())
+            job->ended = failed.captured(1).isEmpty() || (job->lastStar > 0 && failed.captured(1).toLong() >= job->lastStar);
+    }
+
+    checkJobs();
+}
+
+void OfflineAstrometryParser::removeJobFiles(const SolverJob &job)
+{
+    for (const QString &file : { job.axyFile, job.wcsFile, job.solvedFile, job.cancelFile, job.matchFile })
+        QFile::remove(file);
+}
+
+bool OfflineAstrometryParser::readEngineConfig()
+{
+    bool inParallel = false;
+    engineDepth     = 0;
+
+    QFile config(KSUtils::getAstrometryConfFilePath());
+    if (config.open(QIODevice::ReadOnly | QIODevice::Text) == false)
+        return false;
+
+    QTextStream in(&config);
+    while (in.atEnd() == false)
+    {
+        QStringList const words = in.readLine().simplified().split(' ', QString::SkipEmptyParts);
+        if (words.isEmpty())
+            continue;
+
+        // With all indexes searched at once, the engine reports once per pass over the stars of a job
+        if (words.first() == "inparallel")
+            inParallel = true;
+        // Depths are listed as "depths 10 20 30", or as ranges "depths 1-10 11-20"
+        else if (words.first() == "depths")
+        {
+            for (int i = 1; i < words.size(); i++)
+                engineDepth = std::max(engineDepth, words[i].section('-', -1).toLong());
+        }
+    }
+
+    return inParallel;
+}
+
+long OfflineAstrometryParser::readLastStar(const QString &axyFile) const
+{
+    fitsfile *fptr = nullptr;
+    int status = 0;
+    long stars = 0, depth = 0;
+
+    if (fits_open_file(&fptr, QFile::encodeName(axyFile).constData(), READONLY, &status))
+    {
+        qCWarning(KSTARS_EKOS_ALIGN) << "Failed to read the stars of" << axyFile;
+        return 0;
+    }
+
+    // Depths given to solve-field are written to the job file as ANDPU1, ANDPU2... and replace those of the configuration
+    for (int i = 1; status == 0; i++)
+    {
+        long upper = 0;
+        if (fits_read_key(fptr, TLONG, QString("ANDPU%1").arg(i).toLatin1().data(), &upper, nullptr, &status) == 0)
+            depth = std::max(depth, upper);
+    }
+    if (depth == 0)
+        depth = engineDepth;
+
+    // The stars are listed in the table extension of the job file
+    status = 0;
+    if (fits_movabs_hdu(fptr, 2, nullptr, &status) || fits_get_num_rows(fptr, &stars, &status))
+    {
+        qCWarning(KSTARS_EKOS_ALIGN) << "Failed to read the number of stars of" << axyFile;
+        stars = 0;
+    }
+
+    status = 0;
+    fits_close_file(fptr, &status);
+
+    return (stars > 0 && depth > 0) ? std::min(stars, depth) : std::max(stars, depth);
+}
+
+void OfflineAstrometryParser::checkJobs()
+{
+    // The engine solves the jobs in order, and writes the solved file after the solution
+    while (jobs.isEmpty() == false)
+    {
+        SolverJob const &head = jobs.head();
+
+        // A job that did not solve leaves no solution behind once the engine is done with it
+        if (QFile::exists(head.solvedFile) == false)
+        {
+            if (head.ended == false || head.solved || QFile::exists(head.wcsFile) || QFile::exists(head.matchFile))
+                break;
+
+            removeJobFiles(jobs.dequeue());
+            align->appendLogText(i18n("Solver failed. Try again."));
+            emit solverFailed();
+            continue;
+        }
+
+        SolverJob const job = jobs.dequeue();
+
+        double ra = 0, dec = 0, orientation = 0, pixscale = 0;
+        bool const solved = readSolution(job.wcsFile, orientation, ra, dec, pixscale);
+        removeJobFiles(job);
+
+        if (solved == false)
+        {
+            align->appendLogText(i18n("WCS header missing or corrupted. Solver failed."));
+            emit solverFailed();
+            continue;
+        }
+
+        int elapsed = static_cast<int>(round(solverTimer.elapsed() / 1000.0));
+        align->appendLogText(i18np("Solver completed in %1 second.", "Solver completed in %1 seconds.", elapsed));
+
+        emit solverFinished(orientation, ra, dec, pixscale);
+    }
+
+    if (jobs.isEmpty())
+        jobTimer.stop();
+}
+
+double OfflineAstrometryParser::readSIPDistortion(fitsfile *fptr, const QString &axis, double u, double v)
+{
+    int status = 0, order = 0;
+
+    // Solutions without distortion terms have no SIP order
+    if (fits_read_key(fptr, TINT, QString("%1_ORDER").arg(axis).toLatin1().data(), &order, nullptr, &status))
+        return 0;
+
+    // Sum of the terms A_p_q u^p v^q, terms left out of the header are null
+    double distortion = 0;
+    for (int p = 0; p <= order; p++)
+    {
+        for (int q = 0; p + q <= order; q++)
+        {
+            double coefficient = 0;
+            status = 0;
+            if (fits_read_key(fptr, TDOUBLE, QString("%1_%2_%3").arg(axis).arg(p).arg(q).toLatin1().data(), &coefficient,
+                              nullptr, &status) == 0)
+                distortion += coefficient * pow(u, p) * pow(v, q);
+        }
+    }
+
+    return distortion;
+}
+
+bool OfflineAstrometryParser::readSolution(const QString &solutionFile, double &orientation, double &ra, double &dec,
+        double &pixscale)
+{
+    fitsfile *fptr = nullptr;
+    int status = 0;
+    double crval1 = 0, crval2 = 0, crpix1 = 0, crpix2 = 0, cd11 = 0, cd12 = 0, cd21 = 0, cd22 = 0;
+    long imageW = 0, imageH = 0;
+
+    if (fits_open_file(&fptr, QFile::encodeName(solutionFile).constData(), READONLY, &status) ||
+            fits_read_key(fptr, TDOUBLE, "CRVAL1", &crval1, nullptr, &status) ||
+            fits_read_key(fptr, TDOUBLE, "CRVAL2", &crval2, nullptr, &status) ||
+            fits_read_key(fptr, TDOUBLE, "CRPIX1", &crpix1, nullptr, &status) ||
+            fits_read_key(fptr, TDOUBLE, "CRPIX2", &crpix2, nullptr, &status) ||
+            fits_read_key(fptr, TDOUBLE, "CD1_1", &cd11, nullptr, &status) ||
+            fits_read_key(fptr, TDOUBLE, "CD1_2", &cd12, nullptr, &status) ||
+            fits_read_key(fptr, TDOUBLE, "CD2_1", &cd21, nullptr, &status) ||
+            fits_read_key(fptr, TDOUBLE, "CD2_2", &cd22, nullptr, &status) ||
+            fits_read_key(fptr, TLONG, "IMAGEW", &imageW, nullptr, &status) ||
+            fits_read_key(fptr, TLONG, "IMAGEH", &imageH, nullptr, &status))
+    {
+        char error_status[512] = {0};
+        fits_get_errstatus(status, error_status);
+        qCWarning(KSTARS_EKOS_ALIGN) << "Failed to read solution" << solutionFile << error_status;
+        status = 0;
+        if (fptr)
+            fits_close_file(fptr, &status);
+        return false;
+    }
+
+    // Offset of the image center from the reference pixel, with the SIP distortion if the solver fitted one
+    double const u = (imageW + 1) / 2.0 - crpix1;
+    double const v = (imageH + 1) / 2.0 - crpix2;
+    double const dx = u + readSIPDistortion(fptr, "A", u, v);
+    double const dy = v + readSIPDistortion(fptr, "B", u, v);
+
+    status = 0;
+    fits_close_file(fptr, &status);
+
+    // Intermediate world coordinates of the image center, in radians, as wcsinfo computes them
+    double const xi  = (cd11 * dx + cd12 * dy) * dms::DegToRad;
+    double const eta = (cd21 * dx + cd22 * dy) * dms::DegToRad;
+
+    // Inverse gnomonic projection around the reference point
+    double const sinDec0 = sin(crval2 * dms::DegToRad);
+    double const cosDec0 = cos(crval2 * dms::DegToRad);
+    double const denominator = cosDec0 - eta * sinDec0;
+
+    ra  = range360(crval1 + atan2(xi, denominator) / dms::DegToRad);
+    dec = atan2(eta * cosDec0 + sinDec0, sqrt(xi * xi + denominator * denominator)) / dms::DegToRad;
+
+    double const det = cd11 * cd22 - cd12 * cd21;
+    double const parityFactor = (det >= 0) ? 1.0 : -1.0;
+    orientation = -atan2(parityFactor * cd21 - cd12, parityFactor * cd11 + cd22) / dms::DegToRad;
+    pixscale    = sqrt(fabs(det)) * 3600.0;
+    parity      = (det >= 0) ? "neg" : "pos";
+
     return true;
 }
 
@@ -14,7 +14,14 @@
 #include <QMap>
 #include <QProcess>
 #include <QPointer>
+#include <QQueue>
+#include <QTemporaryDir>
 #include <QTime>
+#include <QTimer>
+
+#include <memory>
+
+#include <fitsio.h>
 
 namespace Ekos
 {
@@ -24,6 +31,17 @@ class Align;
  * @class  OfflineAstrometryParser
  * OfflineAstrometryParser invokes the offline astrometry.net solver to find solutions to captured images.
  *
+ * By default, each solve runs solve-field, then wcsinfo to read the solution. With the warm solver option, a single
+ * astrometry-engine process is kept running, so that index files loaded in memory stay loaded between solves. Each
+ * solve then runs solve-field to extract the stars and write a job file only, and the job file is passed to the engine
+ * through its standard input. Jobs queue up in the engine and their solutions are read back directly from the WCS
+ * files they produce.
+ * The engine writes no file for a job that does not solve. It only reports each pass over the stars of a job on its
+ * output when the astrometry.net configuration sets inparallel, so a job fails as soon as the pass over its last star
+ * did not solve. Without inparallel, the failure of a job could not be told before the Align timeout, so the warm
+ * solver is not used and each solve runs solve-field.
+ * The files of the jobs are kept in a temporary directory removed with the engine.
+ *
  * @author Jasem Mutlaq
  */
 
@@ -33,7 +51,7 @@ class OfflineAstrometryParser : public AstrometryParser
 
   public:
     OfflineAstrometryParser();
-    virtual ~OfflineAstrometryParser() override = default;
+    virtual ~OfflineAstrometryParser() override;
 
     virtual void setAlign(Align *_align) override { align = _align; }
     virtual bool init() override;
@@ -47,7 +65,48 @@ class OfflineAstrometryParser : public AstrometryParser
     void logSolver();
 
   private:
+    /** A solve submitted to the warm solver engine, with the files it produces */
+    struct SolverJob
+    {
+        QString axyFile;
+        QString wcsFile;
+        QString solvedFile;
+        QString cancelFile;
+        QString matchFile;
+        /** Number of the last star the engine tries, from the stars extracted and the depth limit, 0 if unknown */
+        long lastStar { 0 };
+        /** Whether the engine reported that it is done with the job, and whether the field solved */
+        bool ended { false };
+        bool solved { false };
+    };
+
     bool astrometryNetOK();
+    QString getSolverPath() const;
+
+    bool startWarmSolver(const QString &filename, const QStringList &args);
+    bool startEngine();
+    void stopEngine();
+    /** @short Emit the result of the jobs the engine completed, oldest first. */
+    void checkJobs();
+    /** @short Parse the output of the engine for the end of its current job. */
+    void readEngineOutput();
+    /** @short Remove the files of a job once its result is known. */
+    static void removeJobFiles(const SolverJob &job);
+    /**
+     * @short Read whether the astrometry.net configuration sets inparallel, and its depth limit.
+     * @return true if the engine reports the passes that do not solve, so that the warm solver can be used.
+     */
+    bool readEngineConfig();
+    /** @short Read the number of the last star the engine tries for a job, within the depth limit. */
+    long readLastStar(const QString &axyFile) const;
+    /**
+     * @short Read the center, orientation and scale of a solution from its WCS file.
+     * The center is found through the SIP distortion terms if any, as wcsinfo does. The orientation and the scale
+     * are those of the linear terms.
+     */
+    bool readSolution(const QString &solutionFile, double &orientation, double &ra, double &dec, double &pixscale);
+    /** @short Read the SIP distortion polynomial of an axis, A or B, of a solution and evaluate it at pixel offset u, v. */
+    static double readSIPDistortion(fitsfile *fptr, const QString &axis, double u, double v);
 
     QMap<float, QString> astrometryIndex;
     QString parity;
@@ -55,6 +114,14 @@ class OfflineAstrometryParser : public AstrometryParser
     QProcess wcsinfo;
     QTime solverTimer;
     QString fitsFile;
+    QPointer<QProcess> engine;
+    QQueue<SolverJob> jobs;
+    std::unique_ptr<QTemporaryDir> jobDir;
+    /** Largest depth of the astrometry.net configuration, 0 if not limited */
+    long engineDepth { 0 };
+    bool warmSolverWarned { false };
+    QTimer jobTimer;
+    int jobCounter { 0 };
     bool astrometryFilesOK { false };
     Align *align { nullptr };
 };
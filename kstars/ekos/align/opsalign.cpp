@@ -40,6 +40,9 @@ OpsAlign::OpsAlign(Align *parent) : QWidget(KStars::Instance())
     if (Options::astrometryConfFileIsInternal())
         kcfg_AstrometryConfFile->setEnabled(false);
 
+    connect(kcfg_AstrometryUseXYList, &QCheckBox::toggled, kcfg_AstrometryXYListStars, &QSpinBox::setEnabled);
+    kcfg_AstrometryXYListStars->setEnabled(Options::astrometryUseXYList());
+
 #ifdef Q_OS_OSX
     connect(kcfg_AstrometrySolverIsInternal, SIGNAL(clicked()), this, SLOT(toggleSolverInternal()));
     kcfg_AstrometrySolverIsInternal->setToolTip(i18n("Internal or External Plate Solver?"));
@@ -0,0 +1,154 @@
+/*  Astrometry.net Solver Hints
+    Copyright (C) 2026 agent <agent@local>
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+*/
+
+#include "solverhints.h"
+
+#include "Options.h"
+
+#include <QJsonDocument>
+#include <QJsonObject>
+
+#include <cmath>
+
+#include <ekos_align_debug.h>
+
+// Search brackets, from the tightest to the blind solve
+static const Ekos::SolverHints::Bracket brackets[] =
+{
+    { 1, 0.02 },
+    { 2, 0.05 },
+    { 5, 0.10 },
+    { 15, 0.20 },
+    { 30, 0.50 },
+    { 0, 0 }
+};
+static const int BRACKET_COUNT = sizeof(brackets) / sizeof(brackets[0]);
+// Search radius in units of the pointing error
+#define POINTING_ERROR_MARGIN 2.0
+// Relative difference of pixel scale considered a change of optics
+#define SCALE_CHANGE 0.1
+
+namespace Ekos
+{
+SolverHints::SolverHints()
+{
+    load();
+}
+
+void SolverHints::setTrain(const QString &train)
+{
+    m_Train = train;
+}
+
+SolverHints::Bracket SolverHints::bracket() const
+{
+    auto history = m_History.constFind(m_Train);
+
+    // Start wide on a new train, but not blind
+    if (history == m_History.constEnd())
+        return brackets[BRACKET_COUNT - 2];
+
+    return brackets[history->bracket];
+}
+
+double SolverHints::scale() const
+{
+    return m_History.value(m_Train, History { 0, 0, 0, BRACKET_COUNT - 2 }).scale;
+}
+
+double SolverHints::orientation() const
+{
+    return m_History.value(m_Train, History { 0, 0, 0, BRACKET_COUNT - 2 }).orientation;
+}
+
+void SolverHints::solved(double scale, double orientation, double pointingError)
+{
+    if (m_Train.isEmpty() || scale <= 0)
+        return;
+
+    auto history = m_History.find(m_Train);
+    if (history == m_History.end())
+        history = m_History.insert(m_Train, History { scale, orientation, pointingError, BRACKET_COUNT - 2 });
+
+    // A different scale means the optics changed, forget the previous scale
+    if (std::fabs(scale - history->scale) > SCALE_CHANGE * history->scale)
+        history->scale = scale;
+    else
+        history->scale = 0.7 * history->scale + 0.3 * scale;
+
+    history->orientation = orientation;
+
+    // Follow larger errors at once, and smaller errors slowly
+    history->pointingError = std::max(0.7 * history->pointingError, pointingError);
+
+    // Tighten by one step, down to the bracket covering the pointing error
+    int tightest = 0;
+    while (tightest < BRACKET_COUNT - 2 && brackets[tightest].radius < POINTING_ERROR_MARGIN * history->pointingError)
+        tightest++;
+
+    history->bracket = std::max(tightest, std::min(history->bracket, BRACKET_COUNT - 2) - 1);
+
+    qCDebug(KSTARS_EKOS_ALIGN) << "Solver hints for" << m_Train << "scale" << history->scale << "pointing error"
+                               << history->pointingError << "bracket" << history->bracket;
+
+    save();
+}
+
+void SolverHints::failed()
+{
+    if (m_Train.isEmpty())
+        return;
+
+    auto history = m_History.find(m_Train);
+    if (history == m_History.end())
+        history = m_History.insert(m_Train, History { 0, 0, 0, BRACKET_COUNT - 2 });
+
+    history->bracket = std::min(history->bracket + 1, BRACKET_COUNT - 1);
+
+    qCDebug(KSTARS_EKOS_ALIGN) << "Solver hints for" << m_Train << "widened to bracket" << history->bracket;
+
+    save();
+}
+
+void SolverHints::load()
+{
+    QJsonObject const trains = QJsonDocument::fromJson(Options::solverHints().toUtf8()).object();
+
+    for (auto train = trains.constBegin(); train != trains.constEnd(); ++train)
+    {
+        QJsonObject const values = train.value().toObject();
+
+        History history;
+        history.scale         = values["scale"].toDouble();
+        history.orientation   = values["orientation"].toDouble();
+        history.pointingError = values["pointingError"].toDouble();
+        history.bracket       = qBound(0, values["bracket"].toInt(BRACKET_COUNT - 2), BRACKET_COUNT - 1);
+
+        m_History.insert(train.key(), history);
+    }
+}
+
+void SolverHints::save() const
+{
+    QJsonObject trains;
+
+    for (auto history = m_History.constBegin(); history != m_History.constEnd(); ++history)
+    {
+        trains.insert(history.key(), QJsonObject
+        {
+            {"scale", history->scale},
+            {"orientation", history->orientation},
+            {"pointingError", history->pointingError},
+            {"bracket", history->bracket}
+        });
+    }
+
+    Options::setSolverHints(QString::fromUtf8(QJsonDocument(trains).toJson(QJsonDocument::Compact)));
+}
+}
@@ -0,0 +1,83 @@
+/*  Astrometry.net Solver Hints
+    Copyright (C) 2026 agent <agent@local>
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+*/
+
+#pragma once
+
+#include <QHash>
+#include <QString>
+
+namespace Ekos
+{
+/**
+ * @class SolverHints
+ * SolverHints narrows the search of the astrometry.net solver from the history of previous solutions.
+ *
+ * A history is kept per optical train, that is per camera, telescope type and focal length. It holds the solved pixel
+ * scale, orientation and pointing error of the mount, and the current search bracket. Brackets range from a tight
+ * search radius around the mount position with a tight scale range, to a blind solve. Each success tightens the
+ * bracket by one step, down to the one covering the pointing errors seen, and each failure widens it by one step, so
+ * that solves settle in the cheapest bracket that succeeds.
+ *
+ * The history is saved in the options and survives restarts.
+ *
+ */
+class SolverHints
+{
+  public:
+    /** Search bracket. A radius or scale tolerance of zero means the solver has no such hint. */
+    typedef struct
+    {
+        /** Search radius around the mount position, in degrees */
+        double radius;
+        /** Relative tolerance around the pixel scale */
+        double scaleTolerance;
+    } Bracket;
+
+    SolverHints();
+
+    /** @short Select the optical train whose history is used and updated. */
+    void setTrain(const QString &train);
+
+    /** @return the search bracket of the next solve. */
+    Bracket bracket() const;
+
+    /** @return the solved pixel scale of the unbinned camera, in arcsecs per pixel, or 0 if unknown. */
+    double scale() const;
+
+    /** @return the last solved orientation, in degrees. */
+    double orientation() const;
+
+    /**
+     * @short Record a solution and tighten the search bracket.
+     * @param scale pixel scale of the unbinned camera, in arcsecs per pixel.
+     * @param orientation orientation of the image, in degrees.
+     * @param pointingError distance between the mount position and the solution, in degrees.
+     */
+    void solved(double scale, double orientation, double pointingError);
+
+    /** @short Record a failed solve and widen the search bracket. */
+    void failed();
+
+  private:
+    typedef struct
+    {
+        double scale;
+        double orientation;
+        /** Smoothed pointing error, in degrees */
+        double pointingError;
+        int bracket;
+    } History;
+
+    void load();
+    void save() const;
+
+    QHash<QString, History> m_History;
+    QString m_Train;
+};
+}
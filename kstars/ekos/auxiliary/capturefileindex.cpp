@@ -0,0 +1,197 @@
+/*  Ekos Capture File Index
+    Copyright (C) 2026 agent <agent@local>
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+ */
+
+#include "capturefileindex.h"
+
+#include <QDir>
+#include <QDirIterator>
+#include <QFileInfo>
+
+#include <algorithm>
+
+#include <ekos_debug.h>
+
+namespace Ekos
+{
+CaptureFileIndex *CaptureFileIndex::_CaptureFileIndex = nullptr;
+
+CaptureFileIndex *CaptureFileIndex::Instance()
+{
+    if (_CaptureFileIndex == nullptr)
+        _CaptureFileIndex = new CaptureFileIndex();
+
+    return _CaptureFileIndex;
+}
+
+int CaptureFileIndex::count(const QString &directory, const QString &prefix)
+{
+    QMutexLocker locker(&lock);
+    return summary(this->directory(directory), prefix, true).count;
+}
+
+int CaptureFileIndex::maxIndex(const QString &directory, const QString &prefix)
+{
+    QMutexLocker locker(&lock);
+    return summary(this->directory(directory), prefix, false).maxIndex;
+}
+
+QDateTime CaptureFileIndex::directoryTime(const QString &filename)
+{
+    return QFileInfo(QFileInfo(filename).absolutePath()).lastModified();
+}
+
+void CaptureFileIndex::addFile(const QString &filename, const QDateTime &modifiedBefore)
+{
+    QFileInfo const info(filename);
+    QString const path = info.absolutePath();
+    QString const fileName = info.fileName();
+
+    // Stat the directory before locking, this is the time that the index will be up to date with
+    QDateTime const checked = QDateTime::currentDateTime();
+    QDateTime const modified = QFileInfo(path).lastModified();
+
+    QMutexLocker locker(&lock);
+
+    auto dir = directories.find(path);
+    if (dir == directories.end())
+        return;
+
+    // Another change before this write would hide behind the new modification time, so list the directory again
+    if (dir->modified != modifiedBefore)
+    {
+        directories.erase(dir);
+        return;
+    }
+
+    if (dir->fileNames.contains(fileName) == false)
+    {
+        QString const name = indexedName(fileName);
+        int const index = sequenceIndex(name);
+        dir->fileNames.insert(fileName);
+        dir->files.insert(name, index);
+
+        // Update cached results in place instead of dropping them
+        for (auto it = dir->summaries.begin(); it != dir->summaries.end(); ++it)
+        {
+            if (matches(name, it.key().first, it.key().second))
+            {
+                it->count++;
+                it->maxIndex = std::max(it->maxIndex, index);
+            }
+        }
+    }
+
+    dir->modified = modified;
+    dir->checked = checked;
+}
+
+void CaptureFileIndex::clear()
+{
+    QMutexLocker locker(&lock);
+    directories.clear();
+}
+
+CaptureFileIndex::Directory &CaptureFileIndex::directory(const QString &path)
+{
+    QString const absolutePath = QDir(path).absolutePath();
+    QDateTime const checked = QDateTime::currentDateTime();
+    QDateTime const modified = QFileInfo(absolutePath).lastModified();
+
+    auto dir = directories.find(absolutePath);
+    if (dir != directories.end())
+    {
+        // A change made right after the last check may not show in the modification time yet
+        if (dir->modified == modified && dir->modified < dir->checked)
+            return *dir;
+    }
+    else dir = directories.insert(absolutePath, Directory());
+
+    dir->modified = modified;
+    dir->checked = checked;
+    dir->fileNames.clear();
+    dir->files.clear();
+    dir->summaries.clear();
+
+    QDirIterator it(absolutePath, QDir::Files);
+    while (it.hasNext())
+    {
+        it.next();
+        QString const name = indexedName(it.fileName());
+        dir->fileNames.insert(it.fileName());
+        dir->files.insert(name, sequenceIndex(name));
+    }
+
+    qCDebug(KSTARS_EKOS) << "Indexed" << dir->files.size() << "files in" << absolutePath;
+
+    return *dir;
+}
+
+CaptureFileIndex::Summary CaptureFileIndex::summary(Directory &dir, const QString &prefix, bool caseSensitive)
+{
+    QPair<QString, bool> const key(prefix, caseSensitive);
+
+    auto cached = dir.summaries.constFind(key);
+    if (cached != dir.summaries.constEnd())
+        return *cached;
+
+    Summary result { 0, -1 };
+    QMultiMap<QString, int> const &files = dir.files;
+
+    if (caseSensitive)
+    {
+        // Names are sorted, so names with the prefix follow each other
+        for (auto it = files.lowerBound(prefix); it != files.constEnd() && it.key().startsWith(prefix); ++it)
+        {
+            result.count++;
+            result.maxIndex = std::max(result.maxIndex, it.value());
+        }
+    }
+    else
+    {
+        for (auto it = files.constBegin(); it != files.constEnd(); ++it)
+        {
+            if (matches(it.key(), prefix, false))
+            {
+                result.count++;
+                result.maxIndex = std::max(result.maxIndex, it.value());
+            }
+        }
+    }
+
+    dir.summaries.insert(key, result);
+    return result;
+}
+
+QString CaptureFileIndex::indexedName(const QString &fileName)
+{
+    // This removes any additional extension (e.g. m42_001.fits.fz)
+    // the completeBaseName() would return m42_001.fits
+    // and this removes .fits so we end up with m42_001
+    return QFileInfo(fileName).completeBaseName().remove(".fits");
+}
+
+int CaptureFileIndex::sequenceIndex(const QString &name)
+{
+    int const lastUnderScoreIndex = name.lastIndexOf("_");
+    if (lastUnderScoreIndex > 0)
+    {
+        bool indexOK = false;
+        int const index = name.midRef(lastUnderScoreIndex + 1).toInt(&indexOK);
+        if (indexOK && index >= 0)
+            return index;
+    }
+
+    return -1;
+}
+
+bool CaptureFileIndex::matches(const QString &name, const QString &prefix, bool caseSensitive)
+{
+    return name.startsWith(prefix, caseSensitive ? Qt::CaseSensitive : Qt::CaseInsensitive);
+}
+}
@@ -0,0 +1,127 @@
+/*  Ekos Capture File Index
+    Copyright (C) 2026 agent <agent@local>
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+ */
+
+#pragma once
+
+#include <QDateTime>
+#include <QHash>
+#include <QMap>
+#include <QMutex>
+#include <QPair>
+#include <QSet>
+#include <QString>
+
+namespace Ekos
+{
+/**
+ * @class CaptureFileIndex
+ * @short Index of the captured files in storage directories, shared by Capture and Scheduler.
+ *
+ * Capture needs the highest sequence number in use for a prefix, and Scheduler needs the number of files captured
+ * for a prefix. Instead of listing the whole directory for each of these queries, the index lists a directory once,
+ * keeps the base names of its files in memory, and caches the result of each query by prefix.
+ *
+ * Files created by KStars are added to the index as they are written, which keeps cached results up to date, provided
+ * the directory did not change between the last listing and the write. Files added or removed by other means are
+ * detected by comparing the modification time of the directory with the one recorded when it was last listed or
+ * updated, in which case the directory is listed again. Detection is limited
+ * by the timestamp resolution of the file system.
+ *
+ * File names are indexed without their extension and without any ".fits" part, so that "m42_001.fits.fz" is found
+ * as "m42_001". The sequence number of a file is the integer following the last underscore of its name.
+ *
+ * All functions are thread-safe.
+ *
+ * @version 1.0
+ */
+class CaptureFileIndex
+{
+    public:
+        static CaptureFileIndex *Instance();
+
+        /**
+         * @brief count Get the number of files with a given prefix in a directory.
+         * @param directory path of the directory.
+         * @param prefix case-sensitive prefix of the file names.
+         * @return number of files whose name starts with the prefix.
+         */
+        int count(const QString &directory, const QString &prefix);
+
+        /**
+         * @brief maxIndex Get the highest sequence number in use for a given prefix in a directory.
+         * @param directory path of the directory.
+         * @param prefix case-insensitive prefix of the file names.
+         * @return highest sequence number of the files whose name starts with the prefix, or -1 if there is none.
+         */
+        int maxIndex(const QString &directory, const QString &prefix);
+
+        /**
+         * @brief addFile Record a file that was just created or written.
+         * @param filename path of the file.
+         * @param modifiedBefore modification time of the directory of the file before it was written, see directoryTime().
+         * @note This does nothing if the directory of the file was not listed yet. If the directory changed since it was
+         * listed and before the file was written, it is dropped from the index, to be listed again on the next query.
+         */
+        void addFile(const QString &filename, const QDateTime &modifiedBefore);
+
+        /** @return the modification time of the directory of a file, to pass to addFile() after writing the file. */
+        static QDateTime directoryTime(const QString &filename);
+
+        /** @brief clear Drop all cached directories. */
+        void clear();
+
+    private:
+        CaptureFileIndex() = default;
+        ~CaptureFileIndex() = default;
+
+        /** Query result for a prefix */
+        typedef struct
+        {
+            /** Number of files with the prefix */
+            int count;
+            /** Highest sequence number of the files with the prefix, -1 if none */
+            int maxIndex;
+        } Summary;
+
+        typedef struct
+        {
+            /** Modification time of the directory when it was last listed or updated */
+            QDateTime modified;
+            /** Time the modification time was read, a change made before this time cannot be told apart from it */
+            QDateTime checked;
+            /** Names of the files in the directory */
+            QSet<QString> fileNames;
+            /** Sequence number of each file, by indexed name, -1 if the file has none */
+            QMultiMap<QString, int> files;
+            /** Cached results, by case-sensitive and case-insensitive prefix */
+            QHash<QPair<QString, bool>, Summary> summaries;
+        } Directory;
+
+        /** @internal Get the index of a directory, listing it if it is missing or changed. Must be called locked. */
+        Directory &directory(const QString &path);
+
+        /** @internal Get or compute the result of a query. Must be called locked. */
+        Summary summary(Directory &dir, const QString &prefix, bool caseSensitive);
+
+        /** @internal Get the indexed name of a file, from its file name. */
+        static QString indexedName(const QString &fileName);
+
+        /** @internal Get the sequence number of an indexed name, or -1 if it has none. */
+        static int sequenceIndex(const QString &name);
+
+        static bool matches(const QString &name, const QString &prefix, bool caseSensitive);
+
+        static CaptureFileIndex *_CaptureFileIndex;
+
+        QMutex lock;
+
+        /** Indexed directories, by absolute path */
+        QHash<QString, Directory> directories;
+};
+}
@@ -482,15 +482,13 @@ void DarkLibrary::captureAndSubtract(ISD::CCDChip *targetChip, FITSView *targetI
 
 void DarkLibrary::newFITS(IBLOB * bp)
 {
-    INDI_UNUSED(bp);
-
     Q_ASSERT(subtractParams.targetChip);
 
     disconnect(subtractParams.targetChip->getCCD(), SIGNAL(BLOBUpdated(IBLOB*)), this, SLOT(newFITS(IBLOB*)));
 
     FITSView *calibrationView = subtractParams.targetChip->getImageView(FITS_CALIBRATE);
 
-    if (calibrationView == nullptr)
+    if (calibrationView == nullptr || bp == nullptr)
     {
         emit darkFrameCompleted(false);
         return;
@@ -500,8 +498,8 @@ void DarkLibrary::newFITS(IBLOB * bp)
 
     FITSData *calibrationData = new FITSData();
 
-    // Deep copy of the data
-    if (calibrationData->loadFITS(calibrationView->getImageData()->filename()))
+    // Deep copy of the data, straight from the blob still in memory
+    if (calibrationData->loadFITSFromMemory(calibrationView->getImageData()->filename(), bp->blob, bp->size, true))
     {
         saveDarkFile(calibrationData);
         subtract(calibrationData, subtractParams.targetImage, subtractParams.targetChip->getCaptureFilter(),
@@ -144,18 +144,28 @@ void Cloud::sendPreviewImage(const QString &filename, const QString &uuid)
     watcher.setFuture(result);
 }
 
+void Cloud::sendPreviewImage(FITSView * view, const QFuture<void> &fileWrite, const QString &uuid)
+{
+    if (m_isConnected == false || m_Options[OPTION_SET_CLOUD_STORAGE] == false  || m_sendBlobs == false)
+        return;
+
+    m_UUID = uuid;
+    upload(view->getImageData(), fileWrite);
+}
+
 void Cloud::sendImage()
 {
-    QtConcurrent::run(this, &Cloud::asyncUpload);
+    upload(imageData.get(), QFuture<void>());
+    imageData.reset();
 }
 
-void Cloud::asyncUpload()
+void Cloud::upload(const FITSData *data, const QFuture<void> &fileWrite)
 {
     // Send complete metadata
     // Add file name and size
     QJsonObject metadata;
     // Skip empty or useless metadata
-    for (FITSData::Record * oneRecord : imageData->getRecords())
+    for (FITSData::Record * oneRecord : data->getRecords())
     {
         if (oneRecord->key == "EXTEND" || oneRecord->key == "SIMPLE" || oneRecord->key == "COMMENT" ||
                 oneRecord->key.isEmpty() || oneRecord->value.toString().isEmpty())
@@ -164,29 +174,40 @@ void Cloud::asyncUpload()
     }
 
     // Filename only without path
-    QString filepath = imageData->isCompressed() ? imageData->compressedFilename() : imageData->filename();
+    QString filepath = data->isCompressed() ? data->compressedFilename() : data->filename();
     QString filenameOnly = QFileInfo(filepath).fileName();
+    // Captures may be compressed on their way to the disk
+    bool const isCompressed = data->isCompressed() || filepath.endsWith(".fz");
 
     // Add filename and size as wells
     metadata.insert("uuid", m_UUID);
     metadata.insert("filename", filenameOnly);
-    metadata.insert("filesize", static_cast<int>(imageData->size()));
+    metadata.insert("filesize", static_cast<int>(data->size()));
     // Must set Content-Disposition so
-    if (imageData->isCompressed())
+    if (isCompressed)
         metadata.insert("Content-Disposition", QString("attachment;filename=%1").arg(filenameOnly));
     else
         metadata.insert("Content-Disposition", QString("attachment;filename=%1.fz").arg(filenameOnly));
 
+    // Metadata is collected here as the image data may be gone by the time the upload runs
+    QtConcurrent::run(this, &Cloud::asyncUpload, metadata, filepath, isCompressed, fileWrite);
+}
+
+void Cloud::asyncUpload(const QJsonObject &metadata, const QString &filepath, bool isCompressed, QFuture<void> fileWrite)
+{
     emit newMetadata(QJsonDocument(metadata).toJson(QJsonDocument::Compact));
     //m_WebSocket.sendTextMessage(QJsonDocument(metadata).toJson(QJsonDocument::Compact));
 
     qCInfo(KSTARS_EKOS) << "Uploading file to the cloud with metadata" << metadata;
 
+    // The image may still be written to disk in the background
+    fileWrite.waitForFinished();
+
     QString compressedFile = filepath;
     // Use cfitsio pack to compress the file first
-    if (imageData->isCompressed() == false)
+    if (isCompressed == false)
     {
-        compressedFile = QDir::tempPath() + QString("/ekoslivecloud%1").arg(m_UUID);
+        compressedFile = QDir::tempPath() + QString("/ekoslivecloud%1").arg(metadata["uuid"].toString());
 
         int isLossLess = 0;
         fpstate	fpvar;
@@ -213,8 +234,6 @@ void Cloud::asyncUpload()
     // Remove from disk if temporary
     if (compressedFile != filepath && compressedFile.startsWith(QDir::tempPath()))
         QFile::remove(compressedFile);
-
-    imageData.reset();
 }
 
 void Cloud::uploadMetadata(const QByteArray &metadata)
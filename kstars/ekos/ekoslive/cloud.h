@@ -46,6 +46,8 @@ class Cloud : public QObject
 
         // Ekos Cloud Message to User
         void sendPreviewImage(const QString &filename, const QString &uuid);
+        // Same as above, using the image already loaded in the view once its file is written to disk
+        void sendPreviewImage(FITSView *view, const QFuture<void> &fileWrite, const QString &uuid);
 
     signals:
         void connected();
@@ -76,7 +78,8 @@ class Cloud : public QObject
         void uploadImage(const QByteArray &image);
 
     private:
-        void asyncUpload();
+        void upload(const FITSData *data, const QFuture<void> &fileWrite);
+        void asyncUpload(const QJsonObject &metadata, const QString &filepath, bool isCompressed, QFuture<void> fileWrite);
 
         QWebSocket m_WebSocket;
         QJsonObject m_AuthResponse;
@@ -2940,7 +2940,7 @@ void Focus::syncTrackingBoxPosition()
 void Focus::showFITSViewer()
 {
     FITSData *data = focusView->getImageData();
-    if (data)
+    if (data && data->ensureFileOnDisk())
     {
         QUrl url = QUrl::fromLocalFile(data->filename());
 
@@ -2949,7 +2949,7 @@ void Guide::processGuideOptions()
 void Guide::showFITSViewer()
 {
     FITSData *data = guideView->getImageData();
-    if (data)
+    if (data && data->ensureFileOnDisk())
     {
         QUrl url = QUrl::fromLocalFile(data->filename());
 
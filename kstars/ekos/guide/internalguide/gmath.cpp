@@ -20,6 +20,7 @@
 #include "ekos_guide_debug.h"
 
 #include <QVector3D>
+#include <algorithm>
 #include <cmath>
 #include <set>
 
@@ -98,11 +99,6 @@ cgmath::~cgmath()
 {
     delete[] drift[GUIDE_RA];
     delete[] drift[GUIDE_DEC];
-
-    foreach (float *region, referenceRegions)
-        delete[] region;
-
-    referenceRegions.clear();
 }
 
 bool cgmath::setVideoParameters(int vid_wd, int vid_ht, int binX, int binY)
@@ -528,12 +524,16 @@ void cgmath::start(void)
     // Create reference Image
     if (imageGuideEnabled)
     {
-        foreach (float *region, referenceRegions)
-            delete[] region;
-
         referenceRegions.clear();
 
-        referenceRegions = partitionImage();
+        // The spectra of the reference regions are computed once here, not on every frame
+        for (float *region : partitionImage())
+        {
+            ImageAutoGuiding::ShiftEstimator estimator(regionAxis);
+            estimator.setReference(region);
+            referenceRegions.append(estimator);
+            delete[] region;
+        }
 
         reticle_pos = Vector(0, 0, 0);
     }
@@ -657,24 +657,56 @@ float *cgmath::createFloatImage(FITSData *target) const
 
 QVector<float *> cgmath::partitionImage() const
 {
-    QVector<float *> regions;
-
     FITSData *imageData = guideView->getImageData();
 
-    float *imgFloat = createFloatImage();
+    switch (imageData->property("dataType").toInt())
+    {
+        case TBYTE:
+            return partitionImage<uint8_t>();
+
+        case TSHORT:
+            return partitionImage<int16_t>();
+
+        case TUSHORT:
+            return partitionImage<uint16_t>();
 
-    if (imgFloat == nullptr)
-        return regions;
+        case TLONG:
+            return partitionImage<int32_t>();
+
+        case TULONG:
+            return partitionImage<uint32_t>();
+
+        case TFLOAT:
+            return partitionImage<float>();
+
+        case TLONGLONG:
+            return partitionImage<int64_t>();
+
+        case TDOUBLE:
+            return partitionImage<double>();
+
+        default:
+            break;
+    }
+
+    return QVector<float *>();
+}
+
+template <typename T>
+QVector<float *> cgmath::partitionImage() const
+{
+    QVector<float *> regions;
+
+    FITSData *imageData = guideView->getImageData();
 
     const uint16_t width  = imageData->width();
     const uint16_t height = imageData->height();
 
     uint8_t xRegions = floor(width / regionAxis);
     uint8_t yRegions = floor(height / regionAxis);
-    // Find number of regions to divide the image
-    //uint8_t regions =  xRegions * yRegions;
 
-    float *regionPtr = imgFloat;
+    // Regions are converted to float straight from the image buffer, the frame itself is never converted
+    const T *buffer = reinterpret_cast<const T *>(imageData->getImageBuffer());
 
     for (uint8_t i = 0; i < yRegions; i++)
     {
@@ -682,27 +714,16 @@ QVector<float *> cgmath::partitionImage() const
         {
             // Allocate space for one region
             float *oneRegion = new float[regionAxis * regionAxis];
-            // Create points to region and current location of the source image in the desired region
-            float *oneRegionPtr = oneRegion, *imgFloatPtr = regionPtr + j * regionAxis;
+            const T *source = buffer + i * regionAxis * width + j * regionAxis;
 
             // copy from image to region line by line
             for (uint32_t line = 0; line < regionAxis; line++)
-            {
-                memcpy(oneRegionPtr, imgFloatPtr, regionAxis);
-                oneRegionPtr += regionAxis;
-                imgFloatPtr += width;
-            }
+                std::copy(source + line * width, source + line * width + regionAxis, oneRegion + line * regionAxis);
 
             regions.append(oneRegion);
         }
-
-        // Move regionPtr block by (width * regionAxis) elements
-        regionPtr += width * regionAxis;
     }
 
-    // We're done with imgFloat
-    delete[] imgFloat;
-
     return regions;
 }
 
@@ -711,7 +732,7 @@ void cgmath::setRegionAxis(const uint32_t &value)
     regionAxis = value;
 }
 
-Vector cgmath::findLocalStarPosition(void) const
+Vector cgmath::findLocalStarPosition(void)
 {
     if (useRapidGuide)
     {
@@ -724,7 +745,7 @@ Vector cgmath::findLocalStarPosition(void) const
     {
         float xshift = 0, yshift = 0;
 
-        QVector<Vector> shifts;
+        QVector<float> xshifts, yshifts;
         float xsum = 0, ysum = 0;
 
         QVector<float *> imagePartition = partitionImage();
@@ -748,15 +769,15 @@ Vector cgmath::findLocalStarPosition(void) const
             return Vector(-1, -1, -1);
         }
 
-        for (uint8_t i = 0; i < imagePartition.count(); i++)
+        for (int i = 0; i < imagePartition.count(); i++)
         {
-            ImageAutoGuiding::ImageAutoGuiding1(referenceRegions[i], imagePartition[i], regionAxis, &xshift, &yshift);
-            Vector shift(xshift, yshift, -1);
+            referenceRegions[i].estimate(imagePartition[i], &xshift, &yshift);
             qCDebug(KSTARS_EKOS_GUIDE) << "Region #" << i << ": X-Shift=" << xshift << "Y-Shift=" << yshift;
 
             xsum += xshift;
             ysum += yshift;
-            shifts.append(shift);
+            xshifts.append(xshift);
+            yshifts.append(yshift);
         }
 
         // Delete partitions
@@ -769,8 +790,10 @@ Vector cgmath::findLocalStarPosition(void) const
         float average_x = xsum / referenceRegions.count();
         float average_y = ysum / referenceRegions.count();
 
-        float median_x = shifts[referenceRegions.count() / 2 - 1].x;
-        float median_y = shifts[referenceRegions.count() / 2 - 1].y;
+        std::nth_element(xshifts.begin(), xshifts.begin() + xshifts.count() / 2, xshifts.end());
+        std::nth_element(yshifts.begin(), yshifts.begin() + yshifts.count() / 2, yshifts.end());
+        float median_x = xshifts[xshifts.count() / 2];
+        float median_y = yshifts[yshifts.count() / 2];
 
         qCDebug(KSTARS_EKOS_GUIDE) << "Average : X-Shift=" << average_x << "Y-Shift=" << average_y;
         qCDebug(KSTARS_EKOS_GUIDE) << "Median  : X-Shift=" << median_x << "Y-Shift=" << median_y;
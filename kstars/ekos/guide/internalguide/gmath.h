@@ -13,6 +13,7 @@
 
 #include "matr.h"
 #include "vect.h"
+#include "imageautoguiding.h"
 #include "indi/indicommon.h"
 
 #include <QObject>
@@ -149,7 +150,7 @@ class cgmath : public QObject
     // Star tracking
     void getStarDrift(double *dx, double *dy) const;
     void getStarScreenPosition(double *dx, double *dy) const;
-    Vector findLocalStarPosition(void) const;
+    Vector findLocalStarPosition(void);
     bool isStarLost(void) const;
     void setLostStar(bool is_lost);
 
@@ -248,8 +249,11 @@ class cgmath : public QObject
     // Partition guideView image into NxN square regions each of size axis*axis. The returned vector contains pointers to
     // the newly allocated square images. It MUST be deleted later by delete[] or memory will leak.
     QVector<float *> partitionImage() const;
+    template <typename T>
+    QVector<float *> partitionImage() const;
     uint32_t regionAxis { 64 };
-    QVector<float *> referenceRegions;
+    // Shift estimators holding the spectrum of each region of the reference image
+    QVector<ImageAutoGuiding::ShiftEstimator> referenceRegions;
 
     // dithering
     double ditherRate[2];
@@ -9,450 +9,276 @@
 
 #include "imageautoguiding.h"
 
-#include <qglobal.h>
-
+#include <algorithm>
 #include <cmath>
-
-#define SWAP(a, b) \
-    tempr = (a);   \
-    (a)   = (b);   \
-    (b)   = tempr
-#define NR_END   1
-#define FREE_ARG char *
+#include <limits>
 
 #define TWOPI   6.28318530717959
+// Highest spatial frequency used to refine the shift, in cycles per pixel
 #define FFITMAX 0.05
 
-//void ImageAutoGuiding1(float *ref,float *im,int n,float *xshift,float *yshift);
-
-float ***f3tensorSP(long nrl, long nrh, long ncl, long nch, long ndl, long ndh);
-void free_f3tensorSP(float ***t, long nrl, long nrh, long ncl, long nch, long ndl, long ndh);
-
-float **matrixSP(long nrl, long nrh, long ncl, long nch);
-
-void free_matrixSP(float **m, long nrl, long nrh, long ncl, long nch);
-void nrerrorNR(void);
-
-void fournNR(float data[], unsigned long nn[], long ndim, long isign);
-
-void rlft3NR(float ***data, float **speq, unsigned long nn1, unsigned long nn2, unsigned long nn3, long isign);
+namespace
+{
+/** @return the offset of the top of the parabola through three values around a maximum, within half a pixel. */
+double parabolaPeak(double left, double center, double right)
+{
+    double const curvature = left - 2 * center + right;
+    if (curvature >= 0)
+        return 0;
 
-void ShiftEST(float ***testimage, float ***refimage, int n, float *xshift, float *yshift, int k);
+    return std::max(-0.5, std::min(0.5, 0.5 * (left - right) / curvature));
+}
+}
 
 namespace ImageAutoGuiding
 {
-void ImageAutoGuiding1(float *ref, float *im, int n, float *xshift, float *yshift)
+FFT2D::FFT2D(int n) : m_N(n)
 {
-    float ***RefImage, ***TestImage;
-    int i, j, k;
-    float x, y;
-
-    /* Allocate memory */
+    int bits = 0;
+    while ((1 << bits) < n)
+        bits++;
 
-    RefImage  = f3tensorSP(1, 1, 1, n, 1, n);
-    TestImage = f3tensorSP(1, 1, 1, n, 1, n);
-
-    /* Load Data */
-
-    k = 0;
-
-    for (j = 1; j <= n; ++j)
+    m_BitReverse.resize(n);
+    for (int i = 0; i < n; i++)
     {
-        for (i = 1; i <= n; ++i)
-        {
-            RefImage[1][j][i]  = ref[k];
-            TestImage[1][j][i] = im[k];
-
-            k += 1;
-        }
+        int reversed = 0;
+        for (int bit = 0; bit < bits; bit++)
+            reversed |= ((i >> bit) & 1) << (bits - 1 - bit);
+        m_BitReverse[i] = reversed;
     }
 
-    /* Calculate Image Shifts  */
-
-    ShiftEST(TestImage, RefImage, n, &x, &y, 1);
-
-    *xshift = x;
-    *yshift = y;
-
-    /* free memory */
-
-    free_f3tensorSP(RefImage, 1, 1, 1, n, 1, n);
-    free_f3tensorSP(TestImage, 1, 1, 1, n, 1, n);
-}
+    m_Twiddles.resize(n);
+    for (int k = 0; k < n / 2; k++)
+    {
+        m_Twiddles[2 * k]     = static_cast<float>(cos(TWOPI * k / n));
+        m_Twiddles[2 * k + 1] = static_cast<float>(-sin(TWOPI * k / n));
+    }
 }
 
-// Calculates Image Shifts
-
-void ShiftEST(float ***testimage, float ***refimage, int n, float *xshift, float *yshift, int k)
+void FFT2D::forward(float *data) const
 {
-    int ix, iy, nh, nhplusone;
-    double deltax, deltay, fx2sum, fy2sum, phifxsum, phifysum, fxfysum;
-    double fx, fy, ff, fn, re, im, testre, testim, rev, imv, phi;
-    double power, dem, f2, f2limit;
-    float **speq;
+    transformRows(data, false);
+    transformColumns(data, false);
+}
 
-    f2limit = FFITMAX * FFITMAX;
+void FFT2D::inverse(float *data) const
+{
+    transformRows(data, true);
+    transformColumns(data, true);
+}
 
-    speq = matrixSP(1, 1, 1, 2 * n);
+void FFT2D::transformRows(float *data, bool inverse) const
+{
+    float const sign = inverse ? -1 : 1;
 
-    nh        = n / 2;
-    nhplusone = nh + 1;
+    for (int row = 0; row < m_N; row++)
+    {
+        float *x = data + 2 * row * m_N;
 
-    fn = ((float)n);
-    ff = 1.0 / fn;
+        for (int i = 0; i < m_N; i++)
+        {
+            int const j = m_BitReverse[i];
+            if (i < j)
+            {
+                std::swap(x[2 * i], x[2 * j]);
+                std::swap(x[2 * i + 1], x[2 * j + 1]);
+            }
+        }
 
-    /* FFT of Reference */
+        for (int length = 2; length <= m_N; length <<= 1)
+        {
+            int const half = length / 2;
+            int const step = m_N / length;
 
-    for (ix = 1; ix <= 2 * n; ++ix)
-    {
-        speq[1][ix] = 0.0;
+            for (int start = 0; start < m_N; start += length)
+            {
+                for (int k = 0; k < half; k++)
+                {
+                    float const wr = m_Twiddles[2 * k * step];
+                    float const wi = sign * m_Twiddles[2 * k * step + 1];
+                    float *a = x + 2 * (start + k);
+                    float *b = a + 2 * half;
+
+                    float const tr = wr * b[0] - wi * b[1];
+                    float const ti = wr * b[1] + wi * b[0];
+                    b[0] = a[0] - tr;
+                    b[1] = a[1] - ti;
+                    a[0] += tr;
+                    a[1] += ti;
+                }
+            }
+        }
     }
+}
 
-    rlft3NR(refimage, speq, 1, n, n, 1);
-
-    /* FFT of Test Image */
+void FFT2D::transformColumns(float *data, bool inverse) const
+{
+    float const sign = inverse ? -1 : 1;
+    int const rowLength = 2 * m_N;
 
-    for (ix = 1; ix <= 2 * n; ++ix)
+    // Same as the rows, but each element is a whole row, so all columns are transformed together
+    for (int i = 0; i < m_N; i++)
     {
-        speq[1][ix] = 0.0;
+        int const j = m_BitReverse[i];
+        if (i < j)
+            std::swap_ranges(data + i * rowLength, data + (i + 1) * rowLength, data + j * rowLength);
     }
 
-    rlft3NR(testimage, speq, 1, n, n, 1);
-
-    /* Solving for slopes  */
-
-    fx2sum = 0.0;
-    fy2sum = 0.0;
-
-    phifxsum = 0.0;
-    phifysum = 0.0;
-
-    fxfysum = 0.0;
-
-    for (ix = 1; ix <= n; ++ix)
+    for (int length = 2; length <= m_N; length <<= 1)
     {
-        if (ix <= nhplusone)
-        {
-            fx = ff * ((float)(ix - 1));
-        }
-        else
-        {
-            fx = -ff * ((float)(n + 1 - ix));
-        }
+        int const half = length / 2;
+        int const step = m_N / length;
 
-        for (iy = 1; iy <= nh; ++iy)
+        for (int start = 0; start < m_N; start += length)
         {
-            fy = ff * ((float)(iy - 1));
-
-            f2 = fx * fx + fy * fy;
-
-            /* Limit to Low Spatial Frequencies */
-
-            if (f2 < f2limit)
+            for (int k = 0; k < half; k++)
             {
-                /* Real part reference image */
+                float const wr = m_Twiddles[2 * k * step];
+                float const wi = sign * m_Twiddles[2 * k * step + 1];
+                float *a = data + (start + k) * rowLength;
+                float *b = a + half * rowLength;
 
-                re = refimage[k][ix][2 * iy - 1];
+                for (int c = 0; c < rowLength; c += 2)
+                {
+                    float const tr = wr * b[c] - wi * b[c + 1];
+                    float const ti = wr * b[c + 1] + wi * b[c];
+                    b[c]     = a[c] - tr;
+                    b[c + 1] = a[c + 1] - ti;
+                    a[c] += tr;
+                    a[c + 1] += ti;
+                }
+            }
+        }
+    }
+}
 
-                /* Imaginary part reference image */
+ShiftEstimator::ShiftEstimator(int n) : m_FFT(n), m_Correlation(2 * n * n)
+{
+}
 
-                im = refimage[k][ix][2 * iy];
+void ShiftEstimator::loadSpectrum(const float *image, QVector<float> &spectrum) const
+{
+    int const size = m_FFT.size() * m_FFT.size();
 
-                power = re * re + im * im;
+    double sum = 0;
+    for (int i = 0; i < size; i++)
+        sum += image[i];
+    float const mean = static_cast<float>(sum / size);
 
-                /* Real part test image */
+    spectrum.resize(2 * size);
+    float *data = spectrum.data();
+    for (int i = 0; i < size; i++)
+    {
+        data[2 * i]     = image[i] - mean;
+        data[2 * i + 1] = 0;
+    }
 
-                testre = testimage[k][ix][2 * iy - 1];
+    m_FFT.forward(data);
+}
 
-                /* Imaginary part image */
+void ShiftEstimator::setReference(const float *reference)
+{
+    loadSpectrum(reference, m_Reference);
+}
 
-                testim = testimage[k][ix][2 * iy];
+void ShiftEstimator::estimate(const float *image, float *xshift, float *yshift)
+{
+    *xshift = 0;
+    *yshift = 0;
 
-                rev = re * testre + im * testim;
-                imv = re * testim - im * testre;
+    if (hasReference() == false)
+        return;
 
-                /* Find Phase */
+    int const n = m_FFT.size();
+    int const size = n * n;
 
-                phi = atan2(imv, rev);
+    loadSpectrum(image, m_Spectrum);
 
-                fx2sum += power * fx * fx;
-                fy2sum += power * fy * fy;
+    // Cross-power spectrum, image times conjugate of reference, kept in m_Spectrum for the refinement
+    float *cross = m_Spectrum.data();
+    const float *reference = m_Reference.constData();
+    for (int i = 0; i < size; i++)
+    {
+        float const tr = cross[2 * i], ti = cross[2 * i + 1];
+        float const rr = reference[2 * i], ri = reference[2 * i + 1];
+        cross[2 * i]     = tr * rr + ti * ri;
+        cross[2 * i + 1] = ti * rr - tr * ri;
+    }
 
-                phifxsum += power * fx * phi;
-                phifysum += power * fy * phi;
+    // Its inverse transform is the cross-correlation, which peaks at the shift
+    std::copy(m_Spectrum.constBegin(), m_Spectrum.constEnd(), m_Correlation.begin());
+    m_FFT.inverse(m_Correlation.data());
+    const float *correlation = m_Correlation.constData();
 
-                fxfysum += power * fx * fy;
-            }
+    int peak = 0;
+    float best = -std::numeric_limits<float>::max();
+    for (int i = 0; i < size; i++)
+    {
+        if (correlation[2 * i] > best)
+        {
+            best = correlation[2 * i];
+            peak = i;
         }
     }
 
-    /* calculate subpixel shift */
-
-    dem = fx2sum * fy2sum - fxfysum * fxfysum;
-
-    deltax = (phifxsum * fy2sum - fxfysum * phifysum) / (dem * TWOPI);
-    deltay = (phifysum * fx2sum - fxfysum * phifxsum) / (dem * TWOPI);
-
-    free_matrixSP(speq, 1, 1, 1, 2 * n);
-
-    /* You can change the shift mapping here */
+    int const px = peak % n, py = peak / n;
+    auto value = [&](int x, int y)
+    {
+        return static_cast<double>(correlation[2 * (((y + n) % n) * n + (x + n) % n)]);
+    };
 
-    *xshift = deltax;
-    *yshift = deltay;
-}
+    // Shifts past half the region wrap around to negative shifts
+    double sx = (px > n / 2 ? px - n : px) + parabolaPeak(value(px - 1, py), best, value(px + 1, py));
+    double sy = (py > n / 2 ? py - n : py) + parabolaPeak(value(px, py - 1), best, value(px, py + 1));
 
-// 2 and 3 Dimensional FFT Routine for Real Data
-// Numerical Recipes in C Second Edition
-// The Art of Scientific Computing
-// 1999
+    // Refine with the phase slope at low frequencies, once the estimated shift is removed from the phase
+    double fx2sum = 0, fy2sum = 0, fxfysum = 0, phifxsum = 0, phifysum = 0;
+    double const f2limit = FFITMAX * FFITMAX;
 
-void rlft3NR(float ***data, float **speq, unsigned long nn1, unsigned long nn2, unsigned long nn3, long isign)
-{
-    void fournNR(float data[], unsigned long nn[], long ndim, long isign);
-    void nrerror();
-    unsigned long i1, i2, i3, j1, j2, j3, nn[4], ii3;
-    double theta, wpi, wpr, wtemp;
-    float c1, c2, h1r, h1i, h2r, h2i;
-    float wi, wr;
-
-    if ((unsigned long)(1 + &data[nn1][nn2][nn3] - &data[1][1][1]) != nn1 * nn2 * nn3)
-        nrerrorNR();
-    c1    = 0.5;
-    c2    = -0.5 * isign;
-    theta = isign * (6.28318530717959 / nn3);
-    wtemp = sin(0.5 * theta);
-    wpr   = -2.0 * wtemp * wtemp;
-    wpi   = sin(theta);
-    nn[1] = nn1;
-    nn[2] = nn2;
-    nn[3] = nn3 >> 1;
-    if (isign == 1)
-    {
-        fournNR(&data[1][1][1] - 1, nn, 3, isign);
-        for (i1 = 1; i1 <= nn1; i1++)
-            for (i2 = 1, j2 = 0; i2 <= nn2; i2++)
-            {
-                speq[i1][++j2] = data[i1][i2][1];
-                speq[i1][++j2] = data[i1][i2][2];
-            }
-    }
-    for (i1 = 1; i1 <= nn1; i1++)
+    for (int ky = 0; ky < n; ky++)
     {
-        j1 = (i1 != 1 ? nn1 - i1 + 2 : 1);
-        wr = 1.0;
-        wi = 0.0;
-        for (ii3 = 1, i3 = 1; i3 <= (nn3 >> 2) + 1; i3++, ii3 += 2)
+        double const fy = static_cast<double>(ky <= n / 2 ? ky : ky - n) / n;
+
+        // The spectrum of a real image is symmetric, half of the frequencies are enough
+        for (int kx = 0; kx <= n / 2; kx++)
         {
-            for (i2 = 1; i2 <= nn2; i2++)
-            {
-                if (i3 == 1)
-                {
-                    j2               = (i2 != 1 ? ((nn2 - i2) << 1) + 3 : 1);
-                    h1r              = c1 * (data[i1][i2][1] + speq[j1][j2]);
-                    h1i              = c1 * (data[i1][i2][2] - speq[j1][j2 + 1]);
-                    h2i              = c2 * (data[i1][i2][1] - speq[j1][j2]);
-                    h2r              = -c2 * (data[i1][i2][2] + speq[j1][j2 + 1]);
-                    data[i1][i2][1]  = h1r + h2r;
-                    data[i1][i2][2]  = h1i + h2i;
-                    speq[j1][j2]     = h1r - h2r;
-                    speq[j1][j2 + 1] = h2i - h1i;
-                }
-                else
-                {
-                    j2                    = (i2 != 1 ? nn2 - i2 + 2 : 1);
-                    j3                    = nn3 + 3 - (i3 << 1);
-                    h1r                   = c1 * (data[i1][i2][ii3] + data[j1][j2][j3]);
-                    h1i                   = c1 * (data[i1][i2][ii3 + 1] - data[j1][j2][j3 + 1]);
-                    h2i                   = c2 * (data[i1][i2][ii3] - data[j1][j2][j3]);
-                    h2r                   = -c2 * (data[i1][i2][ii3 + 1] + data[j1][j2][j3 + 1]);
-                    data[i1][i2][ii3]     = h1r + wr * h2r - wi * h2i;
-                    data[i1][i2][ii3 + 1] = h1i + wr * h2i + wi * h2r;
-                    data[j1][j2][j3]      = h1r - wr * h2r + wi * h2i;
-                    data[j1][j2][j3 + 1]  = -h1i + wr * h2i + wi * h2r;
-                }
-            }
-            wr = (wtemp = wr) * wpr - wi * wpi + wr;
-            wi = wi * wpr + wtemp * wpi + wi;
+            double const fx = static_cast<double>(kx) / n;
+            double const f2 = fx * fx + fy * fy;
+            if (f2 == 0 || f2 >= f2limit)
+                continue;
+
+            int const i = ky * n + kx;
+            double const angle = TWOPI * (fx * sx + fy * sy);
+            double const re = cross[2 * i] * cos(angle) - cross[2 * i + 1] * sin(angle);
+            double const im = cross[2 * i] * sin(angle) + cross[2 * i + 1] * cos(angle);
+
+            double const power = sqrt(re * re + im * im);
+            double const phi = atan2(im, re);
+
+            fx2sum += power * fx * fx;
+            fy2sum += power * fy * fy;
+            fxfysum += power * fx * fy;
+            phifxsum += power * fx * phi;
+            phifysum += power * fy * phi;
         }
     }
-    if (isign == -1)
-        fournNR(&data[1][1][1] - 1, nn, 3, isign);
-}
 
-// Multi-Dimensional FFT Routine for Complex Data
-// Numerical Recipes in C Second Edition
-// The Art of Scientific Computing
-// 1999
-// Used in rlft3
-
-void fournNR(float data[], unsigned long nn[], long ndim, long isign)
-{
-    long idim;
-    unsigned long i1, i2rev, i3rev, ip1, ip2, ip3, ifp1, ifp2;
-    unsigned long i2, i3;
-    unsigned long ibit, k1 = 0, k2, n, nprev, nrem, ntot;
-    float wi, wr, tempi, tempr;
-    double theta, wpi, wpr, wtemp;
-
-    for (ntot = 1, idim = 1; idim <= ndim; idim++)
-        ntot *= nn[idim];
-    nprev = 1;
-    for (idim = ndim; idim >= 1; idim--)
+    double const dem = fx2sum * fy2sum - fxfysum * fxfysum;
+    if (dem > 0)
     {
-        n     = nn[idim];
-        nrem  = ntot / (n * nprev);
-        ip1   = nprev << 1;
-        ip2   = ip1 * n;
-        ip3   = ip2 * nrem;
-        i2rev = 1;
-        for (i2 = 1; i2 <= ip2; i2 += ip1)
-        {
-            if (i2 < i2rev)
-            {
-                for (i1 = i2; i1 <= i2 + ip1 - 2; i1 += 2)
-                {
-                    for (i3 = i1; i3 <= ip3; i3 += ip2)
-                    {
-                        i3rev = i2rev + i3 - i2;
-                        SWAP(data[i3], data[i3rev]);
-                        SWAP(data[i3 + 1], data[i3rev + 1]);
-                    }
-                }
-            }
-            ibit = ip2 >> 1;
-            while (ibit >= ip1 && i2rev > ibit)
-            {
-                i2rev -= ibit;
-                ibit >>= 1;
-            }
-            i2rev += ibit;
-        }
-        ifp1 = ip1;
-        while (ifp1 < ip2)
+        // The phase is -2 pi f.(shift - estimate)
+        double const deltax = (phifxsum * fy2sum - fxfysum * phifysum) / (dem * TWOPI);
+        double const deltay = (phifysum * fx2sum - fxfysum * phifxsum) / (dem * TWOPI);
+
+        // Larger corrections come from noise, the peak is within a pixel
+        if (std::fabs(deltax) < 1 && std::fabs(deltay) < 1)
         {
-            ifp2  = ifp1 << 1;
-            theta = isign * 6.28318530717959 / (ifp2 / ip1);
-            wtemp = sin(0.5 * theta);
-            wpr   = -2.0 * wtemp * wtemp;
-            wpi   = sin(theta);
-            wr    = 1.0;
-            wi    = 0.0;
-            for (i3 = 1; i3 <= ifp1; i3 += ip1)
-            {
-                for (i1 = i3; i1 <= i3 + ip1 - 2; i1 += 2)
-                {
-                    for (i2 = i1; i2 <= ip3; i2 += ifp2)
-                    {
-                        k1           = i2;
-                        k2           = k1 + ifp1;
-                        tempr        = (double)wr * data[k2] - (double)wi * data[k2 + 1];
-                        tempi        = (double)wr * data[k2 + 1] + (double)wi * data[k2];
-                        data[k2]     = data[k1] - tempr;
-                        data[k2 + 1] = data[k1 + 1] - tempi;
-                        data[k1] += tempr;
-                        data[k1 + 1] += tempi;
-                    }
-                }
-                wr = (wtemp = wr) * wpr - wi * wpi + wr;
-                wi = wi * wpr + wtemp * wpi + wi;
-            }
-            ifp1 = ifp2;
+            sx -= deltax;
+            sy -= deltay;
         }
-        nprev *= n;
-    }
-}
-
-void nrerrorNR(void)
-{
-}
-
-// Numerical Recipes memory allocation routines
-// One based arrays
-
-float **matrixSP(long nrl, long nrh, long ncl, long nch)
-/* allocate a float matrix with subscript range m[nrl..nrh][ncl..nch] */
-{
-    long i, nrow = nrh - nrl + 1, ncol = nch - ncl + 1;
-    float **m;
-
-    /* allocate pointers to rows */
-    m = (float **)malloc((size_t)((nrow + NR_END) * sizeof(float *)));
-    if (!m)
-        nrerrorNR();
-    m += NR_END;
-    m -= nrl;
-
-    /* allocate rows and set pointers to them */
-    m[nrl] = (float *)malloc((size_t)((nrow * ncol + NR_END) * sizeof(float)));
-    if (!m[nrl])
-        nrerrorNR();
-    m[nrl] += NR_END;
-    m[nrl] -= ncl;
-
-    for (i = nrl + 1; i <= nrh; i++)
-        m[i] = m[i - 1] + ncol;
-
-    /* return pointer to array of pointers to rows */
-    return m;
-}
-
-float ***f3tensorSP(long nrl, long nrh, long ncl, long nch, long ndl, long ndh)
-/* allocate a float 3tensor with range t[nrl..nrh][ncl..nch][ndl..ndh] */
-{
-    long i, j, nrow = nrh - nrl + 1, ncol = nch - ncl + 1, ndep = ndh - ndl + 1;
-    float ***t;
-
-    /* allocate pointers to pointers to rows */
-    t = (float ***)malloc((size_t)((nrow + NR_END) * sizeof(float **)));
-    if (!t)
-        nrerrorNR();
-    t += NR_END;
-    t -= nrl;
-
-    /* allocate pointers to rows and set pointers to them */
-    t[nrl] = (float **)malloc((size_t)((nrow * ncol + NR_END) * sizeof(float *)));
-    if (!t[nrl])
-        nrerrorNR();
-    t[nrl] += NR_END;
-    t[nrl] -= ncl;
-
-    /* allocate rows and set pointers to them */
-    t[nrl][ncl] = (float *)malloc((size_t)((nrow * ncol * ndep + NR_END) * sizeof(float)));
-    if (!t[nrl][ncl])
-        nrerrorNR();
-    t[nrl][ncl] += NR_END;
-    t[nrl][ncl] -= ndl;
-
-    for (j = ncl + 1; j <= nch; j++)
-        t[nrl][j] = t[nrl][j - 1] + ndep;
-    for (i = nrl + 1; i <= nrh; i++)
-    {
-        t[i]      = t[i - 1] + ncol;
-        t[i][ncl] = t[i - 1][ncl] + ncol * ndep;
-        for (j = ncl + 1; j <= nch; j++)
-            t[i][j] = t[i][j - 1] + ndep;
     }
 
-    /* return pointer to array of pointers to rows */
-    return t;
-}
-
-void free_matrixSP(float **m, long nrl, long nrh, long ncl, long nch)
-/* free a float matrix allocated by matrix() */
-{
-    Q_UNUSED(nrh);
-    Q_UNUSED(nch);
-    free((FREE_ARG)(m[nrl] + ncl - NR_END));
-    free((FREE_ARG)(m + nrl - NR_END));
+    *xshift = static_cast<float>(sx);
+    *yshift = static_cast<float>(sy);
 }
-
-void free_f3tensorSP(float ***t, long nrl, long nrh, long ncl, long nch, long ndl, long ndh)
-/* free a float f3tensor allocated by f3tensor() */
-{
-    Q_UNUSED(nrh);
-    Q_UNUSED(nch);
-    Q_UNUSED(ndh);
-    free((FREE_ARG)(t[nrl][ncl] + ndl - NR_END));
-    free((FREE_ARG)(t[nrl] + ncl - NR_END));
-    free((FREE_ARG)(t + nrl - NR_END));
 }
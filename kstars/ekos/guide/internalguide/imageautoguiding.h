@@ -9,20 +9,85 @@
 
 #pragma once
 
-// Robert Majewski
+#include <QVector>
 
-// ImageAutoGuiding1 is self contained
-// ref is the reference image
-// im is the test image
-// Image Size n x n
+// Robert Majewski
 
 // The Input Image and the Reference images are zero based one dimensional vectors
 // They MUST be Square Images
-// n MUST be a Power of 2  use 128,256,512
-// 256 X 256 is A good Choice
+// n MUST be a Power of 2  use 64,128,256,512
 // These should be portions of the camera imagery
 
 namespace ImageAutoGuiding
 {
-void ImageAutoGuiding1(float *ref, float *im, int n, float *xshift, float *yshift);
+/**
+ * @class FFT2D
+ * @short Planned two dimensional FFT of square complex images, whose side is a power of 2.
+ *
+ * The plan holds the bit reversal permutation and the twiddle factors, computed once for the image size. Rows are
+ * transformed one at a time. Columns are transformed all at once, each butterfly combining two whole rows, so that
+ * the inner loops run over contiguous memory and vectorize.
+ *
+ * Complex values are stored interleaved, real part first. Transforms are in place and not normalized.
+ */
+class FFT2D
+{
+    public:
+        explicit FFT2D(int n);
+
+        int size() const
+        {
+            return m_N;
+        }
+
+        /** @brief forward Transform with e^(-2 pi i k x / n) */
+        void forward(float *data) const;
+        /** @brief inverse Transform with e^(+2 pi i k x / n), scaled by n * n */
+        void inverse(float *data) const;
+
+    private:
+        void transformRows(float *data, bool inverse) const;
+        void transformColumns(float *data, bool inverse) const;
+
+        int m_N { 0 };
+        QVector<int> m_BitReverse;
+        /** e^(-2 pi i k / n) for k < n / 2, interleaved */
+        QVector<float> m_Twiddles;
+};
+
+/**
+ * @class ShiftEstimator
+ * @short Estimates the shift of square images from a reference image, by cross-correlation.
+ *
+ * The spectrum of the reference is computed once when the reference is set, and reused for every image. The shift is
+ * found at the peak of the cross-correlation, interpolated to a fraction of pixel with a parabola on each axis. It is
+ * then refined by fitting the slope of the phase of the cross-power spectrum at low spatial frequencies.
+ *
+ * Shifts are in pixels, positive when the image content moved toward increasing columns (x) and rows (y).
+ */
+class ShiftEstimator
+{
+    public:
+        explicit ShiftEstimator(int n = 64);
+
+        /** @brief setReference Compute and keep the spectrum of the reference image, of n * n pixels. */
+        void setReference(const float *reference);
+        bool hasReference() const
+        {
+            return m_Reference.isEmpty() == false;
+        }
+
+        /** @brief estimate Find the shift of an image of n * n pixels from the reference. */
+        void estimate(const float *image, float *xshift, float *yshift);
+
+    private:
+        /** @brief Load an image, without its mean, in the buffer and transform it. */
+        void loadSpectrum(const float *image, QVector<float> &spectrum) const;
+
+        FFT2D m_FFT;
+        QVector<float> m_Reference;
+        /** Work buffers, kept to avoid allocations on every frame */
+        QVector<float> m_Spectrum;
+        QVector<float> m_Correlation;
+};
 }
@@ -26,6 +26,8 @@
 #include <QTimer>
 
 #define MAX_GUIDE_STARS           10
+// Number of guide pulses whose latency is summarized in the log
+#define LATENCY_REPORT_PULSES     100
 
 namespace Ekos
 {
@@ -57,6 +59,7 @@ bool InternalGuider::guide()
 
     m_starLostCounter = 0;
     m_highRMSCounter= 0;
+    resetLatency();
 
     // TODO re-enable rapid check later on
 #if 0
@@ -1034,6 +1037,7 @@ bool InternalGuider::processGuiding()
     {
         emit newPulse(out->pulse_dir[GUIDE_RA] , out->pulse_length[GUIDE_RA],
                       out->pulse_dir[GUIDE_DEC], out->pulse_length[GUIDE_DEC]);
+        measureLatency();
 
         // Wait until pulse is over before capturing an image
         const int waitMS = qMax(out->pulse_length[GUIDE_RA], out->pulse_length[GUIDE_DEC]);
@@ -1081,6 +1085,32 @@ bool InternalGuider::processGuiding()
     return true;
 }
 
+void InternalGuider::measureLatency()
+{
+    FITSData *imageData = guideFrame.isNull() ? nullptr : guideFrame->getImageData();
+    if (imageData == nullptr)
+        return;
+
+    qint64 const latency = imageData->getAge();
+    qCDebug(KSTARS_EKOS_GUIDE) << "Guide pulse latency" << latency << "ms";
+
+    m_Latency.sum += latency;
+    m_Latency.max = qMax(m_Latency.max, latency);
+
+    if (++m_Latency.count >= LATENCY_REPORT_PULSES)
+    {
+        emit newLog(i18n("Guide pulse latency over the last %1 frames: %2 ms on average, %3 ms at most.",
+                         m_Latency.count, m_Latency.sum / m_Latency.count, m_Latency.max));
+        resetLatency();
+    }
+}
+
+void InternalGuider::resetLatency()
+{
+    m_Latency.sum = m_Latency.max = 0;
+    m_Latency.count = 0;
+}
+
 bool InternalGuider::processImageGuiding()
 {
     static int maxPulseCounter = 0;
@@ -1119,6 +1149,7 @@ bool InternalGuider::processImageGuiding()
 
     emit newPulse(out->pulse_dir[GUIDE_RA], out->pulse_length[GUIDE_RA], out->pulse_dir[GUIDE_DEC],
                   out->pulse_length[GUIDE_DEC]);
+    measureLatency();
 
     emit frameCaptureRequested();
 
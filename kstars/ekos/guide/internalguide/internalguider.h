@@ -145,6 +145,10 @@ class InternalGuider : public GuideInterface
     // Image Guiding
     bool processImageGuiding();
 
+    // Latency from the end of the exposure of the guide frame to its pulse
+    void measureLatency();
+    void resetLatency();
+
     void reset();
 
     std::unique_ptr<cgmath> pmath;
@@ -194,6 +198,13 @@ class InternalGuider : public GuideInterface
     QTime reacquireTimer;
     int m_highRMSCounter {0};
 
+    struct
+    {
+        qint64 sum { 0 };
+        qint64 max { 0 };
+        int count { 0 };
+    } m_Latency;
+
     Ekos::Matrix ROT_Z;
     CalibrationStage calibrationStage { CAL_IDLE };
     CalibrationType calibrationType;
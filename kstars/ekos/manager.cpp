@@ -2894,13 +2894,21 @@ void Manager::updateCaptureProgress(Ekos::SequenceJob * job)
     {
         QString uuid = QUuid::createUuid().toString();
         uuid = uuid.remove(QRegularExpression("[-{}]"));
-        //        FITSView *image = job->getActiveChip()->getImageView(FITS_NORMAL);
-        //        ekosLiveClient.get()->media()->sendPreviewImage(image, uuid);
-        //        ekosLiveClient.get()->cloud()->sendPreviewImage(image, uuid);
         QString filename = job->property("filename").toString();
-        ekosLiveClient.get()->media()->sendPreviewImage(filename, uuid);
-        if (job->isPreview() == false)
-            ekosLiveClient.get()->cloud()->sendPreviewImage(filename, uuid);
+        // Use the image already in memory if it is displayed, previews are not written to disk
+        FITSView *image = job->getActiveChip()->getImageView(FITS_NORMAL);
+        if (image && image->getImageData() && image->getImageData()->filename() == filename)
+        {
+            ekosLiveClient.get()->media()->sendPreviewImage(image, uuid);
+            if (job->isPreview() == false)
+                ekosLiveClient.get()->cloud()->sendPreviewImage(image, job->getActiveChip()->getCCD()->getFileWriteFuture(), uuid);
+        }
+        else
+        {
+            ekosLiveClient.get()->media()->sendPreviewImage(filename, uuid);
+            if (job->isPreview() == false)
+                ekosLiveClient.get()->cloud()->sendPreviewImage(filename, uuid);
+        }
 
     }
 }
@@ -25,8 +25,10 @@
 #include "auxiliary/QProgressIndicator.h"
 #include "dialogs/finddialog.h"
 #include "ekos/manager.h"
+#include "ekos/auxiliary/capturefileindex.h"
 #include "ekos/capture/sequencejob.h"
 #include "skyobjects/starobject.h"
+#include "schedulerephemeris.h"
 
 #include <KNotifications/KNotification>
 #include <KConfigDialog>
@@ -34,6 +36,9 @@
 #include <fitsio.h>
 #include <ekos_scheduler_debug.h>
 
+#include <QThread>
+#include <QtConcurrent>
+
 #define BAD_SCORE                -1000
 #define MAX_FAILURE_ATTEMPTS      5
 #define UPDATE_PERIOD_MS          1000
@@ -43,6 +48,16 @@
 #define DEFAULT_MIN_ALTITUDE        15
 #define DEFAULT_MIN_MOON_SEPARATION 0
 
+namespace
+{
+/** @internal Detached copy of a scheduler job being evaluated, with the queue job it originates from. */
+struct JobPlan
+{
+    SchedulerJob job;
+    SchedulerJob *origin;
+};
+}
+
 namespace Ekos
 {
 Scheduler::Scheduler()
@@ -378,6 +393,13 @@ void Scheduler::watchJobChanges(bool enable)
 
 void Scheduler::appendLogText(const QString &text)
 {
+    /* Job evaluation workers may log too, forward their messages to the main thread */
+    if (QThread::currentThread() != thread())
+    {
+        QMetaObject::invokeMethod(this, "appendLogText", Qt::QueuedConnection, Q_ARG(QString, text));
+        return;
+    }
+
     /* FIXME: user settings for log length */
     int const max_log_count = 2000;
     if (m_LogText.size() > max_log_count)
@@ -1537,99 +1559,42 @@ void Scheduler::evaluateJobs()
     /* Update dawn and dusk astronomical times - unconditionally in case date changed */
     calculateDawnDusk();
 
-    /* First, filter out non-schedulable jobs */
-    /* FIXME: jobs in state JOB_ERROR should not be in the list, reorder states */
-    QList<SchedulerJob *> sortedJobs = jobs;
-
-    /* Then enumerate SchedulerJobs to consolidate imaging time */
-    foreach (SchedulerJob *job, sortedJobs)
-    {
-        /* Let aborted jobs be rescheduled later instead of forgetting them */
-        switch (job->getState())
-        {
-            case SchedulerJob::JOB_SCHEDULED:
-                /* If job is scheduled, keep it for evaluation against others */
-                break;
-
-            case SchedulerJob::JOB_INVALID:
-            case SchedulerJob::JOB_COMPLETE:
-                /* If job is invalid or complete, bypass evaluation */
-                continue;
-
-            case SchedulerJob::JOB_BUSY:
-                /* If job is busy, edge case, bypass evaluation */
-                continue;
-
-            case SchedulerJob::JOB_ERROR:
-            case SchedulerJob::JOB_ABORTED:
-                /* If job is in error or aborted and we're running, keep its evaluation until there is nothing else to do */
-                if (state == SCHEDULER_RUNNING)
-                    continue;
-            /* Fall through */
-            case SchedulerJob::JOB_IDLE:
-            case SchedulerJob::JOB_EVALUATION:
-            default:
-                /* If job is idle, re-evaluate completely */
-                job->setEstimatedTime(-1);
-                break;
-        }
+    /* Fill the ephemeris cache from the main thread, evaluation workers only read from it */
+    Ekos::SchedulerEphemeris::Instance()->prepare(geo->LTtoUT(KStarsDateTime(now)), 48);
 
-        switch (job->getCompletionCondition())
-        {
-            case SchedulerJob::FINISH_AT:
-                /* If planned finishing time has passed, the job is set to IDLE waiting for a next chance to run */
-                if (job->getCompletionTime().isValid() && job->getCompletionTime() < now)
-                {
-                    job->setState(SchedulerJob::JOB_IDLE);
-                    continue;
-                }
-                break;
-
-            case SchedulerJob::FINISH_REPEAT:
-                // In case of a repeating jobs, let's make sure we have more runs left to go
-                // If we don't, re-estimate imaging time for the scheduler job before concluding
-                if (job->getRepeatsRemaining() == 0)
-                {
-                    appendLogText(i18n("Job '%1' has no more batches remaining.", job->getName()));
-                    if (Options::rememberJobProgress())
-                    {
-                        job->setEstimatedTime(-1);
-                    }
-                    else
-                    {
-                        job->setState(SchedulerJob::JOB_COMPLETE);
-                        job->setEstimatedTime(0);
-                        continue;
-                    }
-                }
-                break;
+    /* The evaluation works on detached copies of the jobs, so that cells are not refreshed at each step.
+     * The first pass is independent for each job, and runs in parallel: estimation from the sequence file.
+     * The schedule is then consolidated sequentially in a worker, and applied to the jobs of the queue once
+     * at the end of the evaluation.
+     */
+    QList<JobPlan> plans;
+    plans.reserve(jobs.size());
+    for (SchedulerJob const * const job : jobs)
+        plans.append({ job->detached(), const_cast<SchedulerJob *>(job) });
 
-            default:
-                break;
-        }
+    QtConcurrent::blockingMap(plans, [this, now](JobPlan & plan)
+    {
+        prepareJobEvaluation(&plan.job, now);
+    });
 
-        // -1 = Job is not estimated yet
-        // -2 = Job is estimated but time is unknown
-        // > 0  Job is estimated and time is known
-        if (job->getEstimatedTime() == -1)
-        {
-            if (estimateJobTime(job) == false)
-            {
-                job->setState(SchedulerJob::JOB_INVALID);
-                continue;
-            }
-        }
+    /* Evaluate the plan list in the same order as the queue */
+    QList<SchedulerJob *> sortedJobs;
+    QHash<SchedulerJob const *, JobPlan const *> planOf;
+    for (JobPlan &plan : plans)
+    {
+        sortedJobs.append(&plan.job);
+        planOf.insert(&plan.job, &plan);
+    }
 
-        if (job->getEstimatedTime() == 0)
-        {
-            job->setRepeatsRemaining(0);
-            job->setState(SchedulerJob::JOB_COMPLETE);
-            continue;
-        }
+    /* Apply the consolidated schedule to the queue, and switch the sorted list to actual jobs */
+    auto applyPlans = [&]()
+    {
+        for (JobPlan const &plan : plans)
+            plan.origin->applySchedule(plan.job);
 
-        // In any other case, evaluate
-        job->setState(SchedulerJob::JOB_EVALUATION);
-    }
+        for (int index = 0; index < sortedJobs.size(); index++)
+            sortedJobs[index] = planOf[sortedJobs.at(index)]->origin;
+    };
 
     /*
      * At this step, we prepare scheduling of jobs.
@@ -1665,6 +1630,7 @@ void Scheduler::evaluateJobs()
     /* If there are no jobs left to run in the filtered list, stop evaluation */
     if (sortedJobs.isEmpty() || (!errorHandlingRescheduleErrorsCB->isChecked() && nea) || (errorHandlingRescheduleErrorsCB->isChecked() && neae))
     {
+        applyPlans();
         appendLogText(i18n("No jobs left in the scheduler queue."));
         setCurrentJob(nullptr);
         jobEvaluationOnly = false;
@@ -1704,6 +1670,88 @@ void Scheduler::evaluateJobs()
         }
     }
 
+    /* The consolidation is sequential, as each job is scheduled after the previous ones */
+    consolidateSchedule(sortedJobs, now, minAltitude->decimals(), minMoonSeparation->decimals());
+
+    /* Apply the schedule, then apply sorting to queue table, and mark it for saving if it changes */
+    applyPlans();
+    mDirty = reorderJobs(sortedJobs) | mDirty;
+
+    if (jobEvaluationOnly || state != SCHEDULER_RUNNING)
+    {
+        qCInfo(KSTARS_EKOS_SCHEDULER) << "Ekos finished evaluating jobs, no job selection required.";
+        jobEvaluationOnly = false;
+        return;
+    }
+
+    /*
+     * At this step, we finished evaluating jobs.
+     * We select the first job that has to be run, per schedule.
+     */
+
+    /* This predicate matches jobs that are neither scheduled to run nor aborted */
+    auto neither_scheduled_nor_aborted = [](SchedulerJob const * const job)
+    {
+        SchedulerJob::JOBStatus const s = job->getState();
+        return SchedulerJob::JOB_SCHEDULED != s && SchedulerJob::JOB_ABORTED != s;
+    };
+
+    /* If there are no jobs left to run in the filtered list, stop evaluation */
+    if (sortedJobs.isEmpty() || std::all_of(sortedJobs.begin(), sortedJobs.end(), neither_scheduled_nor_aborted))
+    {
+        appendLogText(i18n("No jobs left in the scheduler queue after evaluating."));
+        setCurrentJob(nullptr);
+        jobEvaluationOnly = false;
+        return;
+    }
+    /* If there are only aborted jobs that can run, reschedule those and let Scheduler restart one loop */
+    else if (std::all_of(sortedJobs.begin(), sortedJobs.end(), finished_or_aborted) &&
+             errorHandlingDontRestartButton->isChecked() == false)
+    {
+        appendLogText(i18n("Only aborted jobs left in the scheduler queue after evaluating, rescheduling those."));
+        std::for_each(sortedJobs.begin(), sortedJobs.end(), [](SchedulerJob * job)
+        {
+            if (SchedulerJob::JOB_ABORTED == job->getState())
+                job->setState(SchedulerJob::JOB_EVALUATION);
+        });
+
+        jobEvaluationOnly = false;
+        return;
+    }
+
+    /* The job to run is the first scheduled, locate it in the list */
+    QList<SchedulerJob*>::iterator job_to_execute_iterator = std::find_if(sortedJobs.begin(), sortedJobs.end(), [](SchedulerJob * const job)
+    {
+        return SchedulerJob::JOB_SCHEDULED == job->getState();
+    });
+
+    /* If there is no scheduled job anymore (because the restriction loop made them invalid, for instance), bail out */
+    if (sortedJobs.end() == job_to_execute_iterator)
+    {
+        appendLogText(i18n("No jobs left in the scheduler queue after schedule cleanup."));
+        setCurrentJob(nullptr);
+        jobEvaluationOnly = false;
+        return;
+    }
+
+    /* Check if job can be processed right now */
+    SchedulerJob * const job_to_execute = *job_to_execute_iterator;
+    if (job_to_execute->getFileStartupCondition() == SchedulerJob::START_ASAP)
+        if( 0 <= calculateJobScore(job_to_execute, now))
+            job_to_execute->setStartupTime(now);
+
+    qCDebug(KSTARS_EKOS_SCHEDULER) << QString("Job '%1' is selected for next observation with priority #%2 and score %3.")
+                                   .arg(job_to_execute->getName())
+                                   .arg(job_to_execute->getPriority())
+                                   .arg(job_to_execute->getScore());
+
+    // Set the current job, and let the status timer execute it when ready
+    setCurrentJob(job_to_execute);
+}
+
+void Scheduler::consolidateSchedule(QList<SchedulerJob *> &sortedJobs, QDateTime const &now, int altitudeDecimals,
+                                    int moonSeparationDecimals)
+{
     /* If option says so, reorder by altitude and priority before sequencing */
     /* FIXME: refactor so all sorts are using the same predicates */
     /* FIXME: use std::stable_sort as qStableSort is deprecated */
@@ -1713,7 +1761,7 @@ void Scheduler::evaluateJobs()
     {
         using namespace std::placeholders;
         std::stable_sort(sortedJobs.begin(), sortedJobs.end(),
-                         std::bind(SchedulerJob::decreasingAltitudeOrder, _1, _2, KStarsData::Instance()->lt()));
+                         std::bind(SchedulerJob::decreasingAltitudeOrder, _1, _2, now));
         std::stable_sort(sortedJobs.begin(), sortedJobs.end(), SchedulerJob::increasingPriorityOrder);
     }
 
@@ -2062,9 +2110,9 @@ void Scheduler::evaluateJobs()
 
                     appendLogText(i18n("Warning: job '%1' requires minimum altitude %2 and Moon separation %3, not achievable, marking invalid.",
                                        currentJob->getName(),
-                                       QString("%L1").arg(static_cast<double>(currentJob->getMinAltitude()), 0, 'f', minAltitude->decimals()),
+                                       QString("%L1").arg(static_cast<double>(currentJob->getMinAltitude()), 0, 'f', altitudeDecimals),
                                        0.0 < currentJob->getMinMoonSeparation() ?
-                                       QString("%L1").arg(static_cast<double>(currentJob->getMinMoonSeparation()), 0, 'f', minMoonSeparation->decimals()) :
+                                       QString("%L1").arg(static_cast<double>(currentJob->getMinMoonSeparation()), 0, 'f', moonSeparationDecimals) :
                                        QString("-")));
 
                     break;
@@ -2161,80 +2209,96 @@ void Scheduler::evaluateJobs()
 
         }
     }
+}
 
-    /* Apply sorting to queue table, and mark it for saving if it changes */
-    mDirty = reorderJobs(sortedJobs) | mDirty;
-
-    if (jobEvaluationOnly || state != SCHEDULER_RUNNING)
+bool Scheduler::prepareJobEvaluation(SchedulerJob *job, QDateTime const &now)
+{
+    /* Let aborted jobs be rescheduled later instead of forgetting them */
+    switch (job->getState())
     {
-        qCInfo(KSTARS_EKOS_SCHEDULER) << "Ekos finished evaluating jobs, no job selection required.";
-        jobEvaluationOnly = false;
-        return;
-    }
+        case SchedulerJob::JOB_SCHEDULED:
+            /* If job is scheduled, keep it for evaluation against others */
+            break;
 
-    /*
-     * At this step, we finished evaluating jobs.
-     * We select the first job that has to be run, per schedule.
-     */
+        case SchedulerJob::JOB_INVALID:
+        case SchedulerJob::JOB_COMPLETE:
+            /* If job is invalid or complete, bypass evaluation */
+            return false;
 
-    /* This predicate matches jobs that are neither scheduled to run nor aborted */
-    auto neither_scheduled_nor_aborted = [](SchedulerJob const * const job)
-    {
-        SchedulerJob::JOBStatus const s = job->getState();
-        return SchedulerJob::JOB_SCHEDULED != s && SchedulerJob::JOB_ABORTED != s;
-    };
+        case SchedulerJob::JOB_BUSY:
+            /* If job is busy, edge case, bypass evaluation */
+            return false;
 
-    /* If there are no jobs left to run in the filtered list, stop evaluation */
-    if (sortedJobs.isEmpty() || std::all_of(sortedJobs.begin(), sortedJobs.end(), neither_scheduled_nor_aborted))
-    {
-        appendLogText(i18n("No jobs left in the scheduler queue after evaluating."));
-        setCurrentJob(nullptr);
-        jobEvaluationOnly = false;
-        return;
+        case SchedulerJob::JOB_ERROR:
+        case SchedulerJob::JOB_ABORTED:
+            /* If job is in error or aborted and we're running, keep its evaluation until there is nothing else to do */
+            if (state == SCHEDULER_RUNNING)
+                return false;
+        /* Fall through */
+        case SchedulerJob::JOB_IDLE:
+        case SchedulerJob::JOB_EVALUATION:
+        default:
+            /* If job is idle, re-evaluate completely */
+            job->setEstimatedTime(-1);
+            break;
     }
-    /* If there are only aborted jobs that can run, reschedule those and let Scheduler restart one loop */
-    else if (std::all_of(sortedJobs.begin(), sortedJobs.end(), finished_or_aborted) &&
-             errorHandlingDontRestartButton->isChecked() == false)
+
+    switch (job->getCompletionCondition())
     {
-        appendLogText(i18n("Only aborted jobs left in the scheduler queue after evaluating, rescheduling those."));
-        std::for_each(sortedJobs.begin(), sortedJobs.end(), [](SchedulerJob * job)
-        {
-            if (SchedulerJob::JOB_ABORTED == job->getState())
-                job->setState(SchedulerJob::JOB_EVALUATION);
-        });
+        case SchedulerJob::FINISH_AT:
+            /* If planned finishing time has passed, the job is set to IDLE waiting for a next chance to run */
+            if (job->getCompletionTime().isValid() && job->getCompletionTime() < now)
+            {
+                job->setState(SchedulerJob::JOB_IDLE);
+                return false;
+            }
+            break;
 
-        jobEvaluationOnly = false;
-        return;
+        case SchedulerJob::FINISH_REPEAT:
+            // In case of a repeating jobs, let's make sure we have more runs left to go
+            // If we don't, re-estimate imaging time for the scheduler job before concluding
+            if (job->getRepeatsRemaining() == 0)
+            {
+                appendLogText(i18n("Job '%1' has no more batches remaining.", job->getName()));
+                if (Options::rememberJobProgress())
+                {
+                    job->setEstimatedTime(-1);
+                }
+                else
+                {
+                    job->setState(SchedulerJob::JOB_COMPLETE);
+                    job->setEstimatedTime(0);
+                    return false;
+                }
+            }
+            break;
+
+        default:
+            break;
     }
 
-    /* The job to run is the first scheduled, locate it in the list */
-    QList<SchedulerJob*>::iterator job_to_execute_iterator = std::find_if(sortedJobs.begin(), sortedJobs.end(), [](SchedulerJob * const job)
+    // -1 = Job is not estimated yet
+    // -2 = Job is estimated but time is unknown
+    // > 0  Job is estimated and time is known
+    if (job->getEstimatedTime() == -1)
     {
-        return SchedulerJob::JOB_SCHEDULED == job->getState();
-    });
+        if (estimateJobTime(job) == false)
+        {
+            job->setState(SchedulerJob::JOB_INVALID);
+            return false;
+        }
+    }
 
-    /* If there is no scheduled job anymore (because the restriction loop made them invalid, for instance), bail out */
-    if (sortedJobs.end() == job_to_execute_iterator)
+    if (job->getEstimatedTime() == 0)
     {
-        appendLogText(i18n("No jobs left in the scheduler queue after schedule cleanup."));
-        setCurrentJob(nullptr);
-        jobEvaluationOnly = false;
-        return;
+        job->setRepeatsRemaining(0);
+        job->setState(SchedulerJob::JOB_COMPLETE);
+        return false;
     }
 
-    /* Check if job can be processed right now */
-    SchedulerJob * const job_to_execute = *job_to_execute_iterator;
-    if (job_to_execute->getFileStartupCondition() == SchedulerJob::START_ASAP)
-        if( 0 <= calculateJobScore(job_to_execute, now))
-            job_to_execute->setStartupTime(now);
-
-    qCDebug(KSTARS_EKOS_SCHEDULER) << QString("Job '%1' is selected for next observation with priority #%2 and score %3.")
-                                   .arg(job_to_execute->getName())
-                                   .arg(job_to_execute->getPriority())
-                                   .arg(job_to_execute->getScore());
-
-    // Set the current job, and let the status timer execute it when ready
-    setCurrentJob(job_to_execute);
+    // In any other case, evaluate
+    job->setState(SchedulerJob::JOB_EVALUATION);
+    return true;
 }
 
 void Scheduler::wakeUpScheduler()
@@ -2402,7 +2466,7 @@ void Scheduler::calculateDawnDusk()
     QTime const dawn = QTime(0, 0, 0).addSecs(Dawn * 24 * 3600);
     QTime const dusk = QTime(0, 0, 0).addSecs(Dusk * 24 * 3600);
 
-    duskDateTime.setDate(KStars::Instance()->data()->lt().date());
+    duskDateTime.setDate(KStarsData::Instance()->lt().date());
     duskDateTime.setTime(dusk);
 
     nightTime->setText(i18n("%1 - %2", dusk.toString("hh:mm"), dawn.toString("hh:mm")));
@@ -4802,7 +4866,9 @@ void Scheduler::updateCompletedJobsCount(bool forced)
 
 bool Scheduler::estimateJobTime(SchedulerJob *schedJob)
 {
-    static SchedulerJob *jobWarned = nullptr;
+    /* Jobs are estimated in parallel during evaluation, and on detached copies, so remember warned jobs by name */
+    static QMutex jobWarnedLock;
+    static QString jobWarned;
 
     /* updateCompletedJobsCount(); */
 
@@ -4819,10 +4885,14 @@ bool Scheduler::estimateJobTime(SchedulerJob *schedJob)
     schedJob->setInSequenceFocus(hasAutoFocus);
 
     // Stop spam of log on re-evaluation. If we display the warning once, then that's it.
-    if (schedJob != jobWarned && hasAutoFocus && !(schedJob->getStepPipeline() & SchedulerJob::USE_FOCUS))
+    if (hasAutoFocus && !(schedJob->getStepPipeline() & SchedulerJob::USE_FOCUS))
     {
-        appendLogText(i18n("Warning: Job '%1' has its focus step disabled, periodic and/or HFR procedures currently set in its sequence will not occur.", schedJob->getName()));
-        jobWarned = schedJob;
+        QMutexLocker locker(&jobWarnedLock);
+        if (schedJob->getName() != jobWarned)
+        {
+            appendLogText(i18n("Warning: Job '%1' has its focus step disabled, periodic and/or HFR procedures currently set in its sequence will not occur.", schedJob->getName()));
+            jobWarned = schedJob->getName();
+        }
     }
 
     /* This is the map of captured frames for this scheduler job, keyed per storage signature.
@@ -4891,7 +4961,7 @@ bool Scheduler::estimateJobTime(SchedulerJob *schedJob)
             // Retrieve cached count of completed captures for the output folder of this seqJob
             QString const signature = seqJob->getSignature();
             QString const signature_path = QFileInfo(signature).path();
-            captures_completed = capturedFramesCount[signature];
+            captures_completed = capturedFramesCount.value(signature);
 
             qCInfo(KSTARS_EKOS_SCHEDULER) << QString("%1 sees %2 captures in output folder '%3'.").arg(seqName).arg(captures_completed).arg(signature_path);
 
@@ -6249,7 +6319,11 @@ bool Scheduler::loadSequenceQueue(const QString &fileURL, SchedulerJob *schedJob
     if (!sFile.open(QIODevice::ReadOnly))
     {
         QString message = i18n("Unable to open sequence queue file '%1'", fileURL);
-        KSNotification::sorry(message, i18n("Could Not Open File"));
+        // Sequences are loaded by job evaluation workers too, which cannot pop dialogs
+        if (QThread::currentThread() == thread())
+            KSNotification::sorry(message, i18n("Could Not Open File"));
+        else
+            appendLogText(message);
         return false;
     }
 
@@ -6437,25 +6511,14 @@ SequenceJob *Scheduler::processJobInfo(XMLEle *root, SchedulerJob *schedJob)
 
 int Scheduler::getCompletedFiles(const QString &path, const QString &seqPrefix)
 {
-    int seqFileCount = 0;
     QFileInfo const path_info(path);
     QString const sig_dir(path_info.dir().path());
     QString const sig_file(path_info.completeBaseName());
 
-    qCDebug(KSTARS_EKOS_SCHEDULER) << QString("Searching in path '%1', files '%2*' for prefix '%3'...").arg(sig_dir, sig_file, seqPrefix);
-    QDirIterator it(sig_dir, QDir::Files);
-
     /* FIXME: this counts all files with prefix in the storage location, not just captures. DSS analysis files are counted in, for instance. */
-    while (it.hasNext())
-    {
-        QString const fileName = QFileInfo(it.next()).completeBaseName();
+    int const seqFileCount = CaptureFileIndex::Instance()->count(sig_dir, seqPrefix);
 
-        if (fileName.startsWith(seqPrefix))
-        {
-            qCDebug(KSTARS_EKOS_SCHEDULER) << QString("> Found '%1'").arg(fileName);
-            seqFileCount++;
-        }
-    }
+    qCDebug(KSTARS_EKOS_SCHEDULER) << QString("Found %1 files '%2*' for prefix '%3' in path '%4'.").arg(seqFileCount).arg(sig_file, seqPrefix, sig_dir);
 
     return seqFileCount;
 }
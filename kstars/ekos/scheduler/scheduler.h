@@ -32,6 +32,10 @@ class SchedulerJob;
 class SkyObject;
 class KConfigDialog;
 
+#ifdef UNIT_TEST
+class TestSchedulerSimulation;
+#endif
+
 namespace Ekos
 {
 class SequenceJob;
@@ -49,6 +53,10 @@ class Scheduler : public QWidget, public Ui::Scheduler
         Q_PROPERTY(QStringList logText READ logText NOTIFY newLog)
         Q_PROPERTY(QString profile READ profile WRITE setProfile)
 
+#ifdef UNIT_TEST
+        friend class ::TestSchedulerSimulation; // Test class
+#endif
+
     public:
         typedef enum { EKOS_IDLE, EKOS_STARTING, EKOS_STOPPING, EKOS_READY } EkosState;
         typedef enum { INDI_IDLE, INDI_CONNECTING, INDI_DISCONNECTING, INDI_PROPERTY_CHECK, INDI_READY } INDIState;
@@ -118,7 +126,7 @@ class Scheduler : public QWidget, public Ui::Scheduler
         ~Scheduler() = default;
 
         QString getCurrentJobName();
-        void appendLogText(const QString &);
+        Q_INVOKABLE void appendLogText(const QString &);
         QStringList logText()
         {
             return m_LogText;
@@ -643,6 +651,26 @@ class Scheduler : public QWidget, public Ui::Scheduler
              */
         bool estimateJobTime(SchedulerJob *schedJob);
 
+        /**
+             * @brief prepareJobEvaluation Reset the evaluation state of a job, and estimate its duration if needed.
+             * @param job is the job to prepare, usually a detached copy of a job of the queue.
+             * @param now is the local date and time of the evaluation.
+             * @return true if the job is to be scheduled, false if it was left out of the evaluation.
+             * @note This is called concurrently for all jobs of the queue, and must not touch the user interface.
+             */
+        bool prepareJobEvaluation(SchedulerJob *job, QDateTime const &now);
+
+        /**
+             * @brief consolidateSchedule Sort the jobs if required, then stagger their startup times so that they comply with
+             * their constraints and don't overlap, marking each job scheduled, aborted or invalid.
+             * @param sortedJobs is the list of detached job copies being evaluated, sorted in place.
+             * @param now is the local date and time of the evaluation.
+             * @param altitudeDecimals and moonSeparationDecimals are the precisions of the values in log messages.
+             * @note This works on the detached job copies only, and does not touch the user interface.
+             */
+        void consolidateSchedule(QList<SchedulerJob *> &sortedJobs, QDateTime const &now, int altitudeDecimals,
+                                 int moonSeparationDecimals);
+
         /**
              * @brief createJobSequence Creates a job sequence for the mosaic tool given the prefix and output dir. The currently selected sequence file is modified
              * and a new version given the supplied parameters are saved to the output directory
@@ -0,0 +1,290 @@
+/*  Ekos Scheduler Ephemeris Cache
+    Copyright (C) 2026 agent <agent@local>
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+ */
+
+#include "schedulerephemeris.h"
+
+#include "ksmoon.h"
+#include "ksnumbers.h"
+#include "kstarsdata.h"
+#include "skymapcomposite.h"
+#include "skyobject.h"
+
+#include <KLocalizedString>
+
+#include <cmath>
+
+#include <ekos_scheduler_debug.h>
+
+namespace
+{
+/// Sidereal days per solar day
+constexpr double SIDEREAL_RATE = 1.00273790935;
+
+/// Number of cached samples after which the table is dropped, which is about a week of lookups
+constexpr int MAX_SAMPLES = 7 * 24 * 60 / Ekos::SchedulerEphemeris::SAMPLE_MINUTES;
+
+/// Number of cached target coordinates after which the table is dropped
+constexpr int MAX_TARGETS = 4096;
+
+/// Reduce an angle in radians to [0,2pi[
+double reduceRadians(double angle)
+{
+    angle = std::fmod(angle, 2 * M_PI);
+    return angle < 0 ? angle + 2 * M_PI : angle;
+}
+}
+
+namespace Ekos
+{
+SchedulerEphemeris *SchedulerEphemeris::_SchedulerEphemeris = nullptr;
+
+SchedulerEphemeris *SchedulerEphemeris::Instance()
+{
+    if (_SchedulerEphemeris == nullptr)
+        _SchedulerEphemeris = new SchedulerEphemeris();
+
+    return _SchedulerEphemeris;
+}
+
+SchedulerEphemeris::~SchedulerEphemeris()
+{
+}
+
+qint64 SchedulerEphemeris::sampleIndex(double jd)
+{
+    return static_cast<qint64>(std::floor(jd * 24 * 60 / SAMPLE_MINUTES));
+}
+
+qint64 SchedulerEphemeris::nightIndex(double jd)
+{
+    // Julian days start at noon UT, which is good enough a boundary for precession and nutation
+    return static_cast<qint64>(std::floor(jd));
+}
+
+void SchedulerEphemeris::checkLocation()
+{
+    GeoLocation const * const geo = KStarsData::Instance()->geo();
+
+    double const lat = geo->lat()->Degrees();
+    double const lng = geo->lng()->Degrees();
+
+    if (locationValid && lat == latitude && lng == longitude)
+        return;
+
+    if (locationValid)
+        qCDebug(KSTARS_EKOS_SCHEDULER) << "Geographic location changed, clearing scheduler ephemeris cache.";
+
+    // Target coordinates do not depend on location, only local sidereal time and topocentric Moon do
+    samples.clear();
+    latitude = lat;
+    longitude = lng;
+    locationValid = true;
+}
+
+const KSNumbers &SchedulerEphemeris::numbers(qint64 night)
+{
+    auto it = nights.constFind(night);
+    if (it == nights.constEnd())
+    {
+        // Keep the numbers of a few nights only, the scheduler rarely looks further than two days ahead
+        if (nights.size() > 8)
+            nights.clear();
+
+        it = nights.insert(night, std::make_shared<KSNumbers>(night + 0.5));
+    }
+
+    return *it.value();
+}
+
+SchedulerEphemeris::TargetCoords SchedulerEphemeris::targetCoords(const SkyPoint &target, qint64 night)
+{
+    TargetKey const key(night, qMakePair(target.ra0().Degrees(), target.dec0().Degrees()));
+
+    auto const it = targets.constFind(key);
+    if (it != targets.constEnd())
+        return it.value();
+
+    if (targets.size() > MAX_TARGETS)
+        targets.clear();
+
+    // Update RA/DEC of the target once for the night, precession and nutation do not change significantly over a day
+    SkyObject o;
+    o.setRA0(target.ra0());
+    o.setDec0(target.dec0());
+    o.updateCoordsNow(&numbers(night));
+
+    TargetCoords const coords { o.ra().radians(), o.dec().radians() };
+    targets.insert(key, coords);
+    return coords;
+}
+
+SchedulerEphemeris::Sample SchedulerEphemeris::sample(qint64 index)
+{
+    auto const it = samples.constFind(index);
+    if (it != samples.constEnd())
+        return it.value();
+
+    if (samples.size() > MAX_SAMPLES)
+        samples.clear();
+
+    GeoLocation * const geo = KStarsData::Instance()->geo();
+
+    Sample s;
+    s.jd = static_cast<double>(index) * SAMPLE_MINUTES / (24 * 60);
+    s.moonValid = false;
+    s.moonRA = s.moonDec = s.moonIllum = 0;
+
+    // Compute local sidereal time for the sample
+    KStarsDateTime const ut(static_cast<long double>(s.jd));
+    CachingDms const LST = geo->GSTtoLST(ut.gst());
+    s.lst = reduceRadians(LST.radians());
+
+    // Compute the topocentric Moon for the sample, using a private copy of the sky map Moon
+    if (moon == nullptr)
+    {
+        KSMoon const * const skyMoon = dynamic_cast<KSMoon *>(KStarsData::Instance()->skyComposite()->findByName(i18n("Moon")));
+        if (skyMoon != nullptr)
+            moon.reset(skyMoon->clone());
+    }
+
+    if (moon != nullptr)
+    {
+        KSNumbers const num(s.jd);
+        moon->updateCoords(&num, true, geo->lat(), &LST, true);
+
+        s.moonRA = moon->ra().radians();
+        s.moonDec = moon->dec().radians();
+        s.moonIllum = moon->illum();
+        s.moonValid = true;
+    }
+
+    samples.insert(index, s);
+    return s;
+}
+
+double SchedulerEphemeris::lst(double jd)
+{
+    // Sidereal time is linear with time, so extrapolate from the previous sample
+    Sample const s = sample(sampleIndex(jd));
+    return reduceRadians(s.lst + (jd - s.jd) * SIDEREAL_RATE * 2 * M_PI);
+}
+
+double SchedulerEphemeris::altitude(const SkyPoint &target, const KStarsDateTime &ut, bool *is_setting, double *hourAngle)
+{
+    QMutexLocker locker(&lock);
+
+    checkLocation();
+
+    double const jd = static_cast<double>(ut.djd());
+    TargetCoords const coords = targetCoords(target, nightIndex(jd));
+
+    // Hour angle is reduced to [0,2pi[, meridian being at 0
+    double const ha = reduceRadians(lst(jd) - coords.ra);
+
+    double const sinDec = std::sin(coords.dec), cosDec = std::cos(coords.dec);
+    double const sinLat = std::sin(latitude * M_PI / 180.0), cosLat = std::cos(latitude * M_PI / 180.0);
+
+    double const sinAlt = sinDec * sinLat + cosDec * cosLat * std::cos(ha);
+
+    if (is_setting)
+        *is_setting = ha < M_PI;
+
+    if (hourAngle)
+        *hourAngle = ha * 12.0 / M_PI;
+
+    return std::asin(sinAlt) * 180.0 / M_PI;
+}
+
+bool SchedulerEphemeris::moonState(const SkyPoint &target, const KStarsDateTime &ut, MoonState &state)
+{
+    QMutexLocker locker(&lock);
+
+    checkLocation();
+
+    double const jd = static_cast<double>(ut.djd());
+    qint64 const index = sampleIndex(jd);
+
+    Sample const a = sample(index);
+    Sample const b = sample(index + 1);
+
+    if (!a.moonValid || !b.moonValid)
+        return false;
+
+    // Interpolate the Moon position between the two samples, minding the RA wrap
+    double const t = (jd - a.jd) / (b.jd - a.jd);
+    double dRA = b.moonRA - a.moonRA;
+    if (M_PI < dRA)
+        dRA -= 2 * M_PI;
+    else if (dRA < -M_PI)
+        dRA += 2 * M_PI;
+
+    double const moonRA = a.moonRA + t * dRA;
+    double const moonDec = a.moonDec + t * (b.moonDec - a.moonDec);
+
+    double const sinMoonDec = std::sin(moonDec), cosMoonDec = std::cos(moonDec);
+    double const sinLat = std::sin(latitude * M_PI / 180.0), cosLat = std::cos(latitude * M_PI / 180.0);
+
+    double const moonHA = lst(jd) - moonRA;
+    double const sinMoonAlt = sinMoonDec * sinLat + cosMoonDec * cosLat * std::cos(moonHA);
+
+    TargetCoords const coords = targetCoords(target, nightIndex(jd));
+
+    double const sinDec = std::sin(coords.dec), cosDec = std::cos(coords.dec);
+
+    double const cosSeparation = sinDec * sinMoonDec + cosDec * cosMoonDec * std::cos(coords.ra - moonRA);
+
+    state.altitude = std::asin(sinMoonAlt) * 180.0 / M_PI;
+    state.illumination = a.moonIllum + t * (b.moonIllum - a.moonIllum);
+    state.separation = std::acos(qBound(-1.0, cosSeparation, 1.0)) * 180.0 / M_PI;
+
+    return true;
+}
+
+SkyPoint SchedulerEphemeris::apparentCoords(const SkyPoint &target, const KStarsDateTime &ut)
+{
+    QMutexLocker locker(&lock);
+
+    TargetCoords const coords = targetCoords(target, nightIndex(static_cast<double>(ut.djd())));
+
+    SkyPoint p;
+    p.setRA0(target.ra0());
+    p.setDec0(target.dec0());
+
+    dms ra, dec;
+    ra.setRadians(coords.ra);
+    dec.setRadians(coords.dec);
+    p.setRA(ra);
+    p.setDec(dec);
+
+    return p;
+}
+
+void SchedulerEphemeris::prepare(const KStarsDateTime &ut, int hours)
+{
+    QMutexLocker locker(&lock);
+
+    checkLocation();
+
+    double const jd = static_cast<double>(ut.djd());
+    qint64 const last = sampleIndex(jd + hours / 24.0) + 1;
+
+    for (qint64 index = sampleIndex(jd); index <= last; index++)
+        sample(index);
+}
+
+void SchedulerEphemeris::clear()
+{
+    QMutexLocker locker(&lock);
+
+    samples.clear();
+    nights.clear();
+    targets.clear();
+    locationValid = false;
+}
+}
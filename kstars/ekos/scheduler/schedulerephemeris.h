@@ -0,0 +1,163 @@
+/*  Ekos Scheduler Ephemeris Cache
+    Copyright (C) 2026 agent <agent@local>
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+ */
+
+#pragma once
+
+#include "skypoint.h"
+
+#include <QHash>
+#include <QMutex>
+#include <QPair>
+
+#include <memory>
+
+class KSMoon;
+class KSNumbers;
+class KStarsDateTime;
+
+namespace Ekos
+{
+/**
+ * @class SchedulerEphemeris
+ * @short Per-night ephemeris cache shared by all scheduler jobs.
+ *
+ * Scheduler jobs repeatedly ask for target altitude, meridian side and Moon separation while
+ * searching for a startup time. Instead of building a KSNumbers and running a full precession,
+ * nutation and aberration pass at every minute step, this cache keeps:
+ *
+ * - one KSNumbers instance per night, used to compute the apparent coordinates of each target once,
+ * - a coarse table of local sidereal time and topocentric Moon position, sampled every SAMPLE_MINUTES.
+ *
+ * Queries in between samples are interpolated, so an altitude lookup is reduced to a handful of
+ * multiplications. The cache is invalidated automatically when the geographic location changes.
+ *
+ * Lookups are thread-safe. Computing a missing Moon sample updates the shared Earth and Sun objects
+ * of the sky composite however, so the table should be filled from the main thread with prepare()
+ * before querying it concurrently.
+ *
+ * @version 1.0
+ */
+class SchedulerEphemeris
+{
+    public:
+        static SchedulerEphemeris *Instance();
+
+        /** @brief Resolution of the coarse ephemeris table, in minutes. */
+        static constexpr int SAMPLE_MINUTES = 10;
+
+        /** @brief Moon state relative to a target at a given time. */
+        typedef struct
+        {
+            /** Topocentric altitude of the Moon in degrees */
+            double altitude;
+            /** Illuminated fraction of the Moon, from 0 to 1 */
+            double illumination;
+            /** Angular separation between the Moon and the target, in degrees */
+            double separation;
+        } MoonState;
+
+        /**
+         * @brief altitude Get the altitude of a target at a given time.
+         * @param target J2000 catalog coordinates of the target.
+         * @param ut universal date and time of the query.
+         * @param is_setting set to true if the target passed the meridian (optional).
+         * @param hourAngle set to the hour angle of the target, in hours reduced to [0,24[ (optional).
+         * @return altitude of the target in degrees.
+         */
+        double altitude(const SkyPoint &target, const KStarsDateTime &ut, bool *is_setting = nullptr, double *hourAngle = nullptr);
+
+        /**
+         * @brief moonState Get the Moon altitude, illumination and separation from a target at a given time.
+         * @param target J2000 catalog coordinates of the target.
+         * @param ut universal date and time of the query.
+         * @param state receives the Moon state.
+         * @return false if the Moon is not available, in which case the argument state is left untouched.
+         */
+        bool moonState(const SkyPoint &target, const KStarsDateTime &ut, MoonState &state);
+
+        /**
+         * @brief apparentCoords Get the apparent coordinates of a target for the night of a given time.
+         * @param target J2000 catalog coordinates of the target.
+         * @param ut universal date and time of the query.
+         * @return a sky point with both catalog and apparent coordinates set.
+         */
+        SkyPoint apparentCoords(const SkyPoint &target, const KStarsDateTime &ut);
+
+        /**
+         * @brief prepare Fill the coarse table for an interval of time.
+         * @param ut universal date and time of the start of the interval.
+         * @param hours duration of the interval.
+         * @note Call this from the main thread before querying the cache from worker threads.
+         */
+        void prepare(const KStarsDateTime &ut, int hours = 24);
+
+        /** @brief clear Drop all cached samples and targets. */
+        void clear();
+
+    private:
+        SchedulerEphemeris() = default;
+        ~SchedulerEphemeris();
+
+        typedef struct
+        {
+            /** Julian day of the sample, in UT */
+            double jd;
+            /** Local sidereal time in radians */
+            double lst;
+            /** Topocentric Moon coordinates in radians */
+            double moonRA, moonDec;
+            /** Illuminated fraction of the Moon */
+            double moonIllum;
+            /** Whether the Moon was available when the sample was computed */
+            bool moonValid;
+        } Sample;
+
+        typedef struct
+        {
+            /** Apparent coordinates in radians */
+            double ra, dec;
+        } TargetCoords;
+
+        /** Night index and J2000 coordinates in degrees */
+        typedef QPair<qint64, QPair<double, double>> TargetKey;
+
+        /** @internal Checks the geolocation, and clears the cache if it changed. Must be called locked. */
+        void checkLocation();
+
+        /** @internal Get or compute the coarse sample at the argument index. Must be called locked. */
+        Sample sample(qint64 index);
+
+        /** @internal Get or compute the apparent coordinates of a target for a night. Must be called locked. */
+        TargetCoords targetCoords(const SkyPoint &target, qint64 night);
+
+        /** @internal Get or compute the numbers for a night. Must be called locked. */
+        const KSNumbers &numbers(qint64 night);
+
+        /** @internal Interpolate local sidereal time, in radians, at the argument Julian day. Must be called locked. */
+        double lst(double jd);
+
+        static qint64 sampleIndex(double jd);
+        static qint64 nightIndex(double jd);
+
+        static SchedulerEphemeris *_SchedulerEphemeris;
+
+        QMutex lock;
+
+        double latitude { 0 };
+        double longitude { 0 };
+        bool locationValid { false };
+
+        QHash<qint64, Sample> samples;
+        QHash<qint64, std::shared_ptr<KSNumbers>> nights;
+        QHash<TargetKey, TargetCoords> targets;
+
+        /// Private copy of the Moon, so that the sky map Moon is not moved around by scheduler queries
+        std::unique_ptr<KSMoon> moon;
+};
+}
@@ -11,14 +11,19 @@
 
 #include "dms.h"
 #include "kstarsdata.h"
+#include "ksutils.h"
 #include "skymapcomposite.h"
+#include "skyobject.h"
 #include "Options.h"
 #include "scheduler.h"
+#include "schedulerephemeris.h"
 
 #include <knotification.h>
 
 #include <QTableWidgetItem>
 
+#include <algorithm>
+
 #include <ekos_scheduler_debug.h>
 
 #define BAD_SCORE -1000
@@ -26,7 +31,6 @@
 
 SchedulerJob::SchedulerJob()
 {
-    moon = dynamic_cast<KSMoon *>(KStarsData::Instance()->skyComposite()->findByName(i18n("Moon")));
 }
 
 void SchedulerJob::setName(const QString &value)
@@ -681,6 +685,48 @@ void SchedulerJob::reset()
     updateJobCells();
 }
 
+SchedulerJob SchedulerJob::detached() const
+{
+    SchedulerJob job(*this);
+
+    job.nameCell = nullptr;
+    job.nameLabel = nullptr;
+    job.statusCell = nullptr;
+    job.stageCell = nullptr;
+    job.stageLabel = nullptr;
+    job.altitudeCell = nullptr;
+    job.startupCell = nullptr;
+    job.completionCell = nullptr;
+    job.estimatedTimeCell = nullptr;
+    job.captureCountCell = nullptr;
+    job.scoreCell = nullptr;
+    job.leadTimeCell = nullptr;
+
+    return job;
+}
+
+void SchedulerJob::applySchedule(SchedulerJob const &snapshot)
+{
+    SchedulerJob const cells(*this);
+
+    *this = snapshot;
+
+    nameCell = cells.nameCell;
+    nameLabel = cells.nameLabel;
+    statusCell = cells.statusCell;
+    stageCell = cells.stageCell;
+    stageLabel = cells.stageLabel;
+    altitudeCell = cells.altitudeCell;
+    startupCell = cells.startupCell;
+    completionCell = cells.completionCell;
+    estimatedTimeCell = cells.estimatedTimeCell;
+    captureCountCell = cells.captureCountCell;
+    scoreCell = cells.scoreCell;
+    leadTimeCell = cells.leadTimeCell;
+
+    updateJobCells();
+}
+
 bool SchedulerJob::decreasingScoreOrder(SchedulerJob const *job1, SchedulerJob const *job2)
 {
     return job1->getScore() > job2->getScore();
@@ -720,7 +766,6 @@ bool SchedulerJob::increasingStartupTimeOrder(SchedulerJob const *job1, Schedule
 
 int16_t SchedulerJob::getAltitudeScore(QDateTime const &when) const
 {
-    // FIXME: block calculating target coordinates at a particular time is duplicated in several places
     GeoLocation *geo = KStarsData::Instance()->geo();
 
     // Retrieve the argument date/time, or fall back to current time - don't use QDateTime's timezone!
@@ -728,20 +773,9 @@ int16_t SchedulerJob::getAltitudeScore(QDateTime const &when) const
                           Qt::UTC == when.timeSpec() ? geo->UTtoLT(KStarsDateTime(when)) : when :
                           KStarsData::Instance()->lt());
 
-    // Create a sky object with the target catalog coordinates
-    SkyPoint const target = getTargetCoords();
-    SkyObject o;
-    o.setRA0(target.ra0());
-    o.setDec0(target.dec0());
-
-    // Update RA/DEC of the target for the current fraction of the day
-    KSNumbers numbers(ltWhen.djd());
-    o.updateCoordsNow(&numbers);
-
-    // Compute local sidereal time for the current fraction of the day, calculate altitude
-    CachingDms const LST = geo->GSTtoLST(geo->LTtoUT(ltWhen).gst());
-    o.EquatorialToHorizontal(&LST, geo->lat());
-    double const altitude = o.alt().Degrees();
+    // Read target altitude and meridian side from the scheduler ephemeris cache
+    bool is_setting = false;
+    double const altitude = Ekos::SchedulerEphemeris::Instance()->altitude(getTargetCoords(), geo->LTtoUT(ltWhen), &is_setting);
 
     double const SETTING_ALTITUDE_CUTOFF = Options::settingAltitudeCutoff();
     int16_t score = BAD_SCORE - 1;
@@ -759,17 +793,8 @@ int16_t SchedulerJob::getAltitudeScore(QDateTime const &when) const
             score = BAD_SCORE;
         // Else if setting and under altitude cutoff, job would end soon after starting, bad score
         // FIXME: half bad score when under altitude cutoff risk getting positive again
-        else
-        {
-            double offset = LST.Hours() - o.ra().Hours();
-            if (24.0 <= offset)
-                offset -= 24.0;
-            else if (offset < 0.0)
-                offset += 24.0;
-            if (0.0 <= offset && offset < 12.0)
-                if (altitude - SETTING_ALTITUDE_CUTOFF < getMinAltitude())
-                    score = BAD_SCORE / 2;
-        }
+        else if (is_setting && altitude - SETTING_ALTITUDE_CUTOFF < getMinAltitude())
+            score = BAD_SCORE / 2;
     }
     // If not constrained but below minimum hard altitude, set score to 10% of altitude value
     else if (altitude < MIN_ALTITUDE)
@@ -792,7 +817,6 @@ int16_t SchedulerJob::getAltitudeScore(QDateTime const &when) const
 
 int16_t SchedulerJob::getMoonSeparationScore(QDateTime const &when) const
 {
-    // FIXME: block calculating target coordinates at a particular time is duplicated in several places
     GeoLocation *geo = KStarsData::Instance()->geo();
 
     // Retrieve the argument date/time, or fall back to current time - don't use QDateTime's timezone!
@@ -800,35 +824,26 @@ int16_t SchedulerJob::getMoonSeparationScore(QDateTime const &when) const
                           Qt::UTC == when.timeSpec() ? geo->UTtoLT(KStarsDateTime(when)) : when :
                           KStarsData::Instance()->lt());
 
-    // Create a sky object with the target catalog coordinates
-    SkyPoint const target = getTargetCoords();
-    SkyObject o;
-    o.setRA0(target.ra0());
-    o.setDec0(target.dec0());
-
-    // Update RA/DEC of the target for the current fraction of the day
-    KSNumbers numbers(ltWhen.djd());
-    o.updateCoordsNow(&numbers);
+    KStarsDateTime const ut = geo->LTtoUT(ltWhen);
+    Ekos::SchedulerEphemeris * const ephemeris = Ekos::SchedulerEphemeris::Instance();
 
-    // Update moon
-    //ut = geo->LTtoUT(ltWhen);
-    //KSNumbers ksnum(ut.djd()); // BUG: possibly LT.djd() != UT.djd() because of translation
-    //LST = geo->GSTtoLST(ut.gst());
-    CachingDms LST = geo->GSTtoLST(geo->LTtoUT(ltWhen).gst());
-    moon->updateCoords(&numbers, true, geo->lat(), &LST, true);
+    // Read Moon altitude, illumination and separation from the scheduler ephemeris cache
+    Ekos::SchedulerEphemeris::MoonState moonState;
+    if (!ephemeris->moonState(getTargetCoords(), ut, moonState))
+        return 20;
 
-    double const moonAltitude = moon->alt().Degrees();
+    double const moonAltitude = moonState.altitude;
 
     // Lunar illumination %
-    double const illum = moon->illum() * 100.0;
+    double const illum = moonState.illumination * 100.0;
 
     // Moon/Sky separation p
-    double const separation = moon->angularDistanceTo(&o).Degrees();
+    double const separation = moonState.separation;
 
     // Zenith distance of the moon
     double const zMoon = (90 - moonAltitude);
     // Zenith distance of target
-    double const zTarget = (90 - o.alt().Degrees());
+    double const zTarget = (90 - ephemeris->altitude(getTargetCoords(), ut));
 
     int16_t score = 0;
 
@@ -868,36 +883,17 @@ int16_t SchedulerJob::getMoonSeparationScore(QDateTime const &when) const
 
 double SchedulerJob::getCurrentMoonSeparation() const
 {
-    // FIXME: block calculating target coordinates at a particular time is duplicated in several places
-    GeoLocation *geo = KStarsData::Instance()->geo();
-
-    // Retrieve the argument date/time, or fall back to current time - don't use QDateTime's timezone!
-    KStarsDateTime ltWhen(KStarsData::Instance()->lt());
-
-    // Create a sky object with the target catalog coordinates
-    SkyPoint const target = getTargetCoords();
-    SkyObject o;
-    o.setRA0(target.ra0());
-    o.setDec0(target.dec0());
-
-    // Update RA/DEC of the target for the current fraction of the day
-    KSNumbers numbers(ltWhen.djd());
-    o.updateCoordsNow(&numbers);
-
-    // Update moon
-    //ut = geo->LTtoUT(ltWhen);
-    //KSNumbers ksnum(ut.djd()); // BUG: possibly LT.djd() != UT.djd() because of translation
-    //LST = geo->GSTtoLST(ut.gst());
-    CachingDms LST = geo->GSTtoLST(geo->LTtoUT(ltWhen).gst());
-    moon->updateCoords(&numbers, true, geo->lat(), &LST, true);
+    // Read Moon separation at current time from the scheduler ephemeris cache
+    Ekos::SchedulerEphemeris::MoonState moonState;
+    if (!Ekos::SchedulerEphemeris::Instance()->moonState(getTargetCoords(), KStarsData::Instance()->ut(), moonState))
+        return 180.0;
 
     // Moon/Sky separation p
-    return moon->angularDistanceTo(&o).Degrees();
+    return moonState.separation;
 }
 
 QDateTime SchedulerJob::calculateAltitudeTime(QDateTime const &when) const
 {
-    // FIXME: block calculating target coordinates at a particular time is duplicated in several places
     GeoLocation *geo = KStarsData::Instance()->geo();
 
     // Retrieve the argument date/time, or fall back to current time - don't use QDateTime's timezone!
@@ -905,51 +901,59 @@ QDateTime SchedulerJob::calculateAltitudeTime(QDateTime const &when) const
                           Qt::UTC == when.timeSpec() ? geo->UTtoLT(KStarsDateTime(when)) : when :
                           KStarsData::Instance()->lt());
 
-    // Create a sky object with the target catalog coordinates
-    SkyPoint const target = getTargetCoords();
-    SkyObject o;
-    o.setRA0(target.ra0());
-    o.setDec0(target.dec0());
-
     // Calculate the UT at the argument time
     KStarsDateTime const ut = geo->LTtoUT(ltWhen);
 
+    Ekos::SchedulerEphemeris * const ephemeris = Ekos::SchedulerEphemeris::Instance();
     double const SETTING_ALTITUDE_CUTOFF = Options::settingAltitudeCutoff();
 
-    // Within the next 24 hours, search when the job target matches the altitude and moon constraints
-    for (unsigned int minute = 0; minute < 24 * 60; minute++)
+    // Check whether the job target matches the altitude and moon constraints at a minute offset from the argument time
+    auto const isObservable = [&](unsigned int minute)
     {
-        KStarsDateTime const ltOffset(ltWhen.addSecs(minute * 60));
+        bool is_setting = false;
+        double const altitude = ephemeris->altitude(getTargetCoords(), ut.addSecs(minute * 60), &is_setting);
+
+        // Don't test proximity to dawn in this situation, we only cater for altitude here
+        if (altitude < getMinAltitude())
+            return false;
+
+        // Continue searching if target is setting and under the cutoff
+        if (is_setting && altitude - SETTING_ALTITUDE_CUTOFF < getMinAltitude())
+            return false;
+
+        // Continue searching if Moon separation is not good enough
+        if (0 < getMinMoonSeparation() && getMoonSeparationScore(ltWhen.addSecs(minute * 60)) < 0)
+            return false;
 
-        // Update RA/DEC of the target for the current fraction of the day
-        KSNumbers numbers(ltOffset.djd());
-        o.updateCoordsNow(&numbers);
+        return true;
+    };
 
-        // Compute local sidereal time for the current fraction of the day, calculate altitude
-        CachingDms const LST = geo->GSTtoLST(geo->LTtoUT(ltOffset).gst());
-        o.EquatorialToHorizontal(&LST, geo->lat());
-        double const altitude = o.alt().Degrees();
+    if (isObservable(0))
+        return ltWhen;
 
-        if (getMinAltitude() <= altitude)
+    // Within the next 24 hours, search when the job target matches the altitude and moon constraints
+    // Scan at the resolution of the ephemeris cache, then refine the threshold crossing to the minute by bisection
+    unsigned int const lastMinute = 24 * 60 - 1;
+    for (unsigned int minute = 0; minute < lastMinute;)
+    {
+        unsigned int const next = std::min<unsigned int>(minute + Ekos::SchedulerEphemeris::SAMPLE_MINUTES, lastMinute);
+
+        if (isObservable(next))
         {
-            // Don't test proximity to dawn in this situation, we only cater for altitude here
-
-            // Continue searching if Moon separation is not good enough
-            if (0 < getMinMoonSeparation() && getMoonSeparationScore(ltOffset) < 0)
-                continue;
-
-            // Continue searching if target is setting and under the cutoff
-            double offset = LST.Hours() - o.ra().Hours();
-            if (24.0 <= offset)
-                offset -= 24.0;
-            else if (offset < 0.0)
-                offset += 24.0;
-            if (0.0 <= offset && offset < 12.0)
-                if (altitude - SETTING_ALTITUDE_CUTOFF < getMinAltitude())
-                    continue;
-
-            return ltOffset;
+            unsigned int low = minute, high = next;
+            while (low + 1 < high)
+            {
+                unsigned int const middle = (low + high) / 2;
+                if (isObservable(middle))
+                    high = middle;
+                else
+                    low = middle;
+            }
+
+            return ltWhen.addSecs(high * 60);
         }
+
+        minute = next;
     }
 
     return QDateTime();
@@ -959,22 +963,19 @@ QDateTime SchedulerJob::calculateCulmination(QDateTime const &when) const
 {
     // FIXME: culmination calculation is a min altitude requirement, should be an interval altitude requirement
     GeoLocation *geo = KStarsData::Instance()->geo();
-    // FIXME: block calculating target coordinates at a particular time is duplicated in calculateCulmination
 
     // Retrieve the argument date/time, or fall back to current time - don't use QDateTime's timezone!
     KStarsDateTime ltWhen(when.isValid() ?
                           Qt::UTC == when.timeSpec() ? geo->UTtoLT(KStarsDateTime(when)) : when :
                           KStarsData::Instance()->lt());
 
-    // Create a sky object with the target catalog coordinates
-    SkyPoint const target = getTargetCoords();
+    // Read RA/DEC for the argument date/time from the scheduler ephemeris cache
     SkyObject o;
-    o.setRA0(target.ra0());
-    o.setDec0(target.dec0());
-
-    // Update RA/DEC for the argument date/time
-    KSNumbers numbers(ltWhen.djd());
-    o.updateCoordsNow(&numbers);
+    SkyPoint const apparent = Ekos::SchedulerEphemeris::Instance()->apparentCoords(getTargetCoords(), geo->LTtoUT(ltWhen));
+    o.setRA0(apparent.ra0());
+    o.setDec0(apparent.dec0());
+    o.setRA(apparent.ra());
+    o.setDec(apparent.dec());
 
     // Calculate transit date/time at the argument date - transitTime requires UT and returns LocalTime
     KStarsDateTime transitDateTime(ltWhen.date(), o.transitTime(geo->LTtoUT(ltWhen), geo), Qt::LocalTime);
@@ -1007,8 +1008,6 @@ QDateTime SchedulerJob::calculateCulmination(QDateTime const &when) const
 
 double SchedulerJob::findAltitude(const SkyPoint &target, const QDateTime &when, bool * is_setting, bool debug)
 {
-    // FIXME: block calculating target coordinates at a particular time is duplicated in several places
-
     GeoLocation * const geo = KStarsData::Instance()->geo();
 
     // Retrieve the argument date/time, or fall back to current time - don't use QDateTime's timezone!
@@ -1016,41 +1015,22 @@ double SchedulerJob::findAltitude(const SkyPoint &target, const QDateTime &when,
                           Qt::UTC == when.timeSpec() ? geo->UTtoLT(KStarsDateTime(when)) : when :
                           KStarsData::Instance()->lt());
 
-    // Create a sky object with the target catalog coordinates
-    SkyObject o;
-    o.setRA0(target.ra0());
-    o.setDec0(target.dec0());
-
-    // Update RA/DEC of the target for the current fraction of the day
-    KSNumbers numbers(ltWhen.djd());
-    o.updateCoordsNow(&numbers);
-
-    // Calculate alt/az coordinates using KStars instance's geolocation
-    CachingDms const LST = geo->GSTtoLST(geo->LTtoUT(ltWhen).gst());
-    o.EquatorialToHorizontal(&LST, geo->lat());
-
-    // Hours are reduced to [0,24[, meridian being at 0
-    double offset = LST.Hours() - o.ra().Hours();
-    if (24.0 <= offset)
-        offset -= 24.0;
-    else if (offset < 0.0)
-        offset += 24.0;
-    bool const passed_meridian = 0.0 <= offset && offset < 12.0;
+    // Read alt/az coordinates and hour angle from the scheduler ephemeris cache, using KStars instance's geolocation
+    bool passed_meridian = false;
+    double hourAngle = 0;
+    double const altitude = Ekos::SchedulerEphemeris::Instance()->altitude(target, geo->LTtoUT(ltWhen), &passed_meridian, &hourAngle);
 
     if (debug)
-        qCDebug(KSTARS_EKOS_SCHEDULER) << QString("When:%9 LST:%8 RA:%1 RA0:%2 DEC:%3 DEC0:%4 alt:%5 setting:%6 HA:%7")
-                                       .arg(o.ra().toHMSString())
-                                       .arg(o.ra0().toHMSString())
-                                       .arg(o.dec().toHMSString())
-                                       .arg(o.dec0().toHMSString())
-                                       .arg(o.alt().Degrees())
+        qCDebug(KSTARS_EKOS_SCHEDULER) << QString("When:%6 RA0:%1 DEC0:%2 alt:%3 setting:%4 HA:%5")
+                                       .arg(target.ra0().toHMSString())
+                                       .arg(target.dec0().toDMSString())
+                                       .arg(altitude)
                                        .arg(passed_meridian ? "yes" : "no")
-                                       .arg(o.ra().Hours())
-                                       .arg(LST.toHMSString())
+                                       .arg(hourAngle)
                                        .arg(ltWhen.toString("HH:mm:ss"));
 
     if (is_setting)
         *is_setting = passed_meridian;
 
-    return o.alt().Degrees();
+    return altitude;
 }
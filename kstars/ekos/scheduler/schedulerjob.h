@@ -13,11 +13,9 @@
 
 #include <QUrl>
 #include <QMap>
-#include "ksmoon.h"
 
 class QTableWidgetItem;
 class QLabel;
-class KSMoon;
 
 class dms;
 
@@ -342,6 +340,18 @@ class SchedulerJob
      */
     void reset();
 
+    /** @brief Create a copy of this SchedulerJob that is not connected to any cell.
+     * @note A detached copy does not touch widgets, and may be evaluated off the main thread.
+     * @return the detached copy.
+     */
+    SchedulerJob detached() const;
+
+    /** @brief Take over the schedule of an evaluated copy of this SchedulerJob.
+     * @arg snapshot is a detached copy of this SchedulerJob, as returned by detached().
+     * @note Cells connected to this SchedulerJob are kept, and refreshed once.
+     */
+    void applySchedule(SchedulerJob const &snapshot);
+
     /** @brief Determining whether a SchedulerJob is a duplicate of another.
      * @param a_job is the other SchedulerJob to test duplication against.
      * @return True if objects are different, but name and sequence file are identical, else false.
@@ -499,7 +509,4 @@ private:
     bool lightFramesRequired { false };
 
     QMap<QString, uint16_t> capturedFramesMap;
-
-    /// Pointer to Moon object
-    KSMoon *moon { nullptr };
 };
@@ -19,7 +19,7 @@
 
 #include "fitsdata.h"
 
-#include "sep/sep.h"
+#include "fitsstardetector.h"
 #include "fpack.h"
 
 #include "kstarsdata.h"
@@ -33,6 +33,7 @@
 #include <QImage>
 #include <QtConcurrent>
 #include <QImageReader>
+#include <QThread>
 
 #if !defined(KSTARS_LITE) && defined(HAVE_WCSLIB)
 #include <wcshdr.h>
@@ -43,8 +44,12 @@
 #include "fitshistogram.h"
 #endif
 
+#include <algorithm>
 #include <cfloat>
 #include <cmath>
+#include <functional>
+#include <limits>
+#include <numeric>
 
 #include <fits_debug.h>
 
@@ -75,6 +80,8 @@ FITSData::FITSData(FITSMode fitsMode): m_Mode(fitsMode)
     debayerParams.method  = DC1394_BAYER_METHOD_NEAREST;
     debayerParams.filter  = DC1394_COLOR_FILTER_RGGB;
     debayerParams.offsetX = debayerParams.offsetY = 0;
+
+    m_Age.start();
 }
 
 FITSData::FITSData(const FITSData * other)
@@ -86,9 +93,12 @@ FITSData::FITSData(const FITSData * other)
     this->m_Mode = other->m_Mode;
     this->m_DataType = other->m_DataType;
     this->m_Channels = other->m_Channels;
+    this->m_StatisticsRegion = other->m_StatisticsRegion;
     memcpy(&stats, &(other->stats), sizeof(stats));
     m_ImageBuffer = new uint8_t[stats.samples_per_channel * m_Channels * stats.bytesPerPixel];
     memcpy(m_ImageBuffer, other->m_ImageBuffer, stats.samples_per_channel * m_Channels * stats.bytesPerPixel);
+
+    m_Age.start();
 }
 
 FITSData::~FITSData()
@@ -105,8 +115,6 @@ FITSData::~FITSData()
     if (starCenters.count() > 0)
         qDeleteAll(starCenters);
 
-    delete[] wcs_coord;
-
     if (objList.count() > 0)
         qDeleteAll(objList);
 
@@ -115,6 +123,7 @@ FITSData::~FITSData()
         fits_flush_file(fptr, &status);
         fits_close_file(fptr, &status);
         fptr = nullptr;
+        releaseMemoryFile();
 
         if (m_isTemporary && autoRemoveTemporaryFITS)
             QFile::remove(m_Filename);
@@ -134,6 +143,7 @@ void FITSData::loadCommon(const QString &inFilename)
         fits_flush_file(fptr, &status);
         fits_close_file(fptr, &status);
         fptr = nullptr;
+        releaseMemoryFile();
 
         // If current file is temporary AND
         // Auto Remove Temporary File is Set AND
@@ -357,9 +367,59 @@ bool FITSData::privateLoad(void *fits_buffer, size_t fits_buffer_size, bool sile
 
     starsSearched = false;
 
+    // The memory buffer belongs to the caller, which may release it as soon as we return
+    if (fits_buffer != nullptr)
+    {
+        if (detachMemoryFile() == false)
+            return fitsOpenError(status, i18n("Error copying fits buffer."), silent);
+
+        // Keep the frame as received, the image buffer may be filtered or debayered by the time a file is needed
+        m_ReceivedFrame = QByteArray(static_cast<const char *>(fits_buffer), static_cast<int>(fits_buffer_size));
+    }
+
+    return true;
+}
+
+bool FITSData::detachMemoryFile()
+{
+    int status = 0;
+    fitsfile *memoryFptr = nullptr;
+
+    m_MemoryFileSize = 2880;
+    m_MemoryFile = malloc(m_MemoryFileSize);
+
+    // Keep the header only, image data is already in the image buffer.
+    // Debayered frames keep their raw data too, as it is what gets saved for them.
+    if (m_MemoryFile == nullptr ||
+            fits_create_memfile(&memoryFptr, &m_MemoryFile, &m_MemoryFileSize, 2880, realloc, &status) ||
+            (HasDebayer ? fits_copy_hdu(fptr, memoryFptr, 0, &status) : fits_copy_header(fptr, memoryFptr, &status)))
+    {
+        fits_report_error(stderr, status);
+        if (memoryFptr != nullptr)
+        {
+            status = 0;
+            fits_close_file(memoryFptr, &status);
+        }
+        releaseMemoryFile();
+        return false;
+    }
+
+    status = 0;
+    fits_close_file(fptr, &status);
+    fptr = memoryFptr;
+
     return true;
 }
 
+void FITSData::releaseMemoryFile()
+{
+    free(m_MemoryFile);
+    m_MemoryFile = nullptr;
+    m_MemoryFileSize = 0;
+    m_ReceivedFrame.clear();
+    m_UpdatedRecords.clear();
+}
+
 int FITSData::saveFITS(const QString &newFilename)
 {
     if (newFilename == m_Filename)
@@ -377,6 +437,29 @@ int FITSData::saveFITS(const QString &newFilename)
 
     if (HasDebayer)
     {
+        // Frames loaded from memory have no raw file to copy, write the raw image HDU out instead
+        if (QFile::exists(m_Filename) == false)
+        {
+            QString finalFileName(newFilename);
+            finalFileName.remove('!');
+            QFile::remove(finalFileName);
+
+            if (fits_create_diskfile(&new_fptr, finalFileName.toLatin1(), &status) ||
+                    fits_copy_file(fptr, new_fptr, 1, 1, 1, &status))
+            {
+                fits_report_error(stderr, status);
+                return status;
+            }
+
+            fits_close_file(fptr, &status);
+            releaseMemoryFile();
+            fptr = new_fptr;
+            m_Filename = finalFileName;
+            m_isTemporary = false;
+
+            return 0;
+        }
+
         fits_flush_file(fptr, &status);
         /* close current file */
         if (fits_close_file(fptr, &status))
@@ -445,6 +528,7 @@ int FITSData::saveFITS(const QString &newFilename)
         return status;
     }
 
+    releaseMemoryFile();
     status = 0;
 
     fptr = new_fptr;
@@ -464,18 +548,20 @@ int FITSData::saveFITS(const QString &newFilename)
 
     /* Write keywords */
 
-    // Minimum
-    if (fits_update_key(fptr, TDOUBLE, "DATAMIN", &(stats.min), "Minimum value", &status))
+    // Minimum and maximum, unless the statistics only cover a region of the image
+    if (hasFullStatistics())
     {
-        fits_report_error(stderr, status);
-        return status;
-    }
+        if (fits_update_key(fptr, TDOUBLE, "DATAMIN", &(stats.min), "Minimum value", &status))
+        {
+            fits_report_error(stderr, status);
+            return status;
+        }
 
-    // Maximum
-    if (fits_update_key(fptr, TDOUBLE, "DATAMAX", &(stats.max), "Maximum value", &status))
-    {
-        fits_report_error(stderr, status);
-        return status;
+        if (fits_update_key(fptr, TDOUBLE, "DATAMAX", &(stats.max), "Maximum value", &status))
+        {
+            fits_report_error(stderr, status);
+            return status;
+        }
     }
 
     // NAXIS1
@@ -538,6 +624,114 @@ int FITSData::saveFITS(const QString &newFilename)
     return status;
 }
 
+bool FITSData::ensureFileOnDisk()
+{
+    if (m_Filename.isEmpty() || fptr == nullptr)
+        return false;
+
+    if (QFile::exists(m_Filename))
+        return true;
+
+    if (m_ReceivedFrame.isEmpty())
+    {
+        qCCritical(KSTARS_FITS) << "FITS: No frame to write to" << m_Filename;
+        return false;
+    }
+
+    // Write the frame exactly as it was received, then the header records updated since
+    QFile file(m_Filename);
+    if (file.open(QIODevice::WriteOnly) == false || file.write(m_ReceivedFrame) != m_ReceivedFrame.size())
+    {
+        qCCritical(KSTARS_FITS) << "FITS: Failed to write" << m_Filename << file.errorString();
+        file.close();
+        QFile::remove(m_Filename);
+        return false;
+    }
+    file.close();
+
+    if (m_UpdatedRecords.isEmpty() == false)
+    {
+        int status = 0;
+        fitsfile *diskFptr = nullptr;
+
+        // Use open diskfile as it does not use extended file names which has problems opening
+        // files with [ ] or ( ) in their names.
+        if (fits_open_diskfile(&diskFptr, m_Filename.toLatin1(), READWRITE, &status))
+        {
+            fits_report_error(stderr, status);
+            return false;
+        }
+
+        for (const Record &oneRecord : m_UpdatedRecords)
+        {
+            if (writeRecord(diskFptr, oneRecord, &status))
+            {
+                fits_report_error(stderr, status);
+                status = 0;
+            }
+        }
+
+        fits_close_file(diskFptr, &status);
+    }
+
+    return true;
+}
+
+int FITSData::saveXYList(const QString &newFilename, int maxStars)
+{
+    bool ok = false;
+    FITSStarDetector::StarList const stars = FITSStarDetector::findStars(m_ImageBuffer, stats.bitpix, stats.width,
+            stats.height, QRect(), 50, &ok);
+    if (!ok)
+        return -1;
+
+    // Brightest stars first, which is also the order the solver tries them in
+    QVector<int> order(stars.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&stars](int s1, int s2) -> bool { return stars.flux[s1] > stars.flux[s2];});
+
+    int const starCount = qMin(maxStars, order.count());
+    QVector<float> x(starCount), y(starCount), flux(starCount);
+    for (int i = 0; i < starCount; i++)
+    {
+        // XY lists use the FITS convention, where the center of the first pixel is at 1,1,
+        // while the star centers of the detector place it at 0.5,0.5
+        x[i]    = stars.x[order[i]] + 0.5;
+        y[i]    = stars.y[order[i]] + 0.5;
+        flux[i] = stars.flux[order[i]];
+    }
+
+    fitsfile *xyptr = nullptr;
+    int status = 0;
+    char error_status[512] = {0};
+    char *columnNames[] = { const_cast<char *>("X"), const_cast<char *>("Y"), const_cast<char *>("FLUX") };
+    char *columnFormats[] = { const_cast<char *>("E"), const_cast<char *>("E"), const_cast<char *>("E") };
+    long imageWidth = stats.width, imageHeight = stats.height;
+
+    if (fits_create_file(&xyptr, QString('!' + newFilename).toLocal8Bit(), &status) ||
+            fits_create_img(xyptr, BYTE_IMG, 0, nullptr, &status) ||
+            fits_create_tbl(xyptr, BINARY_TBL, starCount, 3, columnNames, columnFormats, nullptr, "SOURCES", &status) ||
+            fits_update_key(xyptr, TLONG, "IMAGEW", &imageWidth, "Image width, in pixels", &status) ||
+            fits_update_key(xyptr, TLONG, "IMAGEH", &imageHeight, "Image height, in pixels", &status) ||
+            fits_write_col(xyptr, TFLOAT, 1, 1, 1, starCount, x.data(), &status) ||
+            fits_write_col(xyptr, TFLOAT, 2, 1, 1, starCount, y.data(), &status) ||
+            fits_write_col(xyptr, TFLOAT, 3, 1, 1, starCount, flux.data(), &status))
+    {
+        fits_get_errstatus(status, error_status);
+        qCCritical(KSTARS_FITS) << "Failed to write XY list" << newFilename << "Error:" << error_status;
+        status = 0;
+        if (xyptr)
+            fits_close_file(xyptr, &status);
+        return -1;
+    }
+
+    fits_close_file(xyptr, &status);
+
+    qCInfo(KSTARS_FITS) << "Saved" << starCount << "of" << stars.size() << "stars to XY list" << newFilename;
+
+    return starCount;
+}
+
 void FITSData::clearImageBuffers()
 {
     delete[] m_ImageBuffer;
@@ -547,48 +741,65 @@ void FITSData::clearImageBuffers()
 
 void FITSData::calculateStats(bool refresh)
 {
-    // Calculate min max
-    calculateMinMax(refresh);
-
-    // Get standard deviation and mean in one run
+    // Get min, max, mean, standard deviation and median in one run
     switch (m_DataType)
     {
         case TBYTE:
-            runningAverageStdDev<uint8_t>();
+            calculateStatistics<uint8_t>();
             break;
 
         case TSHORT:
-            runningAverageStdDev<int16_t>();
+            calculateStatistics<int16_t>();
             break;
 
         case TUSHORT:
-            runningAverageStdDev<uint16_t>();
+            calculateStatistics<uint16_t>();
             break;
 
         case TLONG:
-            runningAverageStdDev<int32_t>();
+            calculateStatistics<int32_t>();
             break;
 
         case TULONG:
-            runningAverageStdDev<uint32_t>();
+            calculateStatistics<uint32_t>();
             break;
 
         case TFLOAT:
-            runningAverageStdDev<float>();
+            calculateStatistics<float>();
             break;
 
         case TLONGLONG:
-            runningAverageStdDev<int64_t>();
+            calculateStatistics<int64_t>();
             break;
 
         case TDOUBLE:
-            runningAverageStdDev<double>();
+            calculateStatistics<double>();
             break;
 
         default:
             return;
     }
 
+    // Unless refreshing after a transformation, min and max from the header prevail, when they describe the same pixels
+    if ((fptr != nullptr) && !refresh && m_StatisticsRegion.intersected(QRect(0, 0, stats.width, stats.height)).isEmpty())
+    {
+        int status = 0, nfound = 0;
+        double min = 0, max = 0;
+
+        if (fits_read_key_dbl(fptr, "DATAMIN", &min, nullptr, &status) == 0)
+            nfound++;
+
+        if (fits_read_key_dbl(fptr, "DATAMAX", &max, nullptr, &status) == 0)
+            nfound++;
+
+        // Only use the keywords if we found both, unless they are both zeros
+        if (nfound == 2 && !(min == 0 && max == 0))
+        {
+            stats.min[0] = min;
+            stats.max[0] = max;
+        }
+    }
+
     // FIXME That's not really SNR, must implement a proper solution for this value
     stats.SNR = stats.mean[0] / stats.stddev[0];
 
@@ -597,208 +808,191 @@ void FITSData::calculateStats(bool refresh)
         starsSearched = false;
 }
 
-int FITSData::calculateMinMax(bool refresh)
+template <typename T>
+FITSData::PartitionStatistics FITSData::getPartitionStatistics(const T *buffer, uint32_t stride, uint32_t sampleBy)
 {
-    int status, nfound = 0;
-
-    status = 0;
-
-    if ((fptr != nullptr) && !refresh)
-    {
-        if (fits_read_key_dbl(fptr, "DATAMIN", &(stats.min[0]), nullptr, &status) == 0)
-            nfound++;
+    // Types of 16 bits or less get a full histogram, which provides an exact median
+    constexpr bool hasHistogram = std::numeric_limits<T>::is_integer && sizeof(T) <= 2;
 
-        if (fits_read_key_dbl(fptr, "DATAMAX", &(stats.max[0]), nullptr, &status) == 0)
-            nfound++;
+    PartitionStatistics result;
 
-        // If we found both keywords, no need to calculate them, unless they are both zeros
-        if (nfound == 2 && !(stats.min[0] == 0 && stats.max[0] == 0))
-            return 0;
-    }
+    if (stride == 0)
+        return result;
 
-    stats.min[0] = 1.0E30;
-    stats.max[0] = -1.0E30;
+    if (hasHistogram)
+        result.histogram.fill(0, 1 << (hasHistogram ? 8 * sizeof(T) : 0));
+    uint32_t * const histogram = result.histogram.data();
 
-    stats.min[1] = 1.0E30;
-    stats.max[1] = -1.0E30;
+    // Values are shifted by the first sample to keep the squared sum accurate, whatever the offset of the data
+    double const shift = buffer[0];
 
-    stats.min[2] = 1.0E30;
-    stats.max[2] = -1.0E30;
+    // Four independent lanes let the compiler vectorize min, max and sums
+    T min[4] = { buffer[0], buffer[0], buffer[0], buffer[0] };
+    T max[4] = { buffer[0], buffer[0], buffer[0], buffer[0] };
+    double sum[4] = {0}, squaredSum[4] = {0};
 
-    switch (m_DataType)
+    uint32_t i = 0;
+    for (; i + 4 <= stride; i += 4)
     {
-        case TBYTE:
-            calculateMinMax<uint8_t>();
-            break;
+        for (int lane = 0; lane < 4; lane++)
+        {
+            T const value = buffer[i + lane];
+            double const delta = value - shift;
 
-        case TSHORT:
-            calculateMinMax<int16_t>();
-            break;
+            min[lane] = std::min(min[lane], value);
+            max[lane] = std::max(max[lane], value);
+            sum[lane] += delta;
+            squaredSum[lane] += delta * delta;
 
-        case TUSHORT:
-            calculateMinMax<uint16_t>();
-            break;
+            if (hasHistogram)
+                histogram[static_cast<int32_t>(value) - static_cast<int32_t>(std::numeric_limits<T>::min())]++;
+        }
+    }
 
-        case TLONG:
-            calculateMinMax<int32_t>();
-            break;
+    for (; i < stride; i++)
+    {
+        T const value = buffer[i];
+        double const delta = value - shift;
 
-        case TULONG:
-            calculateMinMax<uint32_t>();
-            break;
+        min[0] = std::min(min[0], value);
+        max[0] = std::max(max[0], value);
+        sum[0] += delta;
+        squaredSum[0] += delta * delta;
 
-        case TFLOAT:
-            calculateMinMax<float>();
-            break;
+        if (hasHistogram)
+            histogram[static_cast<int32_t>(value) - static_cast<int32_t>(std::numeric_limits<T>::min())]++;
+    }
 
-        case TLONGLONG:
-            calculateMinMax<int64_t>();
-            break;
+    // Other types get a subsample, from which an approximate median is taken
+    if (!hasHistogram)
+    {
+        result.samples.reserve(stride / sampleBy + 1);
+        for (uint32_t j = 0; j < stride; j += sampleBy)
+            result.samples.append(buffer[j]);
+    }
 
-        case TDOUBLE:
-            calculateMinMax<double>();
-            break;
+    double const totalSum = sum[0] + sum[1] + sum[2] + sum[3];
+    double const totalSquaredSum = squaredSum[0] + squaredSum[1] + squaredSum[2] + squaredSum[3];
 
-        default:
-            break;
-    }
+    result.count = stride;
+    result.min = *std::min_element(min, min + 4);
+    result.max = *std::max_element(max, max + 4);
+    result.mean = shift + totalSum / stride;
+    result.squaredDeviation = std::max(0.0, totalSquaredSum - totalSum * totalSum / stride);
 
-    //qDebug() << "DATAMIN: " << stats.min << " - DATAMAX: " << stats.max;
-    return 0;
+    return result;
 }
 
 template <typename T>
-QPair<T, T> FITSData::getParitionMinMax(uint32_t start, uint32_t stride)
+void FITSData::calculateStatistics()
 {
-    auto * buffer = reinterpret_cast<T *>(m_ImageBuffer);
-    T min = std::numeric_limits<T>::max();
-    T max = std::numeric_limits<T>::min();
+    constexpr bool hasHistogram = std::numeric_limits<T>::is_integer && sizeof(T) <= 2;
 
-    uint32_t end = start + stride;
+    // Partitions are large enough to amortize thread dispatch, and there are no more of them than cores
+    uint32_t const minPartitionSize = 1 << 16;
+    int const nThreads = qBound(1, static_cast<int>(stats.samples_per_channel / minPartitionSize), QThread::idealThreadCount());
 
-    for (uint32_t i = start; i < end; i++)
-    {
-        if (buffer[i] < min)
-            min = buffer[i];
-        else if (buffer[i] > max)
-            max = buffer[i];
-    }
-
-    return qMakePair(min, max);
-}
-
-template <typename T>
-void FITSData::calculateMinMax()
-{
-    T min = std::numeric_limits<T>::max();
-    T max = std::numeric_limits<T>::min();
+    // Approximate median is taken from about a million samples per channel
+    uint32_t const sampleBy = std::max<uint32_t>(1, stats.samples_per_channel / 1000000);
 
-    // Create N threads
-    const uint8_t nThreads = 16;
+    QRect const region = m_StatisticsRegion.intersected(QRect(0, 0, stats.width, stats.height));
 
     for (int n = 0; n < m_Channels; n++)
     {
-        uint32_t cStart = n * stats.samples_per_channel;
-
-        // Calculate how many elements we process per thread
-        uint32_t tStride = stats.samples_per_channel / nThreads;
+        auto const * const channel = reinterpret_cast<T const *>(m_ImageBuffer) + n * stats.samples_per_channel;
 
-        // Calculate the final stride since we can have some left over due to division above
-        uint32_t fStride = tStride + (stats.samples_per_channel - (tStride * nThreads));
+        PartitionStatistics total;
 
-        // Start location for inspecting elements
-        uint32_t tStart = cStart;
-
-        // List of futures
-        QList<QFuture<QPair<T, T>>> futures;
-
-        for (int i = 0; i < nThreads; i++)
+        if (!region.isEmpty())
         {
-            // Run threads
-            futures.append(QtConcurrent::run(this, &FITSData::getParitionMinMax<T>, tStart, (i == (nThreads - 1)) ? fStride : tStride));
-            tStart += tStride;
-        }
+            // The region is small, so gather its rows and inspect them in this thread
+            QVector<T> samples(region.width() * region.height());
+            for (int y = 0; y < region.height(); y++)
+            {
+                auto const * const row = channel + (region.y() + y) * stats.width + region.x();
+                std::copy(row, row + region.width(), samples.begin() + y * region.width());
+            }
 
-        // Now wait for results
-        for (int i = 0; i < nThreads; i++)
-        {
-            QPair<T, T> result = futures[i].result();
-            if (result.first < min)
-                min = result.first;
-            if (result.second > max)
-                max = result.second;
+            total = getPartitionStatistics<T>(samples.constData(), samples.size(), 1);
         }
+        else
+        {
+            // Calculate how many elements we process per thread
+            uint32_t tStride = stats.samples_per_channel / nThreads;
 
-        stats.min[n] = min;
-        stats.max[n] = max;
-    }
-}
+            // Calculate the final stride since we can have some left over due to division above
+            uint32_t fStride = tStride + (stats.samples_per_channel - (tStride * nThreads));
 
-template <typename T>
-QPair<double, double> FITSData::getSquaredSumAndMean(uint32_t start, uint32_t stride)
-{
-    uint32_t m_n       = 2;
-    double m_oldM = 0, m_newM = 0, m_oldS = 0, m_newS = 0;
+            // Start location for inspecting elements
+            auto const * tStart = channel;
 
-    auto * buffer = reinterpret_cast<T *>(m_ImageBuffer);
-    uint32_t end = start + stride;
+            // List of futures
+            QList<QFuture<PartitionStatistics>> futures;
 
-    for (uint32_t i = start; i < end; i++)
-    {
-        m_newM = m_oldM + (buffer[i] - m_oldM) / m_n;
-        m_newS = m_oldS + (buffer[i] - m_oldM) * (buffer[i] - m_newM);
+            for (int i = 0; i < nThreads; i++)
+            {
+                // Run threads
+                futures.append(QtConcurrent::run(this, &FITSData::getPartitionStatistics<T>, tStart,
+                                                 (i == (nThreads - 1)) ? fStride : tStride, sampleBy));
+                tStart += tStride;
+            }
 
-        m_oldM = m_newM;
-        m_oldS = m_newS;
-        m_n++;
-    }
+            // Now wait for results, and merge them using the pairwise update of the variance
+            total = futures[0].result();
 
-    return qMakePair<double, double>(m_newM, m_newS);
-}
+            for (int i = 1; i < nThreads; i++)
+            {
+                PartitionStatistics const result = futures[i].result();
 
-template <typename T>
-void FITSData::runningAverageStdDev()
-{
-    // Create N threads
-    const uint8_t nThreads = 16;
+                if (result.count == 0)
+                    continue;
 
-    for (int n = 0; n < m_Channels; n++)
-    {
-        uint32_t cStart = n * stats.samples_per_channel;
+                uint32_t const count = total.count + result.count;
+                double const delta = result.mean - total.mean;
 
-        // Calculate how many elements we process per thread
-        uint32_t tStride = stats.samples_per_channel / nThreads;
+                total.min = std::min(total.min, result.min);
+                total.max = std::max(total.max, result.max);
+                total.mean += delta * result.count / count;
+                total.squaredDeviation += result.squaredDeviation + delta * delta * total.count / count * result.count;
+                total.count = count;
 
-        // Calculate the final stride since we can have some left over due to division above
-        uint32_t fStride = tStride + (stats.samples_per_channel - (tStride * nThreads));
+                if (hasHistogram)
+                    std::transform(total.histogram.constBegin(), total.histogram.constEnd(), result.histogram.constBegin(),
+                                   total.histogram.begin(), std::plus<uint32_t>());
+                else
+                    total.samples.append(result.samples);
+            }
+        }
 
-        // Start location for inspecting elements
-        uint32_t tStart = cStart;
+        if (total.count == 0)
+            continue;
 
-        // List of futures
-        QList<QFuture<QPair<double, double>>> futures;
+        stats.min[n]    = total.min;
+        stats.max[n]    = total.max;
+        stats.mean[n]   = total.mean;
+        stats.stddev[n] = sqrt(total.squaredDeviation / total.count);
 
-        for (int i = 0; i < nThreads; i++)
+        if (hasHistogram)
         {
-            // Run threads
-            futures.append(QtConcurrent::run(this, &FITSData::getSquaredSumAndMean<T>, tStart, (i == (nThreads - 1)) ? fStride : tStride));
-            tStart += tStride;
-        }
-
-        double mean = 0, squared_sum = 0;
+            uint32_t const half = (total.count + 1) / 2;
+            uint32_t cumulative = 0;
 
-        // Now wait for results
-        for (int i = 0; i < nThreads; i++)
+            for (int i = 0; i < total.histogram.size(); i++)
+            {
+                cumulative += total.histogram[i];
+                if (cumulative >= half)
+                {
+                    stats.median[n] = static_cast<double>(i) + std::numeric_limits<T>::min();
+                    break;
+                }
+            }
+        }
+        else if (!total.samples.isEmpty())
         {
-            QPair<double, double> result = futures[i].result();
-            mean += result.first;
-            squared_sum += result.second;
+            auto middle = total.samples.begin() + total.samples.size() / 2;
+            std::nth_element(total.samples.begin(), middle, total.samples.end());
+            stats.median[n] = *middle;
         }
-
-        double variance = squared_sum / stats.samples_per_channel;
-
-        stats.mean[n]   = mean / nThreads;
-        stats.stddev[n] = sqrt(variance);
     }
 }
 
@@ -880,6 +1074,70 @@ bool FITSData::getRecordValue(const QString &key, QVariant &value) const
     return false;
 }
 
+bool FITSData::updateRecordValue(const QString &key, const QVariant &value, const QString &comment)
+{
+    if (fptr == nullptr)
+        return false;
+
+    Record newRecord { key, value, comment };
+
+    int status = 0;
+    if (writeRecord(fptr, newRecord, &status))
+    {
+        fits_report_error(stderr, status);
+        return false;
+    }
+
+    auto match = std::find_if(records.begin(), records.end(), [&key](const Record * oneRecord)
+    {
+        return oneRecord->key == key;
+    });
+    if (match != records.end())
+        **match = newRecord;
+    else
+        records.append(new Record(newRecord));
+
+    // Frames kept in memory get the record when written to disk
+    if (m_ReceivedFrame.isEmpty() == false)
+    {
+        m_UpdatedRecords.erase(std::remove_if(m_UpdatedRecords.begin(), m_UpdatedRecords.end(),
+                                              [&key](const Record & oneRecord)
+        {
+            return oneRecord.key == key;
+        }), m_UpdatedRecords.end());
+        m_UpdatedRecords.append(newRecord);
+    }
+
+    return true;
+}
+
+int FITSData::writeRecord(fitsfile *file, const Record &record, int *status)
+{
+    QByteArray key = record.key.toLatin1();
+    QByteArray comment = record.comment.toLatin1();
+
+    switch (static_cast<QMetaType::Type>(record.value.type()))
+    {
+        case QMetaType::Int:
+        {
+            int value = record.value.toInt();
+            return fits_update_key(file, TINT, key.data(), &value, comment.data(), status);
+        }
+
+        case QMetaType::Double:
+        {
+            double value = record.value.toDouble();
+            return fits_update_key(file, TDOUBLE, key.data(), &value, comment.data(), status);
+        }
+
+        default:
+        {
+            QByteArray value = record.value.toString().toLatin1();
+            return fits_update_key_str(file, key.data(), value.data(), comment.data(), status);
+        }
+    }
+}
+
 bool FITSData::checkCollision(Edge * s1, Edge * s2)
 {
     int dis; //distance
@@ -2136,17 +2394,9 @@ void FITSData::applyFilter(FITSScale type, uint8_t * targetImage, QVector<double
             for (int i = 0; i < nThreads * m_Channels; i++)
                 futures[i].waitForFinished();
 
+            // The statistics of the clipped image, including its actual minimum and maximum
             if (calcStats)
-            {
-                for (int i = 0; i < 3; i++)
-                {
-                    stats.min[i] = min[i];
-                    stats.max[i] = max[i];
-                }
-                //if (type != FITS_AUTO && type != FITS_LINEAR)
-                runningAverageStdDev<T>();
-                //QtConcurrent::run(this, &FITSData::runningAverageStdDev<T>);
-            }
+                calculateStatistics<T>();
         }
         break;
 
@@ -2253,7 +2503,7 @@ void FITSData::applyFilter(FITSScale type, uint8_t * targetImage, QVector<double
             delete[] extension;
 
             if (calcStats)
-                runningAverageStdDev<T>();
+                calculateStatistics<T>();
         }
         break;
 
@@ -2448,38 +2698,42 @@ bool FITSData::loadWCS()
         return false;
     }
 
-    delete[] wcs_coord;
+    // Only sample a coarse grid of coordinates, other pixels are interpolated or computed on request.
+    // Points are taken every WCS_GRID_STEP pixels, and on the last row and column so that the grid covers the whole image.
+    wcsGridWidth  = (w - 1 + WCS_GRID_STEP - 1) / WCS_GRID_STEP + 1;
+    wcsGridHeight = (h - 1 + WCS_GRID_STEP - 1) / WCS_GRID_STEP + 1;
+
+    int const gridSize = wcsGridWidth * wcsGridHeight;
 
-    wcs_coord = new wcs_point[w * h];
+    QVector<double> gridPixels(gridSize * 2), gridImage(gridSize * 2), gridWorld(gridSize * 2);
+    QVector<double> gridPhi(gridSize), gridTheta(gridSize);
+    QVector<int> gridStat(gridSize);
 
-    if (wcs_coord == nullptr)
+    for (int row = 0, index = 0; row < wcsGridHeight; row++)
     {
-        wcsvfree(&m_nwcs, &m_wcs);
-        m_wcs = nullptr;
-        lastError = "Not enough memory for WCS data!";
-        return false;
+        for (int column = 0; column < wcsGridWidth; column++, index += 2)
+        {
+            gridPixels[index]     = std::min(column * WCS_GRID_STEP, w - 1);
+            gridPixels[index + 1] = std::min(row * WCS_GRID_STEP, h - 1);
+        }
     }
 
-    wcs_point * p = wcs_coord;
+    // Invalid points are reported per coordinate in gridStat, they are marked and skipped by lookups
+    if ((status = wcsp2s(m_wcs, gridSize, 2, gridPixels.data(), gridImage.data(), gridPhi.data(), gridTheta.data(),
+                         gridWorld.data(), gridStat.data())) != 0)
+        lastError = QString("wcsp2s error %1: %2.").arg(status).arg(wcs_errmsg[status]);
 
-    for (int i = 0; i < h; i++)
+    wcsGrid.resize(gridSize);
+    for (int i = 0; i < gridSize; i++)
     {
-        for (int j = 0; j < w; j++)
+        if (gridStat[i] == 0)
         {
-            pixcrd[0] = j;
-            pixcrd[1] = i;
-
-            if ((status = wcsp2s(m_wcs, 1, 2, &pixcrd[0], &imgcrd[0], &phi, &theta, &world[0], &stat[0])) != 0)
-            {
-                lastError = QString("wcsp2s error %1: %2.").arg(status).arg(wcs_errmsg[status]);
-            }
-            else
-            {
-                p->ra  = world[0];
-                p->dec = world[1];
-
-                p++;
-            }
+            wcsGrid[i].ra  = gridWorld[i * 2];
+            wcsGrid[i].dec = gridWorld[i * 2 + 1];
+        }
+        else
+        {
+            wcsGrid[i].ra = wcsGrid[i].dec = std::numeric_limits<float>::quiet_NaN();
         }
     }
 
@@ -2496,6 +2750,79 @@ bool FITSData::loadWCS()
 #endif
 }
 
+bool FITSData::getWCSCoord(const QPointF &wcsPixelPoint, wcs_point &coord) const
+{
+    if (!WCSLoaded || wcsGridWidth < 2 || wcsGridHeight < 2)
+        return false;
+
+    int const w = width();
+    int const h = height();
+
+    double const x = wcsPixelPoint.x();
+    double const y = wcsPixelPoint.y();
+
+    if (x < 0 || y < 0 || x > w - 1 || y > h - 1)
+        return false;
+
+    // Locate the grid cell enclosing the pixel, the last cell may be narrower than the others
+    int const column = std::min(static_cast<int>(x) / WCS_GRID_STEP, wcsGridWidth - 2);
+    int const row    = std::min(static_cast<int>(y) / WCS_GRID_STEP, wcsGridHeight - 2);
+
+    double const x0 = column * WCS_GRID_STEP, x1 = std::min((column + 1) * WCS_GRID_STEP, w - 1);
+    double const y0 = row * WCS_GRID_STEP, y1 = std::min((row + 1) * WCS_GRID_STEP, h - 1);
+
+    double const tx = x1 > x0 ? (x - x0) / (x1 - x0) : 0;
+    double const ty = y1 > y0 ? (y - y0) / (y1 - y0) : 0;
+
+    wcs_point const &p00 = wcsGrid[row * wcsGridWidth + column];
+    wcs_point const &p10 = wcsGrid[row * wcsGridWidth + column + 1];
+    wcs_point const &p01 = wcsGrid[(row + 1) * wcsGridWidth + column];
+    wcs_point const &p11 = wcsGrid[(row + 1) * wcsGridWidth + column + 1];
+
+    if (std::isnan(p00.ra) || std::isnan(p10.ra) || std::isnan(p01.ra) || std::isnan(p11.ra))
+        return false;
+
+    // Unwrap right ascension around the first corner, in case the cell crosses 0h
+    auto unwrap = [&p00](double ra)
+    {
+        return ra - 360.0 * std::round((ra - p00.ra) / 360.0);
+    };
+
+    double const ra = (1 - ty) * ((1 - tx) * p00.ra + tx * unwrap(p10.ra)) + ty * ((1 - tx) * unwrap(p01.ra) + tx * unwrap(p11.ra));
+    double const dec = (1 - ty) * ((1 - tx) * p00.dec + tx * p10.dec) + ty * ((1 - tx) * p01.dec + tx * p11.dec);
+
+    double const wrapped = std::fmod(ra, 360.0);
+    coord.ra  = wrapped < 0 ? wrapped + 360.0 : wrapped;
+    coord.dec = dec;
+
+    return true;
+}
+
+bool FITSData::getWCSBounds(double &minRA, double &maxRA, double &minDec, double &maxDec) const
+{
+    if (!WCSLoaded || wcsGrid.isEmpty())
+        return false;
+
+    maxRA  = -1000;
+    minRA  = 1000;
+    maxDec = -1000;
+    minDec = 1000;
+
+    // Extrema of a projection without pole in the field are on the edges, which the grid samples
+    for (wcs_point const &p : wcsGrid)
+    {
+        if (std::isnan(p.ra))
+            continue;
+
+        minRA  = std::min<double>(minRA, p.ra);
+        maxRA  = std::max<double>(maxRA, p.ra);
+        minDec = std::min<double>(minDec, p.dec);
+        maxDec = std::max<double>(maxDec, p.dec);
+    }
+
+    return minRA <= maxRA;
+}
+
 bool FITSData::wcsToPixel(SkyPoint &wcsCoord, QPointF &wcsPixelPoint, QPointF &wcsImagePoint)
 {
 #if !defined(KSTARS_LITE) && defined(HAVE_WCSLIB)
@@ -2595,20 +2922,18 @@ void FITSData::findObjectsInImage(double world[], double phi, double theta, doub
 
     SkyMapComposite * map = KStarsData::Instance()->skyComposite();
 
-    wcs_point * wcs_coord = getWCSCoord();
-    if (wcs_coord != nullptr)
+    if (!wcsGrid.isEmpty())
     {
-        int size = w * h;
-
         objList.clear();
 
+        // Use the first and last pixels of the image as corners of the search area
         SkyPoint p1;
-        p1.setRA0(dms(wcs_coord[0].ra));
-        p1.setDec0(dms(wcs_coord[0].dec));
+        p1.setRA0(dms(wcsGrid.first().ra));
+        p1.setDec0(dms(wcsGrid.first().dec));
         p1.updateCoordsNow(num);
         SkyPoint p2;
-        p2.setRA0(dms(wcs_coord[size - 1].ra));
-        p2.setDec0(dms(wcs_coord[size - 1].dec));
+        p2.setRA0(dms(wcsGrid.last().ra));
+        p2.setDec0(dms(wcsGrid.last().dec));
         p2.updateCoordsNow(num);
         QList<SkyObject *> list = map->findObjectsInArea(p1, p2);
 
@@ -4020,22 +4345,24 @@ bool FITSData::injectWCS(const QString &newWCSFile, double orientation, double r
 
     /* Write keywords */
 
-    // Minimum
-    if (fits_update_key(fptr, TDOUBLE, "DATAMIN", &(stats.min), "Minimum value", &status))
+    // Minimum and maximum, unless the statistics only cover a region of the image
+    if (hasFullStatistics())
     {
-        fits_get_errstatus(status, errMsg);
-        lastError = QString(errMsg);
-        fits_report_error(stderr, status);
-        return false;
-    }
+        if (fits_update_key(fptr, TDOUBLE, "DATAMIN", &(stats.min), "Minimum value", &status))
+        {
+            fits_get_errstatus(status, errMsg);
+            lastError = QString(errMsg);
+            fits_report_error(stderr, status);
+            return false;
+        }
 
-    // Maximum
-    if (fits_update_key(fptr, TDOUBLE, "DATAMAX", &(stats.max), "Maximum value", &status))
-    {
-        fits_get_errstatus(status, errMsg);
-        lastError = QString(errMsg);
-        fits_report_error(stderr, status);
-        return false;
+        if (fits_update_key(fptr, TDOUBLE, "DATAMAX", &(stats.max), "Maximum value", &status))
+        {
+            fits_get_errstatus(status, errMsg);
+            lastError = QString(errMsg);
+            fits_report_error(stderr, status);
+            return false;
+        }
     }
 
     // NAXIS1
@@ -4194,165 +4521,49 @@ bool FITSData::contains(const QPointF &point) const
 
 int FITSData::findSEPStars(const QRect &boundary)
 {
-    int x = 0, y = 0, w = stats.width, h = stats.height, maxRadius = 50;
+    int const maxRadius = boundary.isNull() ? 50 : boundary.width();
 
-    if (!boundary.isNull())
-    {
-        x = boundary.x();
-        y = boundary.y();
-        w = boundary.width();
-        h = boundary.height();
-        maxRadius = w;
-    }
-
-    auto * data = new float[w * h];
-
-    switch (stats.bitpix)
-    {
-        case BYTE_IMG:
-            getFloatBuffer<uint8_t>(data, x, y, w, h);
-            break;
-        case SHORT_IMG:
-            getFloatBuffer<int16_t>(data, x, y, w, h);
-            break;
-        case USHORT_IMG:
-            getFloatBuffer<uint16_t>(data, x, y, w, h);
-            break;
-        case LONG_IMG:
-            getFloatBuffer<int32_t>(data, x, y, w, h);
-            break;
-        case ULONG_IMG:
-            getFloatBuffer<uint32_t>(data, x, y, w, h);
-            break;
-        case FLOAT_IMG:
-            delete [] data;
-            data = reinterpret_cast<float *>(m_ImageBuffer);
-            break;
-        case LONGLONG_IMG:
-            getFloatBuffer<int64_t>(data, x, y, w, h);
-            break;
-        case DOUBLE_IMG:
-            getFloatBuffer<double>(data, x, y, w, h);
-            break;
-        default:
-            delete [] data;
-            return -1;
-    }
-
-    float * imback = nullptr;
-    double * flux = nullptr, *fluxerr = nullptr, *area = nullptr;
-    short * flag = nullptr;
-    short flux_flag = 0;
-    int status = 0;
-    sep_bkg * bkg = nullptr;
-    sep_catalog * catalog = nullptr;
-    float conv[] = {1, 2, 1, 2, 4, 2, 1, 2, 1};
-    double flux_fractions[2] = {0};
-    double requested_frac[2] = { 0.5, 0.99 };
-    QList<Edge *> edges;
-
-    // #0 Create SEP Image structure
-    sep_image im = {data, nullptr, nullptr, SEP_TFLOAT, 0, 0, w, h, 0.0, SEP_NOISE_NONE, 1.0, 0.0};
-
-    // #1 Background estimate
-    status = sep_background(&im, 64, 64, 3, 3, 0.0, &bkg);
-    if (status != 0) goto exit;
-
-    // #2 Background evaluation
-    imback = (float *)malloc((w * h) * sizeof(float));
-    status = sep_bkg_array(bkg, imback, SEP_TFLOAT);
-    if (status != 0) goto exit;
-
-    // #3 Background subtraction
-    status = sep_bkg_subarray(bkg, im.data, im.dtype);
-    if (status != 0) goto exit;
-
-    // #4 Source Extraction
-    // Note that we set deblend_cont = 1.0 to turn off deblending.
-    status = sep_extract(&im, 2 * bkg->globalrms, SEP_THRESH_ABS, 10, conv, 3, 3, SEP_FILTER_CONV, 32, 1.0, 1, 1.0, &catalog);
-    if (status != 0) goto exit;
+    bool ok = false;
+    FITSStarDetector::StarList const stars = FITSStarDetector::findStars(m_ImageBuffer, stats.bitpix, stats.width,
+            stats.height, boundary, maxRadius, &ok);
+    if (!ok)
+        return -1;
 
     // TODO
     // Must detect edge detection
     // Must limit to brightest 100 (by flux) centers
     // Should probably use ellipse to draw instead of simple circle?
     // Useful for galaxies and also elenogated stars.
-    for (int i = 0; i < catalog->nobj; i++)
-    {
-        double flux = catalog->flux[i];
-        // Get HFR
-        sep_flux_radius(&im, catalog->x[i], catalog->y[i], maxRadius, 5, 0, &flux, requested_frac, 2, flux_fractions, &flux_flag);
-
-        auto * center = new Edge();
-        center->x = catalog->x[i] + x + 0.5;
-        center->y = catalog->y[i] + y + 0.5;
-        center->val = catalog->peak[i];
-        center->sum = flux;
-        center->HFR = center->width = flux_fractions[0];
-        if (flux_fractions[1] < maxRadius)
-            center->width = flux_fractions[1] * 2;
-        edges.append(center);
-    }
 
-    // Let's sort edges, starting with widest
-    std::sort(edges.begin(), edges.end(), [](const Edge * edge1, const Edge * edge2) -> bool { return edge1->width > edge2->width;});
+    // Let's sort stars, starting with widest
+    QVector<int> order(stars.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&stars](int s1, int s2) -> bool { return stars.width[s1] > stars.width[s2];});
 
     // Take only the first 100 stars
+    int const starCount = qMin(100, order.count());
+    for (int i = 0; i < starCount; i++)
     {
-        int starCount = qMin(100, edges.count());
-        for (int i = 0; i < starCount; i++)
-            starCenters.append(edges[i]);
-    }
+        int const s = order[i];
 
-    edges.clear();
+        auto * center = new Edge();
+        center->x = stars.x[s];
+        center->y = stars.y[s];
+        center->val = stars.peak[s];
+        center->sum = stars.flux[s];
+        center->HFR = stars.HFR[s];
+        center->width = stars.width[s];
+        starCenters.append(center);
+    }
 
     qCDebug(KSTARS_FITS) << qSetFieldWidth(10) << "#" << "#X" << "#Y" << "#Flux" << "#Width" << "#HFR";
     for (int i = 0; i < starCenters.count(); i++)
         qCDebug(KSTARS_FITS) << qSetFieldWidth(10) << i << starCenters[i]->x << starCenters[i]->y
                              << starCenters[i]->sum << starCenters[i]->width << starCenters[i]->HFR;
 
-exit:
-    if (stats.bitpix != FLOAT_IMG)
-        delete [] data;
-    sep_bkg_free(bkg);
-    sep_catalog_free(catalog);
-    free(imback);
-    free(flux);
-    free(fluxerr);
-    free(area);
-    free(flag);
-
-    if (status != 0)
-    {
-        char errorMessage[512];
-        sep_get_errmsg(status, errorMessage);
-        qCritical(KSTARS_FITS) << errorMessage;
-        return -1;
-    }
-
     return starCenters.count();
 }
 
-template <typename T>
-void FITSData::getFloatBuffer(float * buffer, int x, int y, int w, int h)
-{
-    auto * rawBuffer = reinterpret_cast<T *>(m_ImageBuffer);
-
-    float * floatPtr = buffer;
-
-    int x2 = x + w;
-    int y2 = y + h;
-
-    for (int y1 = y; y1 < y2; y1++)
-    {
-        int offset = y1 * stats.width;
-        for (int x1 = x; x1 < x2; x1++)
-        {
-            *floatPtr++ = rawBuffer[offset + x1];
-        }
-    }
-}
-
 void FITSData::saveStatistics(Statistic &other)
 {
     other = stats;
@@ -31,10 +31,12 @@
 
 #include <fitsio.h>
 
+#include <QElapsedTimer>
 #include <QFuture>
 #include <QObject>
 #include <QRect>
 #include <QVariant>
+#include <QVector>
 
 #ifndef KSTARS_LITE
 #include <kxmlguiwindow.h>
@@ -45,6 +47,8 @@
 
 #define MINIMUM_PIXEL_RANGE 5
 #define MINIMUM_STDVAR      5
+// Spacing in pixels of the coarse WCS interpolation grid
+#define WCS_GRID_STEP       32
 
 class QProgressDialog;
 
@@ -162,10 +166,56 @@ class FITSData : public QObject
                                 size_t fits_buffer_size, bool silent);
         /* Save FITS */
         int saveFITS(const QString &newFilename);
+        /**
+         * @brief ensureFileOnDisk Write a frame loaded from memory to its file name, if it is not on disk yet.
+         * The frame is written as it was received, with the header records updated since.
+         * @return true if filename() refers to a file on disk.
+         */
+        bool ensureFileOnDisk();
+        /**
+         * @brief saveXYList Extract the stars of the image and save the brightest ones as an XY list, a FITS binary
+         * table that astrometry.net solves instead of the image.
+         * @param newFilename file name of the XY list, overwritten if it exists.
+         * @param maxStars maximum number of stars to save, by decreasing flux.
+         * @return number of stars saved, or -1 on failure.
+         */
+        int saveXYList(const QString &newFilename, int maxStars);
         /* Rescale image lineary from image_buffer, fit to window if desired */
         int rescale(FITSZoom type);
         /* Calculate stats */
         void calculateStats(bool refresh = false);
+        /**
+         * @brief setStatisticsRegion Restrict the statistics to a region of the image, such as the search region of a
+         * guide star, so that they cost little on large frames. They cover the whole image if the region is empty.
+         * @param region region in image coordinates, set before loading the image.
+         */
+        void setStatisticsRegion(const QRect &region)
+        {
+            m_StatisticsRegion = region;
+        }
+        /** @return true if the statistics cover the whole image, and not a region set with setStatisticsRegion(). */
+        bool hasFullStatistics() const
+        {
+            QRect const image(0, 0, stats.width, stats.height);
+            return m_StatisticsRegion.intersected(image).isEmpty() || m_StatisticsRegion.contains(image);
+        }
+        /**
+         * @brief setExposureEnd Measure the age of the frame from the end of its exposure.
+         * @param exposureEnd timer started when the exposure ended, ignored if invalid.
+         */
+        void setExposureEnd(const QElapsedTimer &exposureEnd)
+        {
+            if (exposureEnd.isValid())
+                m_Age = exposureEnd;
+        }
+        /**
+         * @return milliseconds since the end of the exposure of the frame if known, or else since this object was
+         * created, that is since the frame was received for a BLOB.
+         */
+        qint64 getAge() const
+        {
+            return m_Age.elapsed();
+        }
         /* Check if a particular point exists within the image */
         bool contains(const QPointF &point) const;
 
@@ -257,6 +307,14 @@ class FITSData : public QObject
 
         // FITS Record
         bool getRecordValue(const QString &key, QVariant &value) const;
+        /**
+         * @brief updateRecordValue Add or update a header record.
+         * @param key FITS keyword.
+         * @param value Integer, double or string value.
+         * @param comment Keyword comment.
+         * @return true if the header was updated.
+         */
+        bool updateRecordValue(const QString &key, const QVariant &value, const QString &comment);
         const QList<Record*> &getRecords() const
         {
             return records;
@@ -296,8 +354,6 @@ class FITSData : public QObject
         static int findCannyStar(FITSData *data, const QRect &boundary);
 
         // Use SEP (Sextractor Library) to find stars
-        template <typename T>
-        void getFloatBuffer(float *buffer, int x, int y, int w, int h);
         int findSEPStars(const QRect &boundary = QRect());
 
         // Apply ring filter to searched stars
@@ -327,10 +383,22 @@ class FITSData : public QObject
             return WCSLoaded;
         }
 
-        wcs_point *getWCSCoord()
-        {
-            return wcs_coord;
-        }
+        /**
+             * @brief getWCSCoord Get J2000 world coordinates of a pixel, interpolated from the coarse WCS grid.
+             * This is cheap enough to be called for each mouse move. Use pixelToWCS for exact coordinates.
+             * @param wcsPixelPoint Pixel coordinates in XY Image space.
+             * @param coord Store back WCS world coordinates, in degrees.
+             * @return True if WCS data is loaded and the pixel is in the image, false otherwise.
+             */
+        bool getWCSCoord(const QPointF &wcsPixelPoint, wcs_point &coord) const;
+
+        /**
+             * @brief getWCSBounds Get the range of J2000 world coordinates covered by the image.
+             * @param minRA, maxRA Store back the range of right ascension, in degrees.
+             * @param minDec, maxDec Store back the range of declination, in degrees.
+             * @return True if WCS data is loaded, false otherwise.
+             */
+        bool getWCSBounds(double &minRA, double &maxRA, double &minDec, double &maxDec) const;
 
         /**
              * @brief wcsToPixel Given J2000 (RA0,DE0) coordinates. Find in the image the corresponding pixel coordinates.
@@ -442,9 +510,14 @@ class FITSData : public QObject
     private:
         void loadCommon(const QString &inFilename);
         bool privateLoad(void *fits_buffer, size_t fits_buffer_size, bool silent);
+        // Move a file opened on a caller memory buffer to a private in-memory file, so the buffer can be released.
+        bool detachMemoryFile();
+        // Free the private in-memory file, once its FITS file pointer is closed.
+        void releaseMemoryFile();
+        // Write a header record to the current HDU of a file, returns the cfitsio status.
+        static int writeRecord(fitsfile *file, const Record &record, int *status);
         void rotWCSFITS(int angle, int mirror);
         bool checkCollision(Edge *s1, Edge *s2);
-        int calculateMinMax(bool refresh = false);
         bool checkDebayer();
         void readWCSKeys();
 
@@ -471,17 +544,25 @@ class FITSData : public QObject
         template <typename T>
         int findOneStar(const QRect &boundary);
 
+        /// Partial statistics over a partition of a channel, merged by calculateStatistics()
+        typedef struct
+        {
+            double min { 0 }, max { 0 };
+            double mean { 0 };
+            /// Sum of squared deviations from the mean
+            double squaredDeviation { 0 };
+            uint32_t count { 0 };
+            /// Histogram of all values, for types up to 16 bits
+            QVector<uint32_t> histogram;
+            /// Subsample of values, for larger types
+            QVector<double> samples;
+        } PartitionStatistics;
+
+        /* Calculate min, max, mean, standard deviation and median of all channels in a single parallel sweep */
         template <typename T>
-        void calculateMinMax();
-
-        template <typename T>
-        QPair<T, T> getParitionMinMax(uint32_t start, uint32_t stride);
-
-        /* Calculate running average & standard deviation using Welford’s method for computing variance */
-        template <typename T>
-        void runningAverageStdDev();
+        void calculateStatistics();
         template <typename T>
-        QPair<double, double> getSquaredSumAndMean(uint32_t start, uint32_t stride);
+        PartitionStatistics getPartitionStatistics(const T *buffer, uint32_t stride, uint32_t sampleBy);
 
         // Sobel detector by Gonzalo Exequiel Pedone
         template <typename T>
@@ -499,6 +580,14 @@ class FITSData : public QObject
 #endif
         /// Pointer to CFITSIO FITS file struct
         fitsfile *fptr { nullptr };
+        /// Private in-memory FITS file of frames loaded from memory, holding their header, and raw data if debayered
+        void *m_MemoryFile { nullptr };
+        /// Above buffer size in bytes
+        size_t m_MemoryFileSize { 0 };
+        /// Frame loaded from memory, as received, written out when a file is needed
+        QByteArray m_ReceivedFrame;
+        /// Header records updated since the frame was received
+        QList<Record> m_UpdatedRecords;
 
         /// FITS image data type (TBYTE, TUSHORT, TINT, TFLOAT, TLONG, TDOUBLE)
         uint32_t m_DataType { 0 };
@@ -537,8 +626,10 @@ class FITSData : public QObject
         /// How many times the image was flipped vertically?
         int flipVCounter { 0 };
 
-        /// Pointer to WCS coordinate data, if any.
-        wcs_point *wcs_coord { nullptr };
+        /// Coarse WCS coordinate grid, sampled every WCS_GRID_STEP pixels and on the last row and column.
+        QVector<wcs_point> wcsGrid;
+        /// Number of columns and rows of the WCS coordinate grid.
+        int wcsGridWidth { 0 }, wcsGridHeight { 0 };
         /// WCS Struct
         struct wcsprm *m_wcs
         {
@@ -556,6 +647,10 @@ class FITSData : public QObject
         BayerParams debayerParams;
 
         Statistic stats;
+        /// Region the statistics are restricted to, or the whole image if empty
+        QRect m_StatisticsRegion;
+        /// Started at the end of the exposure, or on creation, to measure the latency of frames
+        QElapsedTimer m_Age;
 
         // A list of header records
         QList<Record*> records;
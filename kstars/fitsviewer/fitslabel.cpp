@@ -154,17 +154,12 @@ void FITSLabel::mouseMoveEvent(QMouseEvent *e)
 
     if (view_data->hasWCS() && view->getCursorMode() != FITSView::selectCursor)
     {
-        int index = x + y * width;
+        wcs_point wcs_coord;
 
-        wcs_point *wcs_coord = view_data->getWCSCoord();
-
-        if (wcs_coord)
+        if (view_data->getWCSCoord(QPointF(x, y), wcs_coord))
         {
-            if (index > size)
-                return;
-
-            ra.setD(wcs_coord[index].ra);
-            dec.setD(wcs_coord[index].dec);
+            ra.setD(wcs_coord.ra);
+            dec.setD(wcs_coord.dec);
 
             emit newStatus(QString("%1 , %2").arg(ra.toHMSString(), dec.toDMSString()), FITS_WCS);
         }
@@ -218,24 +213,25 @@ void FITSLabel::mousePressEvent(QMouseEvent *e)
         FITSData *view_data = view->getImageData();
         if (view_data->hasWCS())
         {
-            wcs_point *wcs_coord = view_data->getWCSCoord();
-            if (wcs_coord)
-            {
-                double x, y;
-                x = round(e->x() / scale);
-                y = round(e->y() / scale);
+            double x, y;
+            x = round(e->x() / scale);
+            y = round(e->y() / scale);
 
-                x         = KSUtils::clamp(x, 1.0, width);
-                y         = KSUtils::clamp(y, 1.0, height);
-                int index = x + y * width;
+            x = KSUtils::clamp(x, 1.0, width);
+            y = KSUtils::clamp(y, 1.0, height);
+
+            // Slew to exact coordinates, not the interpolated ones displayed while hovering
+            SkyPoint wcs_coord;
+            if (view_data->pixelToWCS(QPointF(x, y), wcs_coord))
+            {
                 if (KMessageBox::Continue == KMessageBox::warningContinueCancel(
                             nullptr,
-                            "Slewing to Coordinates: \nRA: " + dms(wcs_coord[index].ra).toHMSString() +
-                            "\nDec: " + dms(wcs_coord[index].dec).toDMSString(),
+                            "Slewing to Coordinates: \nRA: " + wcs_coord.ra0().toHMSString() +
+                            "\nDec: " + wcs_coord.dec0().toDMSString(),
                             i18n("Continue Slew"), KStandardGuiItem::cont(),
                             KStandardGuiItem::cancel(), "continue_slew_warning"))
                 {
-                    centerTelescope(wcs_coord[index].ra / 15.0, wcs_coord[index].dec);
+                    centerTelescope(wcs_coord.ra0().Hours(), wcs_coord.dec0().Degrees());
                     view->setCursorMode(view->lastMouseMode);
                     view->updateScopeButton();
                 }
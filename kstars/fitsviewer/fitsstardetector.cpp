@@ -0,0 +1,231 @@
+/*  FITS Star Detector
+    Copyright (C) 2026 agent <agent@local>
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+*/
+
+#include "fitsstardetector.h"
+
+#include "sep/sep.h"
+
+#include <QtConcurrent>
+
+#include <fitsio.h>
+
+#include <algorithm>
+#include <cmath>
+
+#include <fits_debug.h>
+
+void FITSStarDetector::StarList::append(const StarList &other)
+{
+    x += other.x;
+    y += other.y;
+    flux += other.flux;
+    peak += other.peak;
+    HFR += other.HFR;
+    width += other.width;
+    a += other.a;
+    b += other.b;
+    theta += other.theta;
+}
+
+void FITSStarDetector::StarList::remove(int index)
+{
+    x.remove(index);
+    y.remove(index);
+    flux.remove(index);
+    peak.remove(index);
+    HFR.remove(index);
+    width.remove(index);
+    a.remove(index);
+    b.remove(index);
+    theta.remove(index);
+}
+
+FITSStarDetector::StarList FITSStarDetector::findStars(const uint8_t *buffer, int bitpix, int width, int height,
+        const QRect &boundary, int maxRadius, bool *ok)
+{
+    QRect const image(0, 0, width, height);
+    QRect const region = boundary.isNull() ? image : boundary.intersected(image);
+
+    bool result = false;
+    StarList stars;
+
+    if (buffer != nullptr && region.isEmpty() == false)
+    {
+        switch (bitpix)
+        {
+            case BYTE_IMG:
+                stars = findStars(reinterpret_cast<const uint8_t *>(buffer), width, region, maxRadius, &result);
+                break;
+            case SHORT_IMG:
+                stars = findStars(reinterpret_cast<const int16_t *>(buffer), width, region, maxRadius, &result);
+                break;
+            case USHORT_IMG:
+                stars = findStars(reinterpret_cast<const uint16_t *>(buffer), width, region, maxRadius, &result);
+                break;
+            case LONG_IMG:
+                stars = findStars(reinterpret_cast<const int32_t *>(buffer), width, region, maxRadius, &result);
+                break;
+            case ULONG_IMG:
+                stars = findStars(reinterpret_cast<const uint32_t *>(buffer), width, region, maxRadius, &result);
+                break;
+            case FLOAT_IMG:
+                stars = findStars(reinterpret_cast<const float *>(buffer), width, region, maxRadius, &result);
+                break;
+            case LONGLONG_IMG:
+                stars = findStars(reinterpret_cast<const int64_t *>(buffer), width, region, maxRadius, &result);
+                break;
+            case DOUBLE_IMG:
+                stars = findStars(reinterpret_cast<const double *>(buffer), width, region, maxRadius, &result);
+                break;
+            default:
+                break;
+        }
+    }
+
+    if (ok)
+        *ok = result;
+
+    return stars;
+}
+
+template <typename T>
+FITSStarDetector::StarList FITSStarDetector::findStars(const T *buffer, int width, const QRect &region, int maxRadius,
+        bool *ok)
+{
+    // Split the region in tiles of at least TILE_SIZE pixels, so that small regions end up in a single tile
+    int const columns = std::max(1, region.width() / TILE_SIZE);
+    int const rows = std::max(1, region.height() / TILE_SIZE);
+
+    QVector<QRect> cores, tiles;
+    for (int j = 0; j < rows; j++)
+    {
+        int const top = region.y() + j * region.height() / rows;
+        int const bottom = region.y() + (j + 1) * region.height() / rows;
+
+        for (int i = 0; i < columns; i++)
+        {
+            int const left = region.x() + i * region.width() / columns;
+            int const right = region.x() + (i + 1) * region.width() / columns;
+
+            QRect const core(QPoint(left, top), QPoint(right - 1, bottom - 1));
+            cores.append(core);
+            tiles.append(core.adjusted(-maxRadius, -maxRadius, maxRadius, maxRadius).intersected(region));
+        }
+    }
+
+    QVector<bool> results(tiles.size(), false);
+    StarList stars;
+
+    if (tiles.size() == 1)
+    {
+        stars = findTileStars(buffer, width, tiles[0], cores[0], maxRadius, &results[0]);
+    }
+    else
+    {
+        QList<QFuture<StarList>> futures;
+        for (int i = 0; i < tiles.size(); i++)
+        {
+            QRect const tile = tiles[i], core = cores[i];
+            bool *result = &results[i];
+            futures.append(QtConcurrent::run([ = ]()
+            {
+                return findTileStars(buffer, width, tile, core, maxRadius, result);
+            }));
+        }
+
+        for (QFuture<StarList> &future : futures)
+            stars.append(future.result());
+    }
+
+    *ok = std::all_of(results.constBegin(), results.constEnd(), [](bool result)
+    {
+        return result;
+    });
+
+    return stars;
+}
+
+template <typename T>
+FITSStarDetector::StarList FITSStarDetector::findTileStars(const T *buffer, int width, const QRect &tile,
+        const QRect &core, int maxRadius, bool *ok)
+{
+    int const w = tile.width(), h = tile.height();
+    StarList stars;
+
+    // SEP works in place, so work on a float copy of the tile
+    QVector<float> data(w * h);
+    float *floatPtr = data.data();
+    for (int y = tile.top(); y <= tile.bottom(); y++)
+    {
+        T const *rawPtr = buffer + static_cast<size_t>(y) * width + tile.left();
+        for (int x = 0; x < w; x++)
+            *floatPtr++ = rawPtr[x];
+    }
+
+    short flux_flag = 0;
+    int status = 0;
+    sep_bkg *bkg = nullptr;
+    sep_catalog *catalog = nullptr;
+    float conv[] = {1, 2, 1, 2, 4, 2, 1, 2, 1};
+    double flux_fractions[2] = {0};
+    double requested_frac[2] = { 0.5, 0.99 };
+
+    // #0 Create SEP Image structure
+    sep_image im = {data.data(), nullptr, nullptr, SEP_TFLOAT, 0, 0, w, h, 0.0, SEP_NOISE_NONE, 1.0, 0.0};
+
+    // #1 Background estimate
+    status = sep_background(&im, 64, 64, 3, 3, 0.0, &bkg);
+    if (status != 0) goto exit;
+
+    // #2 Background subtraction
+    status = sep_bkg_subarray(bkg, im.data, im.dtype);
+    if (status != 0) goto exit;
+
+    // #3 Source Extraction
+    // Note that we set deblend_cont = 1.0 to turn off deblending.
+    status = sep_extract(&im, 2 * bkg->globalrms, SEP_THRESH_ABS, 10, conv, 3, 3, SEP_FILTER_CONV, 32, 1.0, 1, 1.0, &catalog);
+    if (status != 0) goto exit;
+
+    for (int i = 0; i < catalog->nobj; i++)
+    {
+        // Stars centered in the overlap with another tile are kept by that tile
+        int const px = static_cast<int>(std::floor(catalog->x[i] + 0.5)) + tile.left();
+        int const py = static_cast<int>(std::floor(catalog->y[i] + 0.5)) + tile.top();
+        if (core.contains(px, py) == false)
+            continue;
+
+        double flux = catalog->flux[i];
+        // Get HFR
+        sep_flux_radius(&im, catalog->x[i], catalog->y[i], maxRadius, 5, 0, &flux, requested_frac, 2, flux_fractions, &flux_flag);
+
+        stars.x.append(catalog->x[i] + tile.left() + 0.5);
+        stars.y.append(catalog->y[i] + tile.top() + 0.5);
+        stars.flux.append(flux);
+        stars.peak.append(catalog->peak[i]);
+        stars.HFR.append(flux_fractions[0]);
+        stars.width.append(flux_fractions[1] < maxRadius ? flux_fractions[1] * 2 : flux_fractions[0]);
+        stars.a.append(catalog->a[i]);
+        stars.b.append(catalog->b[i]);
+        stars.theta.append(catalog->theta[i]);
+    }
+
+exit:
+    sep_bkg_free(bkg);
+    sep_catalog_free(catalog);
+
+    if (status != 0)
+    {
+        char errorMessage[512];
+        sep_get_errmsg(status, errorMessage);
+        qCritical(KSTARS_FITS) << errorMessage;
+    }
+
+    *ok = (status == 0);
+    return stars;
+}
@@ -0,0 +1,84 @@
+/*  FITS Star Detector
+    Copyright (C) 2026 agent <agent@local>
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+*/
+
+#pragma once
+
+#include <QRect>
+#include <QVector>
+
+#include <cstdint>
+
+/**
+ * @class FITSStarDetector
+ * @short Multi-threaded star extraction with SEP, shared by all star detection users.
+ *
+ * The search region is split into tiles that are processed in parallel. Each tile is converted to float, its
+ * background is estimated and subtracted, and its sources are extracted and measured with SEP. Tiles overlap
+ * by the maximum star radius so that stars close to a tile border are measured in full. A star is kept only
+ * by the tile whose core holds its center, which removes duplicates found in overlapping areas.
+ *
+ * Small regions, such as guide tracking boxes, are processed as a single tile.
+ *
+ * @version 1.0
+ */
+class FITSStarDetector
+{
+    public:
+        /** @brief Detected stars, stored by property for compactness. Coordinates are in image pixels. */
+        class StarList
+        {
+            public:
+                QVector<float> x;
+                QVector<float> y;
+                /** Total flux, background subtracted */
+                QVector<float> flux;
+                /** Peak value, background subtracted */
+                QVector<float> peak;
+                /** Half flux radius */
+                QVector<float> HFR;
+                /** Diameter enclosing most of the flux */
+                QVector<float> width;
+                /** Semi-major and semi-minor axes, and position angle in radians */
+                QVector<float> a;
+                QVector<float> b;
+                QVector<float> theta;
+
+                int size() const
+                {
+                    return x.size();
+                }
+                void append(const StarList &other);
+                void remove(int index);
+        };
+
+        /** @brief Side of the core of a tile, in pixels. */
+        static constexpr int TILE_SIZE = 1024;
+
+        /**
+         * @brief findStars Extract stars from an image channel.
+         * @param buffer image data, of the type matching the argument bitpix.
+         * @param bitpix FITS data type of the image.
+         * @param width width of the image in pixels.
+         * @param height height of the image in pixels.
+         * @param boundary region to search, or the full image if null.
+         * @param maxRadius largest star radius considered when measuring stars, in pixels.
+         * @param ok set to false if the extraction failed (optional).
+         * @return detected stars, in no particular order.
+         */
+        static StarList findStars(const uint8_t *buffer, int bitpix, int width, int height, const QRect &boundary,
+                                  int maxRadius, bool *ok = nullptr);
+
+    private:
+        template <typename T>
+        static StarList findStars(const T *buffer, int width, const QRect &region, int maxRadius, bool *ok);
+
+        template <typename T>
+        static StarList findTileStars(const T *buffer, int width, const QRect &tile, const QRect &core, int maxRadius,
+                                      bool *ok);
+};
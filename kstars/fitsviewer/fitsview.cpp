@@ -69,6 +69,18 @@ void ComputeGBStretchParams(const StretchParams &newParams, StretchParams* param
     params->blue.midtones = std::max(params->blue.midtones, 0.0f);
 }
 
+// Auto-stretch parameters only depend on the distribution of the samples,
+// so the frame and its statistics identify them.
+QVector<double> StretchParamsKey(FITSData *data)
+{
+    QVector<double> key;
+    key << static_cast<double>(reinterpret_cast<quintptr>(data)) << data->width() << data->height() << data->channels();
+    for (int channel = 0; channel < data->channels(); ++channel)
+        key << data->getMin(channel) << data->getMax(channel) << data->getMean(channel) << data->getStdDev(channel)
+            << data->getMedian(channel);
+    return key;
+}
+
 }  // namespace
 
 // Runs the stretch checking the variables to see which parameters to use.
@@ -88,8 +100,13 @@ void FITSView::doStretch(FITSData *data, QImage *outputImage)
         tempParams = StretchParams();  // Keeping it linear
     else if (autoStretch)
     {
-        // Compute new auto-stretch params.
-        stretchParams = stretch.computeParams(data->getImageBuffer());
+        // Compute new auto-stretch params, unless they were already computed for this frame.
+        const QVector<double> key = StretchParamsKey(data);
+        if (key != autoStretchParamsKey)
+        {
+            stretchParams = stretch.computeParams(data->getImageBuffer());
+            autoStretchParamsKey = key;
+        }
         tempParams = stretchParams;
     }
     else
@@ -100,6 +117,38 @@ void FITSView::doStretch(FITSData *data, QImage *outputImage)
     stretch.run(data->getImageBuffer(), outputImage, sampling);
 }
 
+QImage FITSView::getSubframeImage(const QRect &region)
+{
+    QRect const subframe = region.intersected(QRect(0, 0, imageData->width(), imageData->height()));
+    if (subframe.isEmpty())
+        return QImage();
+
+    // Copy the rows of the first channel, the stretch works on contiguous data
+    int const bytesPerPixel = imageData->getBytesPerPixel();
+    int const rowSize = subframe.width() * bytesPerPixel;
+    QVector<uint8_t> buffer(rowSize * subframe.height());
+    for (int y = 0; y < subframe.height(); y++)
+        memcpy(buffer.data() + y * rowSize,
+               imageData->getImageBuffer() + ((subframe.y() + y) * imageData->width() + subframe.x()) * bytesPerPixel,
+               rowSize);
+
+    QImage image(subframe.width(), subframe.height(), QImage::Format_Indexed8);
+    image.setColorCount(256);
+    for (int i = 0; i < 256; i++)
+        image.setColor(i, qRgb(i, i, i));
+
+    Stretch stretch(subframe.width(), subframe.height(), 1, imageData->property("dataType").toInt());
+    if (!stretchImage)
+        stretch.setParams(StretchParams());
+    else if (autoStretch)
+        stretch.setParams(stretch.computeParams(buffer.data()));
+    else
+        stretch.setParams(stretchParams);
+    stretch.run(buffer.data(), &image);
+
+    return image;
+}
+
 // Store stretch parameters, and turn on stretching if it isn't already on.
 void FITSView::setStretchParams(const StretchParams &params)
 {
@@ -113,6 +162,8 @@ void FITSView::setStretchParams(const StretchParams &params)
 
     autoStretch = false;
     stretchImage = true;
+    // The stored params are no longer the automatic ones
+    autoStretchParamsKey.clear();
 
     if (image_frame != nullptr && rescale(ZOOM_KEEP_LEVEL))
         updateFrame();
@@ -255,6 +306,14 @@ void FITSView::resizeEvent(QResizeEvent * event)
     QScrollArea::resizeEvent(event);
 }
 
+void FITSView::showEvent(QShowEvent * event)
+{
+    QScrollArea::showEvent(event);
+
+    if (pendingDisplay && imageData != nullptr)
+        displayData();
+}
+
 
 void FITSView::loadFITS(const QString &inFilename, bool silent)
 {
@@ -340,6 +399,23 @@ bool FITSView::processData()
 
     imageData->applyFilter(filter);
 
+    // The guider works on the image data, so hidden guide frames are only rendered once shown
+    if (mode == FITS_GUIDE && !isVisible())
+    {
+        pendingDisplay = true;
+        return true;
+    }
+
+    return displayData();
+}
+
+bool FITSView::displayData()
+{
+    pendingDisplay = false;
+
+    int image_width  = imageData->width();
+    int image_height = imageData->height();
+
     // Rescale to fits window on first load
     if (firstLoad)
     {
@@ -638,6 +714,9 @@ void FITSView::updateFrame()
 {
     bool ok = false;
 
+    if (pendingDisplay)
+        return;
+
     if (toggleStretchAction)
         toggleStretchAction->setChecked(stretchImage);
 
@@ -939,28 +1018,9 @@ void FITSView::drawEQGrid(QPainter * painter)
 
     if (imageData->hasWCS())
     {
-        wcs_point * wcs_coord = imageData->getWCSCoord();
-        if (wcs_coord != nullptr)
+        double maxRA, minRA, maxDec, minDec;
+        if (imageData->getWCSBounds(minRA, maxRA, minDec, maxDec))
         {
-            int size      = image_width * image_height;
-            double maxRA  = -1000;
-            double minRA  = 1000;
-            double maxDec = -1000;
-            double minDec = 1000;
-
-            for (int i = 0; i < (size); i++)
-            {
-                double ra  = wcs_coord[i].ra;
-                double dec = wcs_coord[i].dec;
-                if (ra > maxRA)
-                    maxRA = ra;
-                if (ra < minRA)
-                    minRA = ra;
-                if (dec > maxDec)
-                    maxDec = dec;
-                if (dec < minDec)
-                    minDec = dec;
-            }
             auto minDecMinutes = (int)(minDec * 12); //This will force the Dec Scale to 5 arc minutes in the loop
             auto maxDecMinutes = (int)(maxDec * 12);
 
@@ -1209,6 +1269,12 @@ QPixmap &FITSView::getTrackingBoxPixmap(uint8_t margin)
     if (trackingBox.isNull())
         return trackingBoxPixmap;
 
+    if (pendingDisplay)
+    {
+        trackingBoxPixmap = QPixmap::fromImage(getSubframeImage(trackingBox.adjusted(-margin, -margin, margin, margin)));
+        return trackingBoxPixmap;
+    }
+
     int x1 = (trackingBox.x() - margin) * (currentZoom / ZOOM_DEFAULT);
     int y1 = (trackingBox.y() - margin) * (currentZoom / ZOOM_DEFAULT);
     int w  = (trackingBox.width() + margin * 2) * (currentZoom / ZOOM_DEFAULT);
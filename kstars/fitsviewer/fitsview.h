@@ -24,6 +24,7 @@
 #include <QScrollArea>
 #include <QStack>
 #include <QPointer>
+#include <QVector>
 
 #ifdef WIN32
 // avoid compiler warning when windows.h is included after fitsio.h
@@ -44,6 +45,7 @@ class QImage;
 class QLabel;
 class QPinchGesture;
 class QResizeEvent;
+class QShowEvent;
 class QToolBar;
 
 class FITSData;
@@ -229,6 +231,7 @@ class FITSView : public QScrollArea
     public slots:
         void wheelEvent(QWheelEvent *event) override;
         void resizeEvent(QResizeEvent *event) override;
+        void showEvent(QShowEvent *event) override;
         void ZoomIn();
         void ZoomOut();
         void ZoomDefault();
@@ -291,7 +294,11 @@ class FITSView : public QScrollArea
 
     private:
         bool processData();
+        /** @brief displayData Stretch, scale and draw the loaded image with its overlays. */
+        bool displayData();
         void doStretch(FITSData *data, QImage *outputImage);
+        /** @brief getSubframeImage Stretch a region of the image alone, without rendering the frame. */
+        QImage getSubframeImage(const QRect &region);
 
         QLabel *noImageLabel { nullptr };
         QPixmap noImage;
@@ -317,6 +324,8 @@ class FITSView : public QScrollArea
         QPixmap displayPixmap;
 
         bool firstLoad { true };
+        // The loaded image is waiting to be displayed until the view is shown
+        bool pendingDisplay { false };
         bool markStars { false };
         bool showStarProfile { false };
         bool showCrosshair { false };
@@ -337,6 +346,9 @@ class FITSView : public QScrollArea
         // Params for stretching image.
         StretchParams stretchParams;
 
+        // Identifies the frame the auto-stretch params were computed for, so that redraws reuse them.
+        QVector<double> autoStretchParamsKey;
+
         // Resolution for display. Sampling=2 means display every other sample.
         int sampling { 1 };
 
@@ -41,8 +41,8 @@ int belong(int, objliststruct *, int, objliststruct *);
 int *createsubmap(objliststruct *, int, int *, int *, int *, int *);
 int gatherup(objliststruct *, objliststruct *);
 
-static objliststruct *objlist=NULL;
-static short	     *son=NULL, *ok=NULL;
+static SEP_THREAD_LOCAL objliststruct *objlist=NULL;
+static SEP_THREAD_LOCAL short	     *son=NULL, *ok=NULL;
 
 /******************************** deblend ************************************/
 /*
@@ -35,9 +35,9 @@
 			             /* thresholding filtered weight-maps */
 
 /* globals */
-int plistexist_cdvalue, plistexist_thresh, plistexist_var;
-int plistoff_value, plistoff_cdvalue, plistoff_thresh, plistoff_var;
-int plistsize;
+SEP_THREAD_LOCAL int plistexist_cdvalue, plistexist_thresh, plistexist_var;
+SEP_THREAD_LOCAL int plistoff_value, plistoff_cdvalue, plistoff_thresh, plistoff_var;
+SEP_THREAD_LOCAL int plistsize;
 size_t extract_pixstack = 300000;
 
 /* get and set pixstack */
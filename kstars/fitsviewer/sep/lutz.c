@@ -36,11 +36,11 @@ void lutzsort(infostruct *, objliststruct *);
 
 /*------------------------- Static buffers for lutz() -----------------------*/
 
-static infostruct  *info=NULL, *store=NULL;
-static char	   *marker=NULL;
-static pixstatus   *psstack=NULL;
-static int         *start=NULL, *end=NULL, *discan=NULL;
-static int         xmin, ymin, xmax, ymax;
+static SEP_THREAD_LOCAL infostruct  *info=NULL, *store=NULL;
+static SEP_THREAD_LOCAL char	   *marker=NULL;
+static SEP_THREAD_LOCAL pixstatus   *psstack=NULL;
+static SEP_THREAD_LOCAL int         *start=NULL, *end=NULL, *discan=NULL;
+static SEP_THREAD_LOCAL int         xmin, ymin, xmax, ymax;
 
 
 /******************************* lutzalloc ***********************************/
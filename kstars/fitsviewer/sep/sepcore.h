@@ -20,6 +20,14 @@
 *
 *%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%*/
 
+/* Per-thread storage for the extraction buffers, so that several images can be
+ * extracted at the same time from different threads. */
+#if defined(_MSC_VER)
+#define SEP_THREAD_LOCAL __declspec(thread)
+#else
+#define SEP_THREAD_LOCAL __thread
+#endif
+
 #define	RETURN_OK           0  /* must be zero */
 #define MEMORY_ALLOC_ERROR  1
 #define PIXSTACK_FULL       2
@@ -25,7 +25,7 @@
 #define DETAILSIZE 512
 
 char *sep_version_string = "0.6.0";
-static char _errdetail_buffer[DETAILSIZE] = "";
+static SEP_THREAD_LOCAL char _errdetail_buffer[DETAILSIZE] = "";
 
 /****************************************************************************/
 /* data type conversion mechanics for runtime type conversion */
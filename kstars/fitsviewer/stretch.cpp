@@ -10,7 +10,11 @@
 
 #include <fitsio.h>
 #include <math.h>
+#include <limits>
+#include <type_traits>
+#include <vector>
 #include <QtConcurrent>
+#include <QThread>
 
 namespace {
 
@@ -47,165 +51,148 @@ T median(T *values, int size, int sampleBy)
   return median(samples);
 }
 
-// This stretches one channel given the input parameters.
+// This stretches samples of one channel given the input parameters.
 // Based on the spec in section 8.5.6
 // https://pixinsight.com/doc/docs/XISF-1.0-spec/XISF-1.0-spec.html
-// Uses multiple threads, blocks until done.
 // The extension parameters are not used.
+template <typename T>
+class ChannelStretch
+{
+  public:
+    ChannelStretch(const StretchParams1Channel &params, int input_range)
+    {
+      // Maximum possible input value (e.g. 1024*64 - 1 for a 16 bit unsigned int).
+      const float maxInput = input_range > 1 ? input_range - 1 : input_range;
+
+      midtones = params.midtones;
+      // Precomputed expressions moved out of the loop.
+      // hightlights - shadows, protecting for divide-by-0, in a 0->1.0 scale.
+      const float hsRangeFactor = params.highlights == params.shadows ? 1.0f : 1.0f / (params.highlights - params.shadows);
+      // Shadow and highlight values translated to the ADU scale.
+      nativeShadows = params.shadows * maxInput;
+      nativeHighlights = params.highlights * maxInput;
+      // Constants based on above needed for the stretch calculations.
+      k1 = (midtones - 1) * hsRangeFactor * maxOutput / maxInput;
+      k2 = ((2 * midtones) - 1) * hsRangeFactor / maxInput;
+    }
+
+    uint8_t operator()(const T input) const
+    {
+      if (input < nativeShadows) return 0;
+      else if (input >= nativeHighlights) return maxOutput;
+      const T inputFloored = (input - nativeShadows);
+      return (inputFloored * k1) / (inputFloored * k2 - midtones);
+    }
+
+  private:
+    // We're outputting uint8, so the max output is 255.
+    static constexpr int maxOutput = 255;
+
+    float midtones, k1, k2;
+    T nativeShadows, nativeHighlights;
+};
+
+// For integer types of 16 bits or less, the stretch is compiled into a table
+// covering all possible input values, e.g. 64K entries for 16-bit data.
+template <typename T>
+class ChannelStretchTable
+{
+  public:
+    ChannelStretchTable(const StretchParams1Channel &params, int input_range)
+      : table(1 << (8 * sizeof(T)))
+    {
+      const ChannelStretch<T> stretch(params, input_range);
+      for (size_t i = 0; i < table.size(); ++i)
+        table[i] = stretch(static_cast<T>(i + std::numeric_limits<T>::min()));
+    }
+
+    uint8_t operator()(const T input) const
+    {
+      return table[static_cast<int>(input) - std::numeric_limits<T>::min()];
+    }
+
+  private:
+    std::vector<uint8_t> table;
+};
+
+// Picks the lookup table when the input type allows it, the direct computation otherwise.
+template <typename T>
+using ChannelStretcher = typename std::conditional<std::is_integral<T>::value && sizeof(T) <= 2,
+                                                   ChannelStretchTable<T>, ChannelStretch<T>>::type;
+
+// Calls rowFunction(inputRow, outputRow) for every output row, in bands of rows
+// processed in parallel. Blocks until done.
 // Sampling is applied to the output (that is, with sampling=2, we compute every other output
 // sample both in width and height, so the output would have about 4X fewer pixels.
-template <typename T>
-void stretchOneChannel(T *input_buffer, QImage *output_image,
-                       const StretchParams& stretch_params, 
-                       int input_range, int image_height, int image_width, int sampling)
+template <typename F>
+void forEachRowBand(int image_height, int sampling, const F &rowFunction)
 {
   QVector<QFuture<void>> futures;
 
-  // We're outputting uint8, so the max output is 255.
-  constexpr int maxOutput = 255;
+  // A few bands per core balance the load without paying for one task per row.
+  const int outputHeight = (image_height + sampling - 1) / sampling;
+  const int numBands = std::min(outputHeight, 4 * QThread::idealThreadCount());
 
-  // Maximum possible input value (e.g. 1024*64 - 1 for a 16 bit unsigned int).
-  const float maxInput = input_range > 1 ? input_range - 1 : input_range;
-  
-  const float midtones   = stretch_params.grey_red.midtones;
-  const float highlights = stretch_params.grey_red.highlights;
-  const float shadows    = stretch_params.grey_red.shadows;
-
-  // Precomputed expressions moved out of the loop.
-  // hightlights - shadows, protecting for divide-by-0, in a 0->1.0 scale.
-  const float hsRangeFactor = highlights == shadows ? 1.0f : 1.0f / (highlights - shadows);
-  // Shadow and highlight values translated to the ADU scale.
-  const T nativeShadows = shadows * maxInput;
-  const T nativeHighlights = highlights * maxInput;
-  // Constants based on above needed for the stretch calculations.
-  const float k1 = (midtones - 1) * hsRangeFactor * maxOutput / maxInput;
-  const float k2 = ((2 * midtones) - 1) * hsRangeFactor / maxInput;
-  
-  // Increment the input index by the sampling, the output index increments by 1.
-  for (int j = 0, jout = 0; j < image_height; j+=sampling, jout++)
+  for (int band = 0; band < numBands; ++band)
   {
-    futures.append(QtConcurrent::run([ = ]()
+    const int first = band * outputHeight / numBands;
+    const int last = (band + 1) * outputHeight / numBands;
+    futures.append(QtConcurrent::run([ =, &rowFunction]()
     {
-        T * inputLine  = input_buffer + j * image_width;
-        auto * scanLine = output_image->scanLine(jout);
-        
-    for (int i = 0, iout = 0; i < image_width; i+=sampling, iout++)
-        {
-          const T input = inputLine[i];
-          if (input < nativeShadows) scanLine[iout] = 0;
-          else if (input >= nativeHighlights) scanLine[iout] = maxOutput;
-          else 
-          {
-            const T inputFloored = (input - nativeShadows);
-            scanLine[iout] = (inputFloored * k1) / (inputFloored * k2 - midtones);
-	  }
-        }
+      for (int jout = first; jout < last; ++jout)
+        rowFunction(jout * sampling, jout);
     }));
   }
   for(QFuture<void> future : futures)
     future.waitForFinished();
 }
 
+// This stretches one channel given the input parameters, writing directly into the output scanlines.
+// Uses multiple threads, blocks until done.
+template <typename T>
+void stretchOneChannel(T *input_buffer, QImage *output_image,
+                       const StretchParams& stretch_params,
+                       int input_range, int image_height, int image_width, int sampling)
+{
+  const ChannelStretcher<T> stretch(stretch_params.grey_red, input_range);
+
+  forEachRowBand(image_height, sampling, [&](int j, int jout)
+  {
+    const T * inputLine  = input_buffer + j * image_width;
+    auto * scanLine = output_image->scanLine(jout);
+
+    for (int i = 0, iout = 0; i < image_width; i+=sampling, iout++)
+      scanLine[iout] = stretch(inputLine[i]);
+  });
+}
+
 // This is like the above 1-channel stretch, but extended for 3 channels.
-// This could have been more modular, but the three channels are combined
-// into a single qRgb value at the end, so it seems the simplest thing is to
-// replicate the code. It is assume the colors are not interleaved--the red image
+// The three channels are combined into a single qRgb value at the end.
+// It is assume the colors are not interleaved--the red image
 // is stored fully, then the green, then the blue.
-// Sampling is applied to the output (that is, with sampling=2, we compute every other output
-// sample both in width and height, so the output would have about 4X fewer pixels.
 template <typename T>
 void stretchThreeChannels(T *inputBuffer, QImage *outputImage,
-                          const StretchParams& stretchParams, 
+                          const StretchParams& stretchParams,
                           int inputRange, int imageHeight, int imageWidth, int sampling)
 {
-  QVector<QFuture<void>> futures;
+  const ChannelStretcher<T> stretchR(stretchParams.grey_red, inputRange);
+  const ChannelStretcher<T> stretchG(stretchParams.green, inputRange);
+  const ChannelStretcher<T> stretchB(stretchParams.blue, inputRange);
 
-  // We're outputting uint8, so the max output is 255.
-  constexpr int maxOutput = 255;
-
-  // Maximum possible input value (e.g. 1024*64 - 1 for a 16 bit unsigned int).
-  const float maxInput = inputRange > 1 ? inputRange - 1 : inputRange;
-  
-  const float midtonesR   = stretchParams.grey_red.midtones;
-  const float highlightsR = stretchParams.grey_red.highlights;
-  const float shadowsR    = stretchParams.grey_red.shadows;
-  const float midtonesG   = stretchParams.green.midtones;
-  const float highlightsG = stretchParams.green.highlights;
-  const float shadowsG    = stretchParams.green.shadows;
-  const float midtonesB   = stretchParams.blue.midtones;
-  const float highlightsB = stretchParams.blue.highlights;
-  const float shadowsB    = stretchParams.blue.shadows;
-
-  // Precomputed expressions moved out of the loop.
-  // hightlights - shadows, protecting for divide-by-0, in a 0->1.0 scale.
-  const float hsRangeFactorR = highlightsR == shadowsR ? 1.0f : 1.0f / (highlightsR - shadowsR);
-  const float hsRangeFactorG = highlightsG == shadowsG ? 1.0f : 1.0f / (highlightsG - shadowsG);
-  const float hsRangeFactorB = highlightsB == shadowsB ? 1.0f : 1.0f / (highlightsB - shadowsB);
-  // Shadow and highlight values translated to the ADU scale.
-  const T nativeShadowsR = shadowsR * maxInput;
-  const T nativeShadowsG = shadowsG * maxInput;
-  const T nativeShadowsB = shadowsB * maxInput;
-  const T nativeHighlightsR = highlightsR * maxInput;
-  const T nativeHighlightsG = highlightsG * maxInput;
-  const T nativeHighlightsB = highlightsB * maxInput;
-  // Constants based on above needed for the stretch calculations.
-  const float k1R = (midtonesR - 1) * hsRangeFactorR * maxOutput / maxInput;
-  const float k1G = (midtonesG - 1) * hsRangeFactorG * maxOutput / maxInput;
-  const float k1B = (midtonesB - 1) * hsRangeFactorB * maxOutput / maxInput;
-  const float k2R = ((2 * midtonesR) - 1) * hsRangeFactorR / maxInput;
-  const float k2G = ((2 * midtonesG) - 1) * hsRangeFactorG / maxInput;
-  const float k2B = ((2 * midtonesB) - 1) * hsRangeFactorB / maxInput;
-  
   const int size = imageWidth * imageHeight;
-  
-  for (int j = 0, jout = 0; j < imageHeight; j+=sampling, jout++)
+
+  forEachRowBand(imageHeight, sampling, [&](int j, int jout)
   {
-    futures.append(QtConcurrent::run([ = ]()
-    {
-        // R, G, B input images are stored one after another.
-        T * inputLineR  = inputBuffer + j * imageWidth;
-        T * inputLineG  = inputLineR + size;
-        T * inputLineB  = inputLineG + size;
-        
-        auto * scanLine = reinterpret_cast<QRgb*>(outputImage->scanLine(jout));
-        
+    // R, G, B input images are stored one after another.
+    const T * inputLineR  = inputBuffer + j * imageWidth;
+    const T * inputLineG  = inputLineR + size;
+    const T * inputLineB  = inputLineG + size;
+
+    auto * scanLine = reinterpret_cast<QRgb*>(outputImage->scanLine(jout));
+
     for (int i = 0, iout = 0; i < imageWidth; i+=sampling, iout++)
-        {
-          const T inputR = inputLineR[i];
-          const T inputG = inputLineG[i];
-          const T inputB = inputLineB[i];
-
-          uint8_t red, green, blue;
-          
-          if (inputR < nativeShadowsR) red = 0;
-          else if (inputR >= nativeHighlightsR) red = maxOutput;
-          else 
-          {
-            const T inputFloored = (inputR - nativeShadowsR);
-            red = (inputFloored * k1R) / (inputFloored * k2R - midtonesR);
-	  }
-
-          if (inputG < nativeShadowsG) green = 0;
-          else if (inputG >= nativeHighlightsG) green = maxOutput;
-          else 
-          {
-            const T inputFloored = (inputG - nativeShadowsG);
-            green = (inputFloored * k1G) / (inputFloored * k2G - midtonesG);
-	  }
-
-          if (inputB < nativeShadowsB) blue = 0;
-          else if (inputB >= nativeHighlightsB) blue = maxOutput;
-          else 
-          {
-            const T inputFloored = (inputB - nativeShadowsB);
-            blue = (inputFloored * k1B) / (inputFloored * k2B - midtonesB);
-	  }
-          scanLine[iout] = qRgb(red, green, blue);
-        }
-    }));
-  }
-  for(QFuture<void> future : futures)
-    future.waitForFinished();
+      scanLine[iout] = qRgb(stretchR(inputLineR[i]), stretchG(inputLineG[i]), stretchB(inputLineB[i]));
+  });
 }
 
 template <typename T>
@@ -0,0 +1,360 @@
+/*  INDI CCD Capture Writer
+    Copyright (C) 2026 agent <agent@local>
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+ */
+
+#include "capturewriter.h"
+
+#include "config-kstars.h"
+
+#include "indi_debug.h"
+#include "Options.h"
+
+#ifdef HAVE_CFITSIO
+#include "ekos/auxiliary/capturefileindex.h"
+#include "fitsviewer/fpack.h"
+#endif
+
+#include <QDataStream>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QtConcurrent>
+
+#include <algorithm>
+
+#ifndef Q_OS_WIN
+#include <unistd.h>
+#endif
+
+namespace
+{
+void addFITSKeywords(const QString &filename, const QString &filter_used)
+{
+#ifdef HAVE_CFITSIO
+    int status = 0;
+
+    if (filter_used.isEmpty() == false)
+    {
+        QString filt(filter_used);
+        QString key_comment("Filter name");
+        filt.replace(' ', '_');
+
+        fitsfile *fptr = nullptr;
+
+        // Use open diskfile as it does not use extended file names which has problems opening
+        // files with [ ] or ( ) in their names.
+        if (fits_open_diskfile(&fptr, filename.toLatin1(), READWRITE, &status))
+        {
+            fits_report_error(stderr, status);
+            return;
+        }
+
+        if (fits_movabs_hdu(fptr, 1, IMAGE_HDU, &status))
+        {
+            fits_report_error(stderr, status);
+            fits_close_file(fptr, &status);
+            return;
+        }
+
+        if (fits_update_key_str(fptr, "FILTER", filt.toLatin1().data(), key_comment.toLatin1().data(), &status))
+        {
+            fits_report_error(stderr, status);
+            status = 0;
+        }
+
+        fits_flush_file(fptr, &status);
+        fits_close_file(fptr, &status);
+    }
+#else
+    Q_UNUSED(filename)
+    Q_UNUSED(filter_used)
+#endif
+}
+}
+
+namespace ISD
+{
+CaptureWriter::~CaptureWriter()
+{
+    waitForFinished();
+}
+
+QString CaptureWriter::fileExtension(const QString &format)
+{
+#ifdef HAVE_CFITSIO
+    if (Options::captureWriterCompression() && format.contains("fits") && format.endsWith(".fz") == false)
+        return format + ".fz";
+#endif
+    return format;
+}
+
+QFuture<bool> CaptureWriter::write(const QString &filename, const char *buffer, size_t size, bool isFITS,
+                                   const QString &filter)
+{
+    Job job;
+    job.filename = filename;
+    job.isFITS = isFITS;
+    job.filter = filter;
+    job.done.reportStarted();
+
+    // The caller may release the buffer as soon as this returns
+    job.data = QByteArray(buffer, static_cast<int>(size));
+
+    QFuture<bool> const future = job.done.future();
+
+    QMutexLocker locker(&lock);
+
+    stats.bytes += size;
+
+    // Waiting for room would block the main thread, so write the image right away instead
+    int const capacity = std::max(1, static_cast<int>(Options::captureWriterQueueSize()));
+    if (queue.size() >= capacity)
+    {
+        stats.spills++;
+        spilling++;
+        qCWarning(KSTARS_INDI) << "Capture writer queue is full with" << queue.size() << "images, writing" << filename
+                               << "out of order.";
+        QtConcurrent::run(this, &CaptureWriter::spill, job);
+        return future;
+    }
+
+    queue.enqueue(job);
+
+    stats.queueDepth = queue.size();
+    stats.maxQueueDepth = std::max(stats.maxQueueDepth, stats.queueDepth);
+
+    if (running == false)
+    {
+        running = true;
+        QtConcurrent::run(this, &CaptureWriter::run);
+    }
+
+    return future;
+}
+
+void CaptureWriter::waitForFinished()
+{
+    QMutexLocker locker(&lock);
+    while (running || spilling > 0)
+        drained.wait(&lock);
+}
+
+void CaptureWriter::run()
+{
+    QElapsedTimer timer;
+
+    forever
+    {
+        Job job;
+        QStringList filesToSync;
+        {
+            QMutexLocker locker(&lock);
+            if (queue.isEmpty())
+            {
+                // Sync the last batch before going idle, outside of the lock so that queueing is not held back
+                if (unsyncedFiles.isEmpty() == false)
+                {
+                    filesToSync.swap(unsyncedFiles);
+                    locker.unlock();
+                    syncFiles(filesToSync);
+                    continue;
+                }
+
+                running = false;
+
+                qCDebug(KSTARS_INDI) << "Capture writer idle:" << stats.frames << "images written at"
+                                     << (stats.busySeconds > 0 ? stats.bytes / stats.busySeconds / 1e6 : 0) << "MB/s,"
+                                     << "max queue depth" << stats.maxQueueDepth << "," << stats.spills << "written out of order.";
+
+                drained.wakeAll();
+                return;
+            }
+
+            // Keep the image queued while it is written, so that the queue depth accounts for it
+            job = queue.head();
+        }
+
+        timer.start();
+
+        bool const rc = writeJob(job);
+
+        {
+            QMutexLocker locker(&lock);
+
+            // Sync files in batches if requested, otherwise leave it to the operating system
+            int const batch = static_cast<int>(Options::captureWriterSyncFrames());
+            if (rc && batch > 0)
+            {
+                unsyncedFiles.append(job.filename);
+                if (unsyncedFiles.size() >= batch)
+                    filesToSync.swap(unsyncedFiles);
+            }
+
+            queue.dequeue();
+            stats.queueDepth = queue.size();
+        }
+
+        syncFiles(filesToSync);
+
+        {
+            QMutexLocker locker(&lock);
+            stats.frames++;
+            stats.busySeconds += timer.nsecsElapsed() / 1e9;
+        }
+
+        job.done.reportFinished(&rc);
+    }
+}
+
+void CaptureWriter::spill(Job job)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    bool const rc = writeJob(job);
+
+    // There is no batch to join out of order, sync right away if syncing is requested
+    if (rc && Options::captureWriterSyncFrames() > 0)
+        syncFiles(QStringList(job.filename));
+
+    {
+        QMutexLocker locker(&lock);
+        stats.frames++;
+        stats.busySeconds += timer.nsecsElapsed() / 1e9;
+        spilling--;
+        drained.wakeAll();
+    }
+
+    job.done.reportFinished(&rc);
+}
+
+bool CaptureWriter::writeJob(const Job &job)
+{
+#ifdef HAVE_CFITSIO
+    QDateTime const directoryModified = Ekos::CaptureFileIndex::directoryTime(job.filename);
+#endif
+    bool const rc = (job.isFITS && job.filename.endsWith(".fz")) ? compressFile(job) : writeFile(job);
+    if (rc == false)
+        qCCritical(KSTARS_INDI) << "ISD:CCD Error: Unable to write" << job.filename;
+#ifdef HAVE_CFITSIO
+    else
+    {
+        // Writing touches the directory, keep the capture index in sync so that it does not list it again
+        Ekos::CaptureFileIndex::Instance()->addFile(job.filename, directoryModified);
+    }
+#endif
+    return rc;
+}
+
+bool CaptureWriter::writeFile(const Job &job)
+{
+    QFile file(job.filename);
+    if (!file.open(QIODevice::WriteOnly))
+    {
+        qCCritical(KSTARS_INDI) << "ISD:CCD Error: Unable to open write file: " << job.filename;
+        return false;
+    }
+
+    int n = 0;
+    QDataStream out(&file);
+    for (int nr = 0; nr < job.data.size(); nr += n)
+    {
+        n = out.writeRawData(job.data.constData() + nr, job.data.size() - nr);
+        if (n < 0)
+            return false;
+    }
+    file.flush();
+    file.close();
+
+    if (job.isFITS)
+        addFITSKeywords(job.filename, job.filter);
+
+    return true;
+}
+
+bool CaptureWriter::compressFile(const Job &job)
+{
+#ifdef HAVE_CFITSIO
+    int status = 0, isLossLess = 0;
+    fitsfile *infptr = nullptr, *outfptr = nullptr;
+
+    // Compress straight from memory, there is no uncompressed file to pack
+    void *buffer = const_cast<char *>(job.data.constData());
+    size_t size = static_cast<size_t>(job.data.size());
+
+    if (fits_open_memfile(&infptr, job.filename.toLatin1().data(), READONLY, &buffer, &size, 0, nullptr, &status))
+    {
+        fits_report_error(stderr, status);
+        return false;
+    }
+
+    QFile::remove(job.filename);
+    if (fits_create_diskfile(&outfptr, job.filename.toLatin1().data(), &status))
+    {
+        fits_report_error(stderr, status);
+        status = 0;
+        fits_close_file(infptr, &status);
+        return false;
+    }
+
+    // Same settings as fp_pack for the primary image HDU
+    fpstate fpvar;
+    fp_init(&fpvar);
+
+    fits_set_lossy_int(outfptr, fpvar.int_to_float, &status);
+    fits_set_compression_type(outfptr, fpvar.comptype, &status);
+    fits_set_tile_dim(outfptr, 6, fpvar.ntile, &status);
+    fits_set_quantize_method(outfptr, fpvar.no_dither ? -1 : fpvar.dither_method, &status);
+    fits_set_quantize_level(outfptr, fpvar.quantize_level, &status);
+    fits_set_dither_offset(outfptr, fpvar.dither_offset, &status);
+    fits_set_hcomp_scale(outfptr, fpvar.scale, &status);
+    fits_set_hcomp_smooth(outfptr, fpvar.smooth, &status);
+
+    fp_pack_hdu(infptr, outfptr, fpvar, &isLossLess, &status);
+
+    if (status == 0 && job.filter.isEmpty() == false)
+    {
+        // The compressed image is in the first extension
+        QString filt(job.filter);
+        filt.replace(' ', '_');
+        if (fits_movabs_hdu(outfptr, 2, nullptr, &status) == 0)
+            fits_update_key_str(outfptr, "FILTER", filt.toLatin1().data(), const_cast<char *>("Filter name"), &status);
+    }
+
+    bool const rc = (status == 0);
+    if (rc == false)
+        fits_report_error(stderr, status);
+
+    status = 0;
+    fits_close_file(outfptr, &status);
+    status = 0;
+    fits_close_file(infptr, &status);
+
+    if (rc == false)
+        QFile::remove(job.filename);
+
+    return rc;
+#else
+    return writeFile(job);
+#endif
+}
+
+void CaptureWriter::syncFiles(const QStringList &filenames)
+{
+#ifndef Q_OS_WIN
+    // Syncing any descriptor of a file flushes all of its data
+    for (const QString &filename : filenames)
+    {
+        QFile file(filename);
+        if (file.open(QIODevice::ReadOnly))
+            ::fsync(file.handle());
+    }
+#else
+    Q_UNUSED(filenames)
+#endif
+}
+}
@@ -0,0 +1,113 @@
+/*  INDI CCD Capture Writer
+    Copyright (C) 2026 agent <agent@local>
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+ */
+
+#pragma once
+
+#include <QByteArray>
+#include <QFuture>
+#include <QFutureInterface>
+#include <QMutex>
+#include <QQueue>
+#include <QStringList>
+#include <QWaitCondition>
+
+namespace ISD
+{
+/**
+ * @class CaptureWriter
+ * @short Writes captured images to disk in the background, in the order they were received.
+ *
+ * Images are copied to a bounded queue and written one after the other by a single worker, so that a short
+ * exposure does not wait for the previous image to reach the disk. Queueing never blocks the caller, which receives images on the main
+ * thread: once the queue is full, a new image is spilled to a task of its own and written right away, out of
+ * order, and the spill is reported.
+ *
+ * Written files may be synced to disk in batches of a few frames, and FITS images may be compressed with fpack
+ * on their way to the disk. Queue size, sync batch and compression are read from the Capture options.
+ *
+ * @version 1.0
+ */
+class CaptureWriter
+{
+    public:
+        /** @brief Writer metrics, accumulated since the writer was created and logged whenever it goes idle. */
+        typedef struct
+        {
+            /** Number of images waiting to be written */
+            int queueDepth;
+            /** Largest number of images that waited to be written */
+            int maxQueueDepth;
+            /** Number of images written */
+            uint64_t frames;
+            /** Number of bytes received for writing */
+            uint64_t bytes;
+            /** Time spent writing, in seconds */
+            double busySeconds;
+            /** Number of images written out of order because the queue was full */
+            uint64_t spills;
+        } Statistics;
+
+        CaptureWriter() = default;
+        ~CaptureWriter();
+
+        /**
+         * @brief write Queue a copy of an image for writing.
+         * @param filename path of the file to write, which ends with .fz if the image is to be compressed.
+         * @param buffer image data, which may be released as soon as this function returns.
+         * @param size size of the image data in bytes.
+         * @param isFITS whether the image is FITS, in which case the filter keyword is added to it.
+         * @param filter filter name to store in the FITS header, if not empty.
+         * @return a future finishing once the file is complete on disk, with the result of the write.
+         * @note If the queue is full, the image is written right away, outside of the queue.
+         */
+        QFuture<bool> write(const QString &filename, const char *buffer, size_t size, bool isFITS, const QString &filter);
+
+        /** @brief waitForFinished Wait until all queued images are written. */
+        void waitForFinished();
+
+        /**
+         * @brief fileExtension Get the extension of the files written for an image format.
+         * @param format image format with a leading dot, e.g. ".fits".
+         * @return format, with .fz appended if FITS images are compressed.
+         */
+        static QString fileExtension(const QString &format);
+
+    private:
+        typedef struct
+        {
+            QString filename;
+            QByteArray data;
+            bool isFITS;
+            QString filter;
+            QFutureInterface<bool> done;
+        } Job;
+
+        // Worker loop, runs until the queue is empty.
+        void run();
+        // Write an image that did not fit in the queue.
+        void spill(Job job);
+        // Write an image and record it in the capture index.
+        bool writeJob(const Job &job);
+        bool writeFile(const Job &job);
+        bool compressFile(const Job &job);
+        static void syncFiles(const QStringList &filenames);
+
+        QMutex lock;
+        QWaitCondition drained;
+        QQueue<Job> queue;
+        bool running { false };
+        // Number of spilled images being written
+        int spilling { 0 };
+
+        // Files written since the last sync
+        QStringList unsyncedFiles;
+
+        Statistics stats { 0, 0, 0, 0, 0, 0 };
+};
+}
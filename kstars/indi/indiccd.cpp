@@ -23,12 +23,15 @@
 #include "streamwg.h"
 //#include "ekos/manager.h"
 #ifdef HAVE_CFITSIO
+#include "ekos/auxiliary/capturefileindex.h"
 #include "fitsviewer/fitsdata.h"
 #endif
 
 #include <KNotifications/KNotification>
 #include <QImageReader>
+#include <QRegularExpression>
 #include <QStatusBar>
+#include <QUuid>
 #include <QtConcurrent>
 
 #include <basedevice.h>
@@ -37,67 +40,6 @@ const QStringList RAWFormats = { "cr2", "cr3", "crw", "nef", "raf", "dng", "arw"
 
 namespace
 {
-void addFITSKeywords(const QString &filename, const QString &filter_used)
-{
-#ifdef HAVE_CFITSIO
-    int status = 0;
-
-    if (filter_used.isEmpty() == false)
-    {
-        QString filt(filter_used);
-        QString key_comment("Filter name");
-        filt.replace(' ', '_');
-
-        fitsfile *fptr = nullptr;
-
-        // Use open diskfile as it does not use extended file names which has problems opening
-        // files with [ ] or ( ) in their names.
-        if (fits_open_diskfile(&fptr, filename.toLatin1(), READONLY, &status))
-        {
-            fits_report_error(stderr, status);
-            return;
-        }
-
-        if (fits_movabs_hdu(fptr, 1, IMAGE_HDU, &status))
-        {
-            fits_report_error(stderr, status);
-            return;
-        }
-
-        if (fits_update_key_str(fptr, "FILTER", filt.toLatin1().data(), key_comment.toLatin1().data(), &status))
-        {
-            fits_report_error(stderr, status);
-            return;
-        }
-
-        fits_flush_file(fptr, &status);
-        fits_close_file(fptr, &status);
-    }
-#endif
-}
-
-// Internal function to write an image blob to disk.
-bool WriteImageFileInternal(const QString &filename, char *buffer, const size_t size,
-                            bool add_fits_keywords, const QString &filter)
-{
-    QFile file(filename);
-    if (!file.open(QIODevice::WriteOnly))
-    {
-        qCCritical(KSTARS_INDI) << "ISD:CCD Error: Unable to open write file: " <<
-                                filename;
-        return false;
-    }
-    size_t n = 0;
-    QDataStream out(&file);
-    for (size_t nr = 0; nr < size; nr += n)
-        n = out.writeRawData(buffer + nr, size - nr);
-    file.flush();
-    file.close();
-    if (add_fits_keywords)
-        addFITSKeywords(filename, filter);
-    return true;
-}
-
 // Internal function to write a temporary file image blob to disk.
 bool writeTempImageFile(const QString &format, char * buffer, size_t size, QString *filename)
 {
@@ -121,6 +63,34 @@ bool writeTempImageFile(const QString &format, char * buffer, size_t size, QStri
     *filename = tmpFile.fileName();
     return true;
 }
+
+#ifdef HAVE_CFITSIO
+// Internal function to reserve a temporary file name for an image blob kept in memory.
+QString tempImageFilename(const QString &format)
+{
+    return QDir::tempPath() + "/fits" + QUuid::createUuid().toString().remove(QRegularExpression("[-{}]")) + format;
+}
+
+// Internal function to restrict the statistics of a guide frame to the search region around the guide star.
+void setGuideStatisticsRegion(ISD::CCDChip *targetChip, FITSData *data)
+{
+    if (targetChip->getCaptureMode() != FITS_GUIDE)
+        return;
+
+    // The box is drawn on the previous frame, it does not apply if the frame was moved, resized or binned differently
+    if (targetChip->updateGuideFrame() == false)
+        return;
+
+    FITSView *view = targetChip->getImageView(FITS_GUIDE);
+    if (view == nullptr || view->isTrackingBoxEnabled() == false || view->getTrackingBox().isValid() == false)
+        return;
+
+    // The star may have moved out of the box since the previous frame
+    QRect const box = view->getTrackingBox();
+    int const margin = box.width() / 2;
+    data->setStatisticsRegion(box.adjusted(-margin, -margin, margin, margin));
+}
+#endif
 }
 
 namespace ISD
@@ -827,6 +797,32 @@ bool CCDChip::getBinning(int *bin_x, int *bin_y)
     return true;
 }
 
+bool CCDChip::updateGuideFrame()
+{
+    int x = 0, y = 0, w = 0, h = 0, binX = 1, binY = 1;
+    getFrame(&x, &y, &w, &h);
+    getBinning(&binX, &binY);
+
+    QRect const frame(x, y, w, h);
+    QSize const binning(binX, binY);
+    bool const unchanged = (frame == guideFrame && binning == guideBinning);
+
+    guideFrame   = frame;
+    guideBinning = binning;
+    return unchanged;
+}
+
+void CCDChip::updateExposureState(IPState state)
+{
+    // The frame is downloaded once the exposure is over, its latency starts here
+    if (exposureState == IPS_BUSY && (state == IPS_OK || state == IPS_IDLE))
+        exposureEnd.start();
+    else if (state == IPS_BUSY && exposureState != IPS_BUSY)
+        exposureEnd.invalidate();
+
+    exposureState = state;
+}
+
 bool CCDChip::getMaxBin(int *max_xbin, int *max_ybin)
 {
     if (!max_xbin || !max_ybin)
@@ -924,10 +920,6 @@ CCD::~CCD()
 {
     if (m_ImageViewerWindow)
         m_ImageViewerWindow->close();
-    if (fileWriteThread.isRunning())
-        fileWriteThread.waitForFinished();
-    if (fileWriteBuffer != nullptr)
-        delete [] fileWriteBuffer;
 }
 
 void CCD::setBLOBManager(const char *device, INDI::Property *prop)
@@ -1142,6 +1134,7 @@ void CCD::processNumber(INumberVectorProperty *nvp)
 {
     if (!strcmp(nvp->name, "CCD_EXPOSURE"))
     {
+        primaryChip->updateExposureState(nvp->s);
         INumber *np = IUFindNumber(nvp, "CCD_EXPOSURE_VALUE");
         if (np)
             emit newExposureValue(primaryChip.get(), np->value, nvp->s);
@@ -1157,6 +1150,7 @@ void CCD::processNumber(INumberVectorProperty *nvp)
     }
     else if (!strcmp(nvp->name, "GUIDER_EXPOSURE"))
     {
+        guideChip->updateExposureState(nvp->s);
         INumber *np = IUFindNumber(nvp, "GUIDER_EXPOSURE_VALUE");
         if (np)
             emit newExposureValue(guideChip.get(), np->value, nvp->s);
@@ -1432,6 +1426,10 @@ bool CCD::generateFilename(const QString &format, bool batch_mode, QString *file
         *filename = currentDir + seqPrefix + (seqPrefix.isEmpty() ? "" : "_") +
                     QString("%1%2").arg(QString().sprintf("%03d", nextSequenceID), format);
 
+#ifdef HAVE_CFITSIO
+    QDateTime const directoryModified = Ekos::CaptureFileIndex::directoryTime(*filename);
+#endif
+
     QFile test_file(*filename);
     if (!test_file.open(QIODevice::WriteOnly))
     {
@@ -1440,50 +1438,26 @@ bool CCD::generateFilename(const QString &format, bool batch_mode, QString *file
     }
     test_file.flush();
     test_file.close();
+
+#ifdef HAVE_CFITSIO
+    // Sequence numbers are looked up in the index, so let it know right away that this one is taken
+    if (batch_mode)
+        Ekos::CaptureFileIndex::Instance()->addFile(*filename, directoryModified);
+#endif
+
     return true;
 }
 
 bool CCD::writeImageFile(const QString &filename, IBLOB *bp, bool is_fits)
 {
-    // TODO: Not yet threading the writes for non-fits files.
-    // Would need to deal with the raw conversion, etc.
-    if (is_fits)
-    {
-        // Check if the last write is still ongoing, and if so wait.
-        // It is using the fileWriteBuffer.
-        if (fileWriteThread.isRunning())
-        {
-            fileWriteThread.waitForFinished();
-        }
-
-        // Wait until the file is written before overwritting the filename.
-        fileWriteFilename = filename;
+    // The writer copies the blob and writes it in the background, in order while its queue has room.
+    fileWriteFuture = m_CaptureWriter.write(filename, static_cast<const char *>(bp->blob), bp->size, is_fits, filter);
+    filter = "";
 
-        // Will write blob data in a separate thread, and can't depend on the blob
-        // memory, so copy it first.
+    // Images other than FITS are converted or displayed from their file right away
+    if (is_fits == false)
+        return fileWriteFuture.result();
 
-        // Check buffer size.
-        if (fileWriteBufferSize != bp->size)
-        {
-            if (fileWriteBuffer != nullptr)
-                delete [] fileWriteBuffer;
-            fileWriteBufferSize = bp->size;
-            fileWriteBuffer = new char[fileWriteBufferSize];
-        }
-
-        // Copy memory, and write file on a separate thread.
-        // Probably too late to return an error if the file couldn't write.
-        memcpy(fileWriteBuffer, bp->blob, bp->size);
-        fileWriteThread = QtConcurrent::run(WriteImageFileInternal, fileWriteFilename,
-                                            fileWriteBuffer, bp->size, is_fits, filter);
-        filter = "";
-    }
-    else
-    {
-        if (!WriteImageFileInternal(filename, static_cast<char*>(bp->blob), bp->size,
-                                    false, filter))
-            return false;
-    }
     return true;
 }
 
@@ -1564,19 +1538,23 @@ void CCD::processBLOB(IBLOB *bp)
     QString filename;
     if (targetChip->isBatchMode() == false || targetChip->getCaptureMode() != FITS_NORMAL)
     {
-        if (!writeTempImageFile(format, static_cast<char *>(bp->blob), bp->size, &filename))
-        {
-            emit BLOBUpdated(nullptr);
-            return;
-        }
+#ifdef HAVE_CFITSIO
+        // FITS frames are loaded straight from the blob memory, so only reserve a name for them.
+        // Modules needing the frame on disk, like the solver, write it with FITSData::ensureFileOnDisk().
         if (BType == BLOB_FITS)
-            addFITSKeywords(filename, filter);
-
+            filename = tempImageFilename(format);
+        else
+#endif
+            if (!writeTempImageFile(format, static_cast<char *>(bp->blob), bp->size, &filename))
+            {
+                emit BLOBUpdated(nullptr);
+                return;
+            }
     }
     // Create file name for others
     else
     {
-        if (!generateFilename(format, targetChip->isBatchMode(), &filename) ||
+        if (!generateFilename(CaptureWriter::fileExtension(format), targetChip->isBatchMode(), &filename) ||
             !writeImageFile(filename, bp, BType == BLOB_FITS))
         {
             emit BLOBUpdated(nullptr);
@@ -1683,6 +1661,8 @@ void CCD::processBLOB(IBLOB *bp)
     if (BType == BLOB_FITS)
     {
         FITSData *blob_fits_data = new FITSData(targetChip->getCaptureMode());
+        blob_fits_data->setExposureEnd(targetChip->getExposureEnd());
+        setGuideStatisticsRegion(targetChip, blob_fits_data);
 
         if (!blob_fits_data->loadFITSFromMemory(filename, bp->blob, bp->size, false))
         {
@@ -1694,6 +1674,14 @@ void CCD::processBLOB(IBLOB *bp)
             return;
         }
 
+        // Frames kept in memory get the filter in their header, and in their file if one is written
+        if (filter.isEmpty() == false)
+        {
+            QString filt(filter);
+            filt.replace(' ', '_');
+            blob_fits_data->updateRecordValue("FILTER", filt, "Filter name");
+        }
+
         displayFits(targetChip, filename, bp, blob_fits_data);
     }
     else
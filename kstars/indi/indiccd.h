@@ -10,14 +10,17 @@
 #pragma once
 
 #include "indistd.h"
+#include "capturewriter.h"
 #include "wsmedia.h"
 #include "auxiliary/imageviewer.h"
 #include "fitsviewer/fitscommon.h"
 #include "fitsviewer/fitsview.h"
 #include "fitsviewer/fitsviewer.h"
 
+#include <QElapsedTimer>
 #include <QStringList>
 #include <QPointer>
+#include <QRect>
 #include <QtConcurrent>
 
 #include <memory>
@@ -75,6 +78,21 @@ class CCDChip
         CCDBinType getBinning();
         bool getBinning(int *bin_x, int *bin_y);
         bool getMaxBin(int *max_xbin, int *max_ybin);
+        /**
+         * @brief updateGuideFrame Record the frame and binning of a received guide frame.
+         * @return true if they are the same as those of the previous guide frame, on which the tracking box is drawn.
+         */
+        bool updateGuideFrame();
+        /**
+         * @brief updateExposureState Follow the state of the exposure property of the chip, and stamp the end of the exposure.
+         * @param state new state of the exposure property.
+         */
+        void updateExposureState(IPState state);
+        /** @return timer started when the last exposure of the chip ended, invalid if unknown. */
+        const QElapsedTimer &getExposureEnd() const
+        {
+            return exposureEnd;
+        }
         ChipType getType() const
         {
             return type;
@@ -157,6 +175,12 @@ class CCDChip
         bool CanSubframe { false };
         bool CanAbort { false };
         ISD::CCD *parentCCD { nullptr };
+        // Frame and binning of the last guide frame received
+        QRect guideFrame;
+        QSize guideBinning;
+        // State of the exposure property, and end of the last exposure
+        IPState exposureState { IPS_IDLE };
+        QElapsedTimer exposureEnd;
 };
 
 /**
@@ -256,6 +280,12 @@ class CCD : public DeviceDecorator
         bool configureRapidGuide(CCDChip *targetChip, bool autoLoop, bool sendImage = false, bool showMarker = false);
         bool setRapidGuide(CCDChip *targetChip, bool enable);
 
+        // Background write of the last saved image, finished once the file is complete on disk
+        QFuture<void> getFileWriteFuture() const
+        {
+            return fileWriteFuture;
+        }
+
         // Upload Settings
         void updateUploadSettings(const QString &remoteDir);
         UploadMode getUploadMode();
@@ -403,10 +433,8 @@ class CCD : public DeviceDecorator
         QMap<QString, double> m_ExposurePresets;
         QPair<double, double> m_ExposurePresetsMinMax;
 
-        // Used when writing the image fits file to disk in a separate thread.
-        char *fileWriteBuffer { nullptr };
-        int fileWriteBufferSize { 0 };
-        QString fileWriteFilename;
-        QFuture<void> fileWriteThread;
+        // Writes saved images to disk in the background
+        CaptureWriter m_CaptureWriter;
+        QFuture<bool> fileWriteFuture;
 };
 }
@@ -17,9 +17,18 @@
 #include "indi/clientmanager.h"
 #include "indi/indilistener.h"
 #include "indi/deviceinfo.h"
+#include "indi/indiccd.h"
 
+#include "config-kstars.h"
 #include "kstars_debug.h"
 
+#ifdef HAVE_CFITSIO
+#include "fitsviewer/fitsdata.h"
+#include "fitsviewer/fitsview.h"
+#endif
+
+#include <QFile>
+
 #include <basedevice.h>
 
 INDIDBus::INDIDBus(QObject *parent) : QObject(parent)
@@ -606,6 +615,28 @@ QString INDIDBus::getBLOBFile(const QString &device, const QString &property, co
                     size       = b->bloblen;
                     blobFormat = QString(b->format).trimmed();
 
+                    // FITS frames are kept in memory, write the last one out on request
+                    if (filename.isEmpty() == false && b->blob != nullptr && QFile::exists(filename) == false)
+                    {
+#ifdef HAVE_CFITSIO
+                        // The displayed frame carries the header records added by KStars, like the filter
+                        if (gd->getType() == KSTARS_CCD)
+                        {
+                            ISD::CCD *ccd = static_cast<ISD::CCD *>(gd);
+                            ISD::CCDChip *chip = ccd->getChip(property == "CCD2" ? ISD::CCDChip::GUIDE_CCD :
+                                                              ISD::CCDChip::PRIMARY_CCD);
+                            FITSView *view = chip ? chip->getImageView(chip->getCaptureMode()) : nullptr;
+                            FITSData *data = view ? view->getImageData() : nullptr;
+                            if (data != nullptr && data->filename() == filename && data->ensureFileOnDisk())
+                                return filename;
+                        }
+#endif
+                        QFile file(filename);
+                        if (file.open(QIODevice::WriteOnly) == false ||
+                                file.write(static_cast<const char *>(b->blob), b->size) != b->size)
+                            qCWarning(KSTARS) << "Could not write BLOB file" << filename;
+                    }
+
                     return filename;
                 }
 
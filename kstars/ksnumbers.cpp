@@ -290,6 +290,29 @@ void KSNumbers::updateValues(long double jd)
     P2(1, 2) = P1(2, 1);
     P2(2, 2) = P1(2, 2);
 
+    //Nutation moves the equinox along the ecliptic by deltaEcLong, and tilts the equator by deltaObliquity
+    double sinOb, cosOb, sinTrueOb, cosTrueOb, sinDPsi, cosDPsi;
+    Obliquity.SinCos(sinOb, cosOb);
+    dms(Obliquity.Degrees() + deltaObliquity).SinCos(sinTrueOb, cosTrueOb);
+    dms(deltaEcLong).SinCos(sinDPsi, cosDPsi);
+
+    Eigen::Matrix3d toEcliptic, nutation, toEquatorial;
+    toEcliptic << 1, 0, 0, 0, cosOb, sinOb, 0, -sinOb, cosOb;
+    nutation << cosDPsi, -sinDPsi, 0, sinDPsi, cosDPsi, 0, 0, 0, 1;
+    toEquatorial << 1, 0, 0, 0, cosTrueOb, -sinTrueOb, 0, sinTrueOb, cosTrueOb;
+
+    // SkyPoint::precess() applies P1 (returned by p2())
+    PN = toEquatorial * nutation * toEcliptic * P1;
+
+    //Velocity of the Earth for the annual aberration, from the true longitude of the Sun and the
+    //perihelion of the Earth's orbit, like SkyPoint::aberrate()
+    double sinL, cosL, sinP, cosP;
+    L0.SinCos(sinL, cosL);
+    P.SinCos(sinP, cosP);
+
+    Eigen::Vector3d const eclipticVelocity(K.radians() * (sinL - e * sinP), -K.radians() * (cosL - e * cosP), 0);
+    Aberration = toEcliptic.transpose() * eclipticVelocity;
+
     // Mean longitudes for the planets. radians
     //
 
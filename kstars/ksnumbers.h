@@ -123,6 +123,19 @@ class KSNumbers
     inline const Eigen::Matrix3d &p1b() const { return P1B; }
     inline const Eigen::Matrix3d &p2b() const { return P2B; }
 
+    /**
+     * @return the rotation from J2000 unit vectors to unit vectors of the true equator and equinox of date,
+     * i.e. the precession matrix followed by nutation, the combined effect of SkyPoint::precess() and SkyPoint::nutate()
+     */
+    inline const Eigen::Matrix3d &precessionNutation() const { return PN; }
+
+    /**
+     * @return the velocity of the Earth in units of the speed of light, in equatorial coordinates of date,
+     * used by the vector form of the annual aberration: a unit vector u is apparently seen in the direction of
+     * u + aberrationVector().
+     */
+    inline const Eigen::Vector3d &aberrationVector() const { return Aberration; }
+
     /**
      * @short compute constant values that need to be computed only once per instance of the application
      */
@@ -148,6 +161,8 @@ class KSNumbers
     double CX, SX, CY, SY, CZ, SZ;
     double CXB, SXB, CYB, SYB, CZB, SZB;
     Eigen::Matrix3d P1, P2, P1B, P2B;
+    Eigen::Matrix3d PN;
+    Eigen::Vector3d Aberration;
     double deltaObliquity, deltaEcLong;
     double e, T;
     long double days; // JD for which the last update was called
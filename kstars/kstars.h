@@ -681,6 +681,9 @@ class KStars : public KXmlGuiWindow
         /** Action slot to save the sky image to a file.*/
         void slotExportImage();
 
+        /** Action slot to save the timing of the sky map rendering recorded by the render profiler. */
+        void slotExportRenderTrace();
+
         /** Action slot to select a DBUS script and run it.*/
         void slotRunScript();
 
@@ -26,6 +26,7 @@
 #include "kswizard.h"
 #include "Options.h"
 #include "skymap.h"
+#include "skymapprofiler.h"
 #include "dialogs/exportimagedialog.h"
 #include "dialogs/finddialog.h"
 #include "dialogs/focusdialog.h"
@@ -1253,6 +1254,19 @@ void KStars::slotExportImage()
     m_ExportImageDialog->show();
 }
 
+void KStars::slotExportRenderTrace()
+{
+    QString fileName = QFileDialog::getSaveFileName(KStars::Instance(), i18n("Export Render Trace"), QDir::homePath(),
+                       i18n("Chrome Trace (*.json);;CSV (*.csv)"));
+
+    //User cancelled file selection dialog - abort trace export
+    if (fileName.isEmpty())
+        return;
+
+    if (!SkyMapProfiler::Instance()->exportTrace(fileName))
+        KSNotification::error(i18n("Unable to save the render trace to %1.", fileName));
+}
+
 void KStars::slotRunScript()
 {
     QUrl fileURL = QFileDialog::getOpenFileUrl(
@@ -25,6 +25,7 @@
 #include "skymap.h"
 #include "texturemanager.h"
 #include "projections/projector.h"
+#include "skycomponents/objectnameindex.h"
 #include "skycomponents/skymapcomposite.h"
 #include "skyobjects/ksplanetbase.h"
 #include "widgets/timespinbox.h"
@@ -156,6 +157,8 @@ void KStars::initActions()
     actionCollection()->addAction("export_image", this, SLOT(slotExportImage()))
             << i18n("&Save Sky Image...")
             << QIcon::fromTheme("document-export-image");
+    actionCollection()->addAction("export_render_trace", this, SLOT(slotExportRenderTrace()))
+            << i18n("Export &Render Trace...");
 
     // 2017-09-17 Jasem: FIXME! Scripting does not work properly under non UNIX systems.
     // It must be updated to use DBus session bus from Qt (like scheduler)
@@ -308,6 +311,10 @@ void KStars::initActions()
     ka->setChecked(Options::showGeoBox());
     ka->setEnabled(Options::showInfoBoxes());
 
+    ka = actionCollection()->add<KToggleAction>("show_render_profiler")
+         << i18n("Show Render &Profiler") << Checked(Options::showRenderProfiler());
+    connect(ka, SIGNAL(toggled(bool)), map(), SLOT(slotToggleRenderProfiler(bool)));
+
     //Toolbar options
     newToggleAction(actionCollection(), "show_mainToolBar", i18n("Show Main Toolbar"), toolBar("kstarsToolBar"),
                     SLOT(setVisible(bool)));
@@ -793,6 +800,9 @@ void KStars::datainitFinished()
     // Connect cache function for Find dialog
     connect(data(), SIGNAL(clearCache()), this, SLOT(clearCachedFindDialog()));
 
+    // Index the object names in the background, for the Find dialog and lookups by name
+    data()->skyComposite()->nameIndex()->update();
+
     //Propagate config settings
     applyConfig(false);
 
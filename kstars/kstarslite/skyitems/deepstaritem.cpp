@@ -30,6 +30,8 @@
 #include "skynodes/pointsourcenode.h"
 #include "skynodes/trixelnode.h"
 
+#include <QMutexLocker>
+
 DeepStarItem::DeepStarItem(DeepStarComponent *deepStarComp, RootNode *rootNode)
     : SkyItem(LabelsItem::label_t::NO_LABEL, rootNode), m_deepStarComp(deepStarComp),
       m_staticStars(deepStarComp->staticStars)
@@ -154,6 +156,8 @@ void DeepStarItem::update()
             //            region.reset();
         }
 
+        // Blocks of dynamic catalogs may be filled from other threads, see DeepStarComponent
+        QMutexLocker locker(m_StarBlockFactory->mutex());
         m_StarBlockFactory->drawID = m_skyMesh->drawID();
 
         int regionID = -1;
@@ -314,6 +314,8 @@ void OpsCatalog::slotStarWidgets(bool on)
     //    kcfg_MagLimitDrawStar->setEnabled(on);
     kcfg_StarDensity->setEnabled(on);
     LabelStarDensity->setEnabled(on);
+    kcfg_StarCacheSize->setEnabled(on);
+    LabelStarCacheSize->setEnabled(on);
     //    kcfg_MagLimitDrawStarZoomOut->setEnabled(on);
     kcfg_StarLabelDensity->setEnabled(on);
     kcfg_ShowStarNames->setEnabled(on);
@@ -71,6 +71,48 @@ Vector2f EquirectangularProjector::toScreenVec(const SkyPoint *o, bool oRefract,
     return p;
 }
 
+int EquirectangularProjector::toScreenBatch(const PointBatch &points, ScreenBatch &screen, VisibilityMask &visible,
+        bool oRefract) const
+{
+    PointBatch const view = toViewBatch(points, oRefract);
+
+    ArrayXd const Y = view.col(2).array().max(-1.0).min(1.0).asin();
+    ArrayXd const X = view.col(1).array().binaryExpr(view.col(0).array(), [](double y, double x)
+    {
+        return std::atan2(y, x);
+    });
+
+    ArrayXd dX;
+    ArrayXd y;
+    if (m_vp.useAltAz)
+    {
+        dX = m_vp.focus->az().radians() - X;
+        y  = 0.5 * m_vp.height - m_vp.zoomFactor * (Y - m_vp.focus->alt().radians());
+    }
+    else
+    {
+        dX = X - m_vp.focus->ra().radians();
+        y  = 0.5 * m_vp.height - m_vp.zoomFactor * (Y - m_vp.focus->dec().radians());
+    }
+
+    // Reduce to [-pi, pi[
+    dX = dX.unaryExpr([](double angle)
+    {
+        return KSUtils::reduceAngle(angle, -dms::PI, dms::PI);
+    });
+
+    ArrayXd const x = 0.5 * m_vp.width - m_vp.zoomFactor * dX;
+
+    screen.resize(points.rows(), 2);
+    screen.col(0) = x.cast<float>().matrix();
+    screen.col(1) = y.cast<float>().matrix();
+
+    visible = (x > 0) && (x < m_vp.width) && (y >= 0) && (y <= m_vp.height);
+    maskGroundBatch(points, visible);
+
+    return static_cast<int>(visible.count());
+}
+
 SkyPoint EquirectangularProjector::fromScreen(const QPointF &p, dms *LST, const dms *lat) const
 {
     SkyPoint result;
@@ -36,6 +36,8 @@ class EquirectangularProjector : public Projector
     double radius() const override;
     bool unusablePoint(const QPointF &p) const override;
     Vector2f toScreenVec(const SkyPoint *o, bool oRefract = true, bool *onVisibleHemisphere = nullptr) const override;
+    int toScreenBatch(const PointBatch &points, ScreenBatch &screen, VisibilityMask &visible,
+                      bool oRefract = true) const override;
     SkyPoint fromScreen(const QPointF &p, dms *LST, const dms *lat) const override;
     QVector<Vector2f> groundPoly(SkyPoint *labelpoint = nullptr, bool *drawLabel = nullptr) const override;
     void updateClipPoly() override;
@@ -39,6 +39,11 @@ double GnomonicProjector::projectionK(double x) const
     return 1.0 / x;
 }
 
+ArrayXd GnomonicProjector::projectionKBatch(const ArrayXd &x) const
+{
+    return x.inverse();
+}
+
 double GnomonicProjector::projectionL(double x) const
 {
     return atan(x);
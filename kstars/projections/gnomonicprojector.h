@@ -36,6 +36,7 @@ class GnomonicProjector : public Projector
     double radius() const override;
     double projectionK(double x) const override;
     double projectionL(double x) const override;
+    ArrayXd projectionKBatch(const ArrayXd &x) const override;
     double cosMaxFieldAngle() const override;
 };
 
@@ -37,6 +37,16 @@ void toXYZ(const SkyPoint *p, double *x, double *y, double *z)
     *y = cosDec * sinRa;
     *z = sinDec;
 }
+
+/** Batched equivalent of SkyPoint::refract(), altitudes in degrees */
+ArrayXd refractBatch(const ArrayXd &alt)
+{
+    static double corrCrit = SkyPoint::refractionCorr(SkyPoint::altCrit);
+
+    ArrayXd const corr = (dms::DegToRad * (alt + 10.3 * (alt + 5.11).inverse())).tan().inverse() * (1.02 / 60);
+    ArrayXd const extrapolated = corrCrit * (alt + 90) / (SkyPoint::altCrit + 90);
+    return alt + (alt > SkyPoint::altCrit).select(corr, extrapolated);
+}
 }
 
 SkyPoint Projector::pointAt(double az)
@@ -243,6 +253,99 @@ bool Projector::checkVisibility(const SkyPoint *p) const
     return dX < m_xrange;
 }
 
+Projector::PointBatch Projector::toViewBatch(const PointBatch &points, bool oRefract) const
+{
+    if (!m_vp.useAltAz)
+        return points;
+
+    Matrix3d const rotation = KSUtils::equatorialToHorizontal(*m_data->lst(), *m_data->geo()->lat());
+    PointBatch view         = points * rotation.transpose();
+
+    if (oRefract && m_vp.useRefraction)
+    {
+        //account for atmospheric refraction, moving each point along its vertical
+        ArrayXd const sinAlt = view.col(2).array().max(-1.0).min(1.0);
+        ArrayXd const cosAlt = (1.0 - sinAlt.square()).max(0.0).sqrt();
+        ArrayXd const alt    = refractBatch(sinAlt.asin() / dms::DegToRad) * dms::DegToRad;
+        ArrayXd const scale  = (cosAlt > 0).select(alt.cos() / cosAlt, 1.0);
+
+        view.col(0).array() *= scale;
+        view.col(1).array() *= scale;
+        view.col(2)          = alt.sin().matrix();
+    }
+
+    return view;
+}
+
+ArrayXd Projector::projectionKBatch(const ArrayXd &x) const
+{
+    return x.unaryExpr([this](double v) { return projectionK(v); });
+}
+
+int Projector::toScreenBatch(const PointBatch &points, ScreenBatch &screen, VisibilityMask &visible, bool oRefract) const
+{
+    PointBatch const view = toViewBatch(points, oRefract);
+
+    // Basis of the tangent plane at the focus, see toScreenVec()
+    double sinX0, cosX0;
+    if (m_vp.useAltAz)
+        m_vp.focus->az().SinCos(sinX0, cosX0);
+    else
+        m_vp.focus->ra().SinCos(sinX0, cosX0);
+
+    Vector3d const center(m_cosY0 * cosX0, m_cosY0 * sinX0, m_sinY0);
+    Vector3d const up(-m_sinY0 * cosX0, -m_sinY0 * sinX0, m_cosY0);
+    // Azimuth increases in the opposite direction compared to RA
+    Vector3d const right = (m_vp.useAltAz ? 1.0 : -1.0) * Vector3d(-sinX0, cosX0, 0);
+
+    //c is the cosine of the angular distance from the center
+    ArrayXd const c = (view * center).array();
+    ArrayXd const k = m_vp.zoomFactor * projectionKBatch(c);
+
+    double const origX = m_vp.width / 2;
+    double const origY = m_vp.height / 2;
+
+    ArrayXd x = origX + k * (view * right).array();
+    ArrayXd y = origY - k * (view * up).array();
+#ifdef KSTARS_LITE
+    double skyRotation = SkyMapLite::Instance()->getSkyRotation();
+    if (skyRotation != 0)
+    {
+        dms rotation(skyRotation);
+        double cosT, sinT;
+
+        rotation.SinCos(sinT, cosT);
+
+        ArrayXd const newX = origX + (x - origX) * cosT - (y - origY) * sinT;
+        ArrayXd const newY = origY + (x - origX) * sinT + (y - origY) * cosT;
+
+        x = newX;
+        y = newY;
+    }
+#endif
+
+    screen.resize(points.rows(), 2);
+    screen.col(0) = x.cast<float>().matrix();
+    screen.col(1) = y.cast<float>().matrix();
+
+    //If c is less than cosMaxFieldAngle(), the point is on the back side of the celestial sphere
+    visible = (c > cosMaxFieldAngle()) && (x >= 0) && (x <= m_vp.width) && (y >= 0) && (y <= m_vp.height);
+    maskGroundBatch(points, visible);
+
+    return static_cast<int>(visible.count());
+}
+
+void Projector::maskGroundBatch(const PointBatch &points, VisibilityMask &visible) const
+{
+    //Skip objects below the horizon if the ground is drawn, see checkVisibility()
+    if (m_vp.fillGround)
+    {
+        Matrix3d const rotation = KSUtils::equatorialToHorizontal(*m_data->lst(), *m_data->geo()->lat());
+        Vector3d const zenith   = rotation.row(2).transpose();
+        visible = visible && ((points * zenith).array() >= std::sin(-1.0 * dms::DegToRad));
+    }
+}
+
 // FIXME: There should be a MUCH more efficient way to do this (see EyepieceField for example)
 double Projector::findNorthPA(SkyPoint *o, float x, float y) const
 {
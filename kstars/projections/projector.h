@@ -212,6 +212,46 @@ class Projector
      */
     bool checkVisibility(const SkyPoint *p) const;
 
+    /** Unit vectors of a batch of points, one row per point, each coordinate being stored contiguously */
+    typedef Matrix<double, Dynamic, 3> PointBatch;
+
+    /** Screen coordinates of a batch of points, one row per point */
+    typedef Matrix<float, Dynamic, 2> ScreenBatch;
+
+    /** Visibility of a batch of points */
+    typedef Array<bool, Dynamic, 1> VisibilityMask;
+
+    /**
+     * Set a row of a batch of points to the unit vector of the current equatorial coordinates of a point,
+     * that is (cos Dec cos RA, cos Dec sin RA, sin Dec). This only uses the cached sine and cosine of the
+     * coordinates, so no trigonometric function is evaluated.
+     */
+    static inline void setBatchPoint(PointBatch &points, int row, const SkyPoint *p)
+    {
+        double sinRA, cosRA, sinDec, cosDec;
+        p->ra().SinCos(sinRA, cosRA);
+        p->dec().SinCos(sinDec, cosDec);
+        points(row, 0) = cosDec * cosRA;
+        points(row, 1) = cosDec * sinRA;
+        points(row, 2) = sinDec;
+    }
+
+    /**
+     * Project a batch of points to screen coordinates.
+     *
+     * This is the batched equivalent of projecting each point with toScreenVec() and checking the result
+     * with onScreen(), each step being evaluated for the whole batch at once. Like checkVisibility(), points
+     * more than one degree below the horizon are not visible if the ground is filled.
+     *
+     * @param points unit vectors of the current equatorial coordinates of the points, @see setBatchPoint()
+     * @param screen receives the screen coordinates of the points
+     * @param visible receives whether each point is visible on screen
+     * @param oRefract whether to apply atmospheric refraction, if the view uses it
+     * @return the number of visible points
+     */
+    virtual int toScreenBatch(const PointBatch &points, ScreenBatch &screen, VisibilityMask &visible,
+                              bool oRefract = true) const;
+
     /**
      * Determine the on-screen position angle of a SkyPont with recept with NCP.
      * This is the object's sky position angle (w.r.t. North).
@@ -270,6 +310,27 @@ class Projector
      */
     virtual double projectionL(double x) const { return x; }
 
+    /**
+     * Batched equivalent of projectionK(). The default implementation calls projectionK() for each value.
+     * @see toScreenBatch()
+     */
+    virtual ArrayXd projectionKBatch(const ArrayXd &x) const;
+
+    /**
+     * Transform a batch of equatorial unit vectors to the coordinate system of the view, applying refraction
+     * if the view is in horizontal coordinates. Horizontal unit vectors are (cos Alt cos Az, cos Alt sin Az, sin Alt).
+     * @see toScreenBatch()
+     */
+    PointBatch toViewBatch(const PointBatch &points, bool oRefract) const;
+
+    /**
+     * Clear the visibility of the points of a batch that are below the horizon when the ground is filled,
+     * like checkVisibility() does.
+     * @param points unit vectors of the current equatorial coordinates of the points
+     * @param visible visibility of the points, updated in place
+     */
+    void maskGroundBatch(const PointBatch &points, VisibilityMask &visible) const;
+
     /**
      * This function returns the cosine of the maximum field angle, i.e., the maximum angular
      * distance from the focus for which a point should be projected. Default is 0, i.e.,
@@ -39,6 +39,11 @@ double StereographicProjector::projectionK(double x) const
     return 2.0 / (1.0 + x);
 }
 
+ArrayXd StereographicProjector::projectionKBatch(const ArrayXd &x) const
+{
+    return 2.0 * (x + 1.0).inverse();
+}
+
 double StereographicProjector::projectionL(double x) const
 {
     return 2.0 * atan2(x, 2.0);
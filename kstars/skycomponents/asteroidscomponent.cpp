@@ -234,25 +234,13 @@ void AsteroidsComponent::draw(SkyPainter *skyp)
 
 SkyObject *AsteroidsComponent::objectNearest(SkyPoint *p, double &maxrad)
 {
-    SkyObject *oBest = nullptr;
-
     if (!selected())
         return nullptr;
 
-    for (auto o : m_ObjectList)
+    return indexedObjectNearest(p, maxrad, [](SkyObject *o)
     {
-        if (!((dynamic_cast<KSAsteroid*>(o)->toDraw())))
-            continue;
-
-        double r = o->angularDistanceTo(p).Degrees();
-        if (r < maxrad)
-        {
-            oBest  = o;
-            maxrad = r;
-        }
-    }
-
-    return oBest;
+        return dynamic_cast<KSAsteroid *>(o)->toDraw();
+    });
 }
 
 void AsteroidsComponent::updateDataFile(bool isAutoUpdate)
@@ -65,6 +65,7 @@ void CatalogComponent::_loadData(bool includeCatalogDesignation)
     QList<QPair<int, QString>> names;
 
     KStarsData::Instance()->catalogdb()->GetAllObjects(m_catName, m_ObjectList, names, this, includeCatalogDesignation);
+    invalidateIndex();
 
     for (const auto &name : names)
     {
@@ -28,10 +28,18 @@
 #include "skymap.h"
 #endif
 #include "skypainter.h"
+#include "htmesh/HTMesh.h"
 #include "htmesh/MeshIterator.h"
 #include "skycomponents/skymapcomposite.h"
 
 #include <QHash>
+#include <QtConcurrent>
+
+#include <cmath>
+#include <numeric>
+
+// Level of the mesh of the constellation lookup table: 8192 trixels, about 3 degrees wide
+#define LOOKUP_MESH_LEVEL 5
 
 ConstellationBoundaryLines::ConstellationBoundaryLines(SkyComposite *parent)
     : NoPrecessIndex(parent, i18n("Constellation Boundaries"))
@@ -148,6 +156,12 @@ ConstellationBoundaryLines::ConstellationBoundaryLines(SkyComposite *parent)
         appendLine(lineList);
     if (polyList.get())
         appendPoly(polyList, idxFile, verbose);
+
+    buildLookupTable();
+}
+
+ConstellationBoundaryLines::~ConstellationBoundaryLines()
+{
 }
 
 bool ConstellationBoundaryLines::selected()
@@ -203,56 +217,68 @@ void ConstellationBoundaryLines::appendPoly(const std::shared_ptr<PolyList> &pol
         printf("PolyList: %3d: %d\n", ++m_polyIndexCnt, indexHash.size());
 }
 
-PolyList *ConstellationBoundaryLines::ContainingPoly(SkyPoint *p)
+void ConstellationBoundaryLines::buildLookupTable()
 {
-    //printf("called ContainingPoly(p)\n");
-
-    // we save the pointers in a hash because most often there is only one
-    // constellation and we can avoid doing the expensive boundary calculations
-    // and just return it if we know it is unique.  We can avoid this minor
-    // complication entirely if we use index(p) instead of aperture(p, r)
-    // because index(p) always returns a single trixel index.
-
-    QHash<PolyList *, bool> polyHash;
-    QHash<PolyList *, bool>::const_iterator iter;
-
-    //printf("\n");
+    m_lookupMesh.reset(new HTMesh(LOOKUP_MESH_LEVEL, LOOKUP_MESH_LEVEL));
+    m_lookupTable.resize(m_lookupMesh->size());
 
-    // the boundaries don't precess so we use index() not aperture()
-    m_skyMesh->index(p, 1.0, IN_CONSTELL_BUF);
-    MeshIterator region(m_skyMesh, IN_CONSTELL_BUF);
-    while (region.hasNext())
+    for (Trixel trixel = 0; trixel < m_lookupMesh->size(); trixel++)
     {
-        Trixel trixel = region.next();
-        //printf("Trixel: %4d %s\n", trixel, m_skyMesh->indexToName( trixel ) );
+        // Find the circle around the trixel, from the center of its vertices
+        double ra[3], dec[3];
+        m_lookupMesh->vertices(trixel, &ra[0], &dec[0], &ra[1], &dec[1], &ra[2], &dec[2]);
 
-        std::shared_ptr<PolyListList> polyListList = m_polyIndex[trixel];
+        double x = 0, y = 0, z = 0;
+        for (int i = 0; i < 3; i++)
+        {
+            x += cos(dec[i] * dms::DegToRad) * cos(ra[i] * dms::DegToRad);
+            y += cos(dec[i] * dms::DegToRad) * sin(ra[i] * dms::DegToRad);
+            z += sin(dec[i] * dms::DegToRad);
+        }
+        SkyPoint center(dms(atan2(y, x) / dms::DegToRad).reduce(), dms(atan2(z, sqrt(x * x + y * y)) / dms::DegToRad));
 
-        //printf("    size: %d\n", polyListList->size() );
+        double radius = 0;
+        for (int i = 0; i < 3; i++)
+        {
+            SkyPoint vertex(dms(ra[i]), dms(dec[i]));
+            radius = std::max(radius, center.angularDistanceTo(&vertex).Degrees());
+        }
 
-        for (const auto &item : *polyListList)
+        // Gather the boundaries that ContainingPoly() used to find for any point of the trixel, which searched
+        // the boundary index within one degree of the point
+        m_skyMesh->index(&center, radius + 1.0, IN_CONSTELL_BUF);
+        MeshIterator region(m_skyMesh, IN_CONSTELL_BUF);
+        QVector<PolyList *> &polyLists = m_lookupTable[trixel];
+        while (region.hasNext())
         {
-            polyHash.insert(item.get(), true);
+            for (const auto &item : *m_polyIndex[region.next()])
+            {
+                if (!polyLists.contains(item.get()))
+                    polyLists.append(item.get());
+            }
         }
+        polyLists.squeeze();
     }
+}
 
-    iter = polyHash.constBegin();
+PolyList *ConstellationBoundaryLines::ContainingPoly(const SkyPoint *p) const
+{
+    if (m_lookupTable.isEmpty())
+        return nullptr;
+
+    // the boundaries don't precess so we use ra() and dec()
+    const QVector<PolyList *> &polyLists = m_lookupTable[m_lookupMesh->index(p->ra().Degrees(), p->dec().Degrees())];
 
     // Don't bother with boundaries if there is only one
-    if (polyHash.size() == 1)
-        return iter.key();
+    if (polyLists.size() == 1)
+        return polyLists.first();
 
     QPointF point(p->ra().Hours(), p->dec().Degrees());
     QPointF wrapPoint(p->ra().Hours() - 24.0, p->dec().Degrees());
     bool wrapRA = p->ra().Hours() > 12.0;
 
-    while (iter != polyHash.constEnd())
+    for (PolyList *polyList : polyLists)
     {
-        PolyList *polyList = iter.key();
-        iter++;
-
-        //qDebug() << QString("checking %1 boundary\n").arg( polyList->name() );
-
         const QPolygonF *poly = polyList->poly();
         if (wrapRA && polyList->wrapRA())
         {
@@ -278,10 +304,46 @@ QString ConstellationBoundaryLines::constellationName(SkyPoint *p)
 {
     PolyList *polyList = ContainingPoly(p);
     if (polyList)
+        return name(polyList);
+
+    return i18n("Unknown");
+}
+
+QStringList ConstellationBoundaryLines::constellationName(const QList<SkyPoint *> &points)
+{
+    QVector<PolyList *> polyLists(points.size());
+    QVector<int> indexes(points.size());
+    std::iota(indexes.begin(), indexes.end(), 0);
+
+    QtConcurrent::blockingMap(indexes, [&](int i)
     {
-        return (Options::useLocalConstellNames() ?
-                    i18nc("Constellation name (optional)", polyList->name().toUpper().toLocal8Bit().data()) :
-                    polyList->name());
+        polyLists[i] = ContainingPoly(points[i]);
+    });
+
+    // Names are localized once per constellation
+    QHash<PolyList *, QString> names;
+    QStringList result;
+    result.reserve(points.size());
+    for (PolyList *polyList : polyLists)
+    {
+        if (polyList == nullptr)
+        {
+            result.append(i18n("Unknown"));
+            continue;
+        }
+
+        auto name = names.constFind(polyList);
+        if (name == names.constEnd())
+            name = names.insert(polyList, this->name(polyList));
+        result.append(name.value());
     }
-    return i18n("Unknown");
+
+    return result;
+}
+
+QString ConstellationBoundaryLines::name(PolyList *polyList) const
+{
+    return (Options::useLocalConstellNames() ?
+                i18nc("Constellation name (optional)", polyList->name().toUpper().toLocal8Bit().data()) :
+                polyList->name());
 }
@@ -21,7 +21,11 @@
 
 #include <QHash>
 #include <QPolygonF>
+#include <QStringList>
 
+#include <memory>
+
+class HTMesh;
 class PolyList;
 class ConstellationBoundary;
 class KSFileReader;
@@ -33,6 +37,10 @@ typedef QVector<std::shared_ptr<PolyListList>> PolyIndex;
  * @class ConstellationBoundary
  * Collection of lines comprising the borders between constellations
  *
+ * Constellations are looked up through a table built at load time, which lists the boundaries that may
+ * contain the points of each trixel of a fine mesh. Trixels inside a single constellation map straight
+ * to it, and only the points of trixels crossed by a boundary are tested against the boundaries.
+ *
  * @author Jason Harris
  * @version 0.1
  */
@@ -50,10 +58,17 @@ class ConstellationBoundaryLines : public NoPrecessIndex
      * of boundary-line intervals that divide two particular constellations.
      */
     explicit ConstellationBoundaryLines(SkyComposite *parent);
-    virtual ~ConstellationBoundaryLines() override = default;
+    ~ConstellationBoundaryLines() override;
 
     QString constellationName(SkyPoint *p);
 
+    /**
+     * @short Find the constellations of many points at once.
+     * The points are looked up in parallel.
+     * @return the constellation name of each point, in the same order.
+     */
+    QStringList constellationName(const QList<SkyPoint *> &points);
+
     bool selected() override;
 
     void preDraw(SkyPainter *skyp) override;
@@ -68,9 +83,21 @@ class ConstellationBoundaryLines : public NoPrecessIndex
      */
     void appendPoly(std::shared_ptr<PolyList> &polyList, KSFileReader *file, int debug);
 
-    PolyList *ContainingPoly(SkyPoint *p);
+    /** @short builds the constellation lookup table from the boundary index. */
+    void buildLookupTable();
+
+    /** @note thread-safe, the lookup table is read-only once built. */
+    PolyList *ContainingPoly(const SkyPoint *p) const;
+
+    /** @return the name of the constellation, localized if required. */
+    QString name(PolyList *polyList) const;
 
     SkyMesh *m_skyMesh { nullptr };
     PolyIndex m_polyIndex;
     int m_polyIndexCnt { 0 };
+
+    /** Fine mesh of the lookup table */
+    std::unique_ptr<HTMesh> m_lookupMesh;
+    /** Boundaries that may contain the points of each trixel of m_lookupMesh */
+    QVector<QVector<PolyList *>> m_lookupTable;
 };
@@ -370,6 +370,13 @@ void DeepSkyComponent::loadData()
             objectLists(type).append(QPair<QString, SkyObject *>(longname, o));
         }
 
+        //Add the secondary designation, such as "NGC 224" for M 31, so that it can be searched too
+        if (hasName && !name2.isEmpty() && name2 != name && name2 != longname)
+        {
+            objectNames(type).append(name2);
+            objectLists(type).append(QPair<QString, SkyObject *>(name2, o));
+        }
+
         deep_sky_parser.ShowProgress();
     }
 
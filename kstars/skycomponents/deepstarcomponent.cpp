@@ -34,6 +34,9 @@
 #include <QtConcurrent>
 #include <QElapsedTimer>
 
+#include <algorithm>
+#include <cmath>
+
 #include <kstars_debug.h>
 
 #ifdef _WIN32
@@ -53,6 +56,7 @@ DeepStarComponent::DeepStarComponent(SkyComposite *parent, QString fileName, flo
 
 DeepStarComponent::~DeepStarComponent()
 {
+    m_loader.waitForFinished();
     if (fileOpened)
         starReader.closeFile();
     fileOpened = false;
@@ -107,6 +111,9 @@ bool DeepStarComponent::loadStaticStars()
     if (htm_level != m_skyMesh->level())
         qCWarning(KSTARS) << "HTM Level in shallow star data file and HTM Level in m_skyMesh do not match. EXPECT TROUBLE!";
 
+    // Records follow the faint magnitude, HTM level and MSpT fields read above
+    quint64 offset = starReader.getDataOffset() + 5;
+
     // JM 2012-12-05: Breaking into 2 loops instead of one previously with multiple IF checks for recordSize
     // While the CPU branch prediction might not suffer any penalties since the branch prediction after a few times
     // should always gets it right. It's better to do it this way to avoid any chances since the compiler might not optimize it.
@@ -126,32 +133,31 @@ bool DeepStarComponent::loadStaticStars()
 
             for (quint64 j = 0; j < records; ++j)
             {
-                bool fread_success = fread(&stardata, sizeof(StarData), 1, dataFile);
+                /* Get the record, swapping bytes when required */
+                const StarData *record = readRecord(starReader, offset, stardata);
+                offset += sizeof(StarData);
 
-                if (!fread_success)
+                if (!record)
                 {
                     qCCritical(KSTARS) << "ERROR: Could not read StarData structure for star #" << j << " under trixel #"
                              << trixel;
+                    continue;
                 }
 
-                /* Swap Bytes when required */
-                if (starReader.getByteSwap())
-                    byteSwap(&stardata);
-
                 /* Initialize star with data just read. */
                 StarObject *star;
 #ifdef KSTARS_LITE
-                star = &(SB->addStar(stardata)->star);
+                star = &(SB->addStar(*record)->star);
 #else
-                star = SB->addStar(stardata);
+                star = SB->addStar(*record);
 #endif
                 if (star)
                 {
                     //KStarsData* data = KStarsData::Instance();
                     //star->EquatorialToHorizontal( data->lst(), data->geo()->lat() );
                     //if( star->getHDIndex() != 0 )
-                    if (stardata.HD)
-                        m_CatalogNumber.insert(stardata.HD, star);
+                    if (record->HD)
+                        m_CatalogNumber.insert(record->HD, star);
                 }
                 else
                 {
@@ -177,25 +183,23 @@ bool DeepStarComponent::loadStaticStars()
 
             for (quint64 j = 0; j < records; ++j)
             {
-                bool fread_success = false;
-                fread_success      = fread(&deepstardata, sizeof(DeepStarData), 1, dataFile);
+                /* Get the record, swapping bytes when required */
+                const DeepStarData *record = readRecord(starReader, offset, deepstardata);
+                offset += sizeof(DeepStarData);
 
-                if (!fread_success)
+                if (!record)
                 {
                     qCCritical(KSTARS) << "Could not read StarData structure for star #" << j << " under trixel #"
                              << trixel;
+                    continue;
                 }
 
-                /* Swap Bytes when required */
-                if (starReader.getByteSwap())
-                    byteSwap(&deepstardata);
-
                 /* Initialize star with data just read. */
                 StarObject *star;
 #ifdef KSTARS_LITE
-                star = &(SB->addStar(stardata)->star);
+                star = &(SB->addStar(*record)->star);
 #else
-                star = SB->addStar(deepstardata);
+                star = SB->addStar(*record);
 #endif
                 if (star)
                 {
@@ -311,6 +315,13 @@ void DeepStarComponent::draw(SkyPainter *skyp)
 
     visibleStarCount = 0;
 
+    // Blocks may be recycled while loading the next trixel, so stars are drawn trixel by trixel
+    QVector<StarObject *> starBatch;
+
+    // Mapped catalogs are loaded in the background, and stars that are not loaded yet are drawn once they are
+    bool const loadInBackground = (!staticStars && starReader.isMapped());
+    QMutexLocker locker(m_StarBlockFactory->mutex());
+
     t.start();
 
     // Mark used blocks in the LRU Cache. Not required for static stars
@@ -321,15 +332,11 @@ void DeepStarComponent::draw(SkyPainter *skyp)
             Trixel currentRegion = region.next();
             for (int i = 0; i < m_starBlockList.at(currentRegion)->getBlockCount(); ++i)
             {
-                std::shared_ptr<StarBlock> prevBlock = ((i >= 1) ? m_starBlockList.at(currentRegion)->block(i - 1) : std::shared_ptr<StarBlock>());
-                std::shared_ptr<StarBlock> block     = m_starBlockList.at(currentRegion)->block(i);
-
-                if (i == 0 && !m_StarBlockFactory->markFirst(block))
-                    qCWarning(KSTARS) << "markFirst failed in trixel" << currentRegion;
-                if (i > 0 && !m_StarBlockFactory->markNext(prevBlock, block))
-                    qCWarning(KSTARS) << "markNext failed in trixel" << currentRegion << "while marking block" << i;
-                if (i < m_starBlockList.at(currentRegion)->getBlockCount() &&
-                    m_starBlockList.at(currentRegion)->block(i)->getFaintMag() < maglim)
+                std::shared_ptr<StarBlock> block = m_starBlockList.at(currentRegion)->block(i);
+
+                if (!m_StarBlockFactory->mark(block))
+                    qCWarning(KSTARS) << "mark failed in trixel" << currentRegion << "while marking block" << i;
+                if (block->getFaintMag() < maglim)
                     break;
             }
         }
@@ -351,8 +358,13 @@ void DeepStarComponent::draw(SkyPainter *skyp)
         if ((int)currentRegion >= m_starBlockList.size())
             continue;
 
-        if (!staticStars && !m_starBlockList.at(currentRegion)->fillToMag(maglim) &&
-            maglim <= m_FaintMagnitude * (1 - 1.5 / 16))
+        if (loadInBackground)
+        {
+            if (m_starBlockList.at(currentRegion)->needsFill(maglim))
+                queueLoad(currentRegion, maglim);
+        }
+        else if (!staticStars && !m_starBlockList.at(currentRegion)->fillToMag(maglim) &&
+                 maglim <= m_FaintMagnitude * (1 - 1.5 / 16))
         {
             qCWarning(KSTARS) << "SBL::fillToMag( " << maglim << " ) failed for trixel " << currentRegion;
         }
@@ -375,6 +387,8 @@ void DeepStarComponent::draw(SkyPainter *skyp)
 
         QtConcurrent::blockingMap(m_starBlockList.at(currentRegion)->contents(), mapFunction);
 
+        // Collect the stars of the trixel, and project and draw them as one batch
+        starBatch.clear();
         for (int i = 0; i < m_starBlockList.at(currentRegion)->getBlockCount(); ++i)
         {
             std::shared_ptr<StarBlock> block = m_starBlockList.at(currentRegion)->block(i);
@@ -387,20 +401,28 @@ void DeepStarComponent::draw(SkyPainter *skyp)
                 //                qDebug() << "We claim that he's from trixel " << currentRegion
                 //<< ", and indexStar says he's from " << m_skyMesh->indexStar( curStar );
 
-                float mag = curStar->mag();
-
-                if (mag > maglim)
+                if (curStar->mag() > maglim)
                     break;
 
-                if (skyp->drawPointSource(curStar, mag, curStar->spchar()))
-                    visibleStarCount++;
+                starBatch.append(curStar);
             }
         }
 
+        visibleStarCount += skyp->drawPointSources(starBatch);
+
         // DEBUG: Uncomment to identify problems with Star Block Factory / preservation of Magnitude Order in the LRU Cache
         //        verifySBLIntegrity();
         t_drawUnnamed += t.restart();
     }
+
+    // Load ahead the trixels that will come into view if the map keeps moving the same way
+    if (loadInBackground)
+    {
+        loadAhead(focus, radius, maglim);
+        locker.unlock();
+        startLoader();
+    }
+
     m_skyMesh->inDraw(false);
 #ifdef PROFILE_SINCOS
     trig_calls_here += dms::trig_function_calls;
@@ -426,6 +448,137 @@ void DeepStarComponent::draw(SkyPainter *skyp)
 #endif
 }
 
+void DeepStarComponent::loadAhead(const SkyPoint *focus, double radius, float maglim)
+{
+    bool moving = false, zooming = false;
+    SkyPoint ahead(focus->ra(), focus->dec());
+    double nextRadius  = radius;
+    float nextMagLim   = maglim;
+
+    if (m_hasLastFocus)
+    {
+        // One field of view further along the motion of the focus since the last draw
+        moving = (focus->angularDistanceTo(&m_lastFocus).Degrees() > 1.0e-3 * radius);
+        if (moving)
+            ahead = focus->moveAway(m_lastFocus, radius * 3600.0);
+
+        // Zooming in or out goes on at the same rate
+        zooming = (m_lastRadius > 0 && fabs(radius - m_lastRadius) > 1.0e-3 * radius);
+        if (zooming)
+        {
+            nextRadius = std::min(radius * radius / m_lastRadius, 90.0);
+            nextMagLim = std::min(std::max(maglim, 2 * maglim - m_lastMagLim), m_FaintMagnitude);
+        }
+    }
+
+    m_lastFocus    = SkyPoint(focus->ra(), focus->dec());
+    m_lastRadius   = radius;
+    m_lastMagLim   = maglim;
+    m_hasLastFocus = true;
+
+    if (!moving && !zooming)
+        return;
+
+    m_skyMesh->aperture(&ahead, std::max(radius, nextRadius) + 1.0, PREFETCH_BUF);
+
+    MeshIterator region(m_skyMesh, PREFETCH_BUF);
+    while (region.hasNext())
+    {
+        Trixel trixel = region.next();
+
+        if ((int)trixel < m_starBlockList.size() && m_starBlockList.at(trixel)->needsFill(nextMagLim))
+            queueLoad(trixel, nextMagLim);
+    }
+}
+
+void DeepStarComponent::queueLoad(Trixel trixel, float maglim)
+{
+    QMutexLocker locker(&m_pendingLock);
+
+    auto pending = m_pendingLoads.find(trixel);
+    if (pending == m_pendingLoads.end())
+        m_pendingLoads.insert(trixel, maglim);
+    else if (*pending < maglim)
+        *pending = maglim;
+}
+
+void DeepStarComponent::startLoader()
+{
+    QMutexLocker locker(&m_pendingLock);
+
+    if (m_loaderRunning || m_pendingLoads.isEmpty())
+        return;
+
+    m_loaderRunning = true;
+    m_loader        = QtConcurrent::run(this, &DeepStarComponent::loadPending);
+}
+
+bool DeepStarComponent::waitForPendingLoads()
+{
+    bool waited = false;
+
+    forever
+    {
+        startLoader();
+
+        QFuture<void> loader;
+        {
+            QMutexLocker locker(&m_pendingLock);
+            if (!m_loaderRunning)
+                return waited;
+            loader = m_loader;
+        }
+
+        loader.waitForFinished();
+        waited = true;
+    }
+}
+
+void DeepStarComponent::loadPending()
+{
+    QMutex *blockMutex = StarBlockFactory::Instance()->mutex();
+
+    forever
+    {
+        QHash<Trixel, float> batch;
+        {
+            QMutexLocker locker(&m_pendingLock);
+            if (m_pendingLoads.isEmpty())
+            {
+                m_loaderRunning = false;
+                return;
+            }
+            batch.swap(m_pendingLoads);
+        }
+
+        // Ask the system to read the whole batch at once
+        {
+            QMutexLocker locker(blockMutex);
+            for (auto it = batch.constBegin(); it != batch.constEnd(); ++it)
+                m_starBlockList.at(it.key())->prefetch();
+        }
+
+        // Blocks are filled without the lock and appended under it, so that drawing does not wait for the disk
+        bool loaded = false;
+        for (auto it = batch.constBegin(); it != batch.constEnd(); ++it)
+        {
+            bool trixelLoaded = false;
+
+            if (!m_starBlockList.at(it.key())->loadToMag(it.value(), trixelLoaded) &&
+                    it.value() <= m_FaintMagnitude * (1 - 1.5 / 16))
+                qCWarning(KSTARS) << "SBL::loadToMag( " << it.value() << " ) failed for trixel " << it.key();
+
+            loaded |= trixelLoaded;
+        }
+
+#ifndef KSTARS_LITE
+        // Redraw with the new stars. Nothing is redrawn if no star could be loaded, so a failing trixel does not loop
+        if (loaded)
+            QMetaObject::invokeMethod(SkyMap::Instance(), "forceUpdate", Qt::QueuedConnection);
+#endif
+    }
+}
+
 bool DeepStarComponent::openDataFile()
 {
     if (starReader.getFileHandle())
@@ -465,6 +618,8 @@ bool DeepStarComponent::openDataFile()
         ret = fread(&MSpT, 2, 1, starReader.getFileHandle());
         if (starReader.getByteSwap())
             MSpT = bswap_16(MSpT);
+        if (!starReader.mapFile())
+            qCInfo(KSTARS) << "Could not map" << dataFileName << "in memory, reading it from disk instead.";
         fileOpened = true;
         qCInfo(KSTARS) << "  Sky Mesh Size: " << m_skyMesh->size();
         for (long int i = 0; i < m_skyMesh->size(); i++)
@@ -498,6 +653,7 @@ StarObject *DeepStarComponent::findByHDIndex(int HDnum)
 SkyObject *DeepStarComponent::objectNearest(SkyPoint *p, double &maxrad)
 {
     StarObject *oBest = nullptr;
+    std::shared_ptr<StarBlock> bestBlock;
 
 #ifdef KSTARS_LITE
     m_zoomMagLimit = StarComponent::zoomMagnitudeLimit();
@@ -508,6 +664,7 @@ SkyObject *DeepStarComponent::objectNearest(SkyPoint *p, double &maxrad)
     m_skyMesh->index(p, maxrad + 1.0, OBJ_NEAREST_BUF);
 
     MeshIterator region(m_skyMesh, OBJ_NEAREST_BUF);
+    QMutexLocker locker(StarBlockFactory::Instance()->mutex());
 
     while (region.hasNext())
     {
@@ -535,13 +692,18 @@ SkyObject *DeepStarComponent::objectNearest(SkyPoint *p, double &maxrad)
                 double r = star->angularDistanceTo(p).Degrees();
                 if (r < maxrad)
                 {
-                    oBest  = star;
-                    maxrad = r;
+                    oBest     = star;
+                    bestBlock = block;
+                    maxrad    = r;
                 }
             }
         }
     }
 
+    // The caller keeps the star, so its block must not be recycled by the background loader
+    if (bestBlock && !staticStars)
+        bestBlock->pinned = true;
+
     // TODO: What if we are looking around a point that's not on
     // screen? objectNearest() will need to keep on filling up all
     // trixels around the SkyPoint to find the best match in case it
@@ -574,6 +736,8 @@ bool DeepStarComponent::starsInAperture(QList<StarObject *> &list, const SkyPoin
     if (maglim < -28)
         maglim = m_FaintMagnitude;
 
+    QMutexLocker locker(StarBlockFactory::Instance()->mutex());
+
     while (region.hasNext())
     {
         Trixel currentRegion = region.next();
@@ -594,7 +758,12 @@ bool DeepStarComponent::starsInAperture(QList<StarObject *> &list, const SkyPoin
                 if (star->mag() > maglim)
                     break; // Stars are organized by magnitude, so this should work
                 if (star->angularDistanceTo(&center).Degrees() <= radius)
+                {
                     list.append(star);
+                    // The caller keeps the star, so its block must not be recycled by the background loader
+                    if (!staticStars)
+                        block->pinned = true;
+                }
             }
         }
     }
@@ -644,13 +813,9 @@ bool DeepStarComponent::verifySBLIntegrity()
                          << ", brightMag of block #" << i << " = " << block->getBrightMag();
                 integrity = false;
             }
-            if (i > 1 && (!block->prev))
-                qCWarning(KSTARS) << "Trixel " << trixel << ": ERROR: Block" << i << "is unlinked in LRU Cache";
-            if (block->prev && block->prev->parent == m_starBlockList[trixel].get() &&
-                block->prev != m_starBlockList[trixel]->block(i - 1))
+            if (block->parent != m_starBlockList[trixel].get())
             {
-                qCWarning(KSTARS) << "Trixel " << trixel
-                         << ": ERROR: SBF LRU Cache linked list seems to be broken at before block " << i;
+                qCWarning(KSTARS) << "Trixel " << trixel << ": ERROR: Block" << i << "belongs to another trixel";
                 integrity = false;
             }
             faintMag = block->getFaintMag();
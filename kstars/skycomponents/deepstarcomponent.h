@@ -31,8 +31,15 @@
 #include "listcomponent.h"
 #include "starblockfactory.h"
 #include "skyobjects/deepstardata.h"
+#include "skyobjects/skypoint.h"
 #include "skyobjects/stardata.h"
 
+#include <QFuture>
+#include <QHash>
+#include <QMutex>
+
+#include <cstring>
+
 class SkyLabeler;
 class SkyMesh;
 class StarBlockFactory;
@@ -80,6 +87,7 @@ class DeepStarComponent : public ListComponent
 
     /**
      * @return Nearest star within maxrad of SkyPoint p, or nullptr if not found
+     * @note The block of the star is pinned in the cache, so the star stays valid
      */
     SkyObject *objectNearest(SkyPoint *p, double &maxrad) override;
 
@@ -89,6 +97,13 @@ class DeepStarComponent : public ListComponent
 
     bool verifySBLIntegrity();
 
+    /**
+     * @short Wait until the background loader has filled every queued trixel
+     * @note Meant for tests and benchmarks that need the stars of the current view to be loaded
+     * @return true if there were trixels to load
+     */
+    bool waitForPendingLoads();
+
     /**
      * @short Add to the given list, the stars from this component,
      * that lie within the specified circular aperture, and that are
@@ -103,6 +118,7 @@ class DeepStarComponent : public ListComponent
      * @p list The list to operate on
      * @return false if the limiting magnitude is brighter than the
      * trigger magnitude of the DeepStarComponent
+     * @note The blocks of the stars are pinned in the cache, so the stars stay valid
      */
     bool starsInAperture(QList<StarObject *> &list, const SkyPoint &center, float radius, float maglim = -29);
 
@@ -110,9 +126,66 @@ class DeepStarComponent : public ListComponent
     static void byteSwap(DeepStarData *stardata);
     static void byteSwap(StarData *stardata);
 
+    /**
+     * @short Get a StarData or DeepStarData record of a catalog
+     *
+     * If the catalog is mapped in memory, the record is used straight from the map when
+     * it needs neither byte swapping nor alignment, and is copied to buffer otherwise.
+     * If it is not mapped, the record is read in buffer from the current position of the
+     * file handle, which must be at offset.
+     *
+     * @param reader the catalog file
+     * @param offset offset of the record in the file
+     * @param buffer storage for the record, if it needs to be read or decoded
+     * @return pointer to the record, or nullptr if it could not be read
+     */
+    template <typename T>
+    static const T *readRecord(const BinFileHelper &reader, quint64 offset, T &buffer)
+    {
+        if (reader.isMapped())
+        {
+            const char *data = reader.getMappedData(offset, sizeof(T));
+            if (!data)
+                return nullptr;
+            if (!reader.getByteSwap() && reinterpret_cast<quintptr>(data) % alignof(T) == 0)
+                return reinterpret_cast<const T *>(data);
+            memcpy(&buffer, data, sizeof(T));
+        }
+        else if (fread(&buffer, sizeof(T), 1, reader.getFileHandle()) != 1)
+            return nullptr;
+
+        if (reader.getByteSwap())
+            byteSwap(&buffer);
+        return &buffer;
+    }
+
     static StarBlockFactory m_StarBlockFactory;
 
   private:
+    /**
+     * @short Queue the trixels about to come into view for background loading
+     *
+     * The next field of view is predicted from the motion of the focus and from the zoom
+     * trend since the last draw.
+     *
+     * @param focus current focus of the map
+     * @param radius radius of the field of view, in degrees
+     * @param maglim current magnitude limit
+     */
+    void loadAhead(const SkyPoint *focus, double radius, float maglim);
+
+    /**
+     * @short Queue a trixel to be filled up to a magnitude limit in the background
+     * @note The queue has its own lock, so this may be called with or without the StarBlockFactory lock held
+     */
+    void queueLoad(Trixel trixel, float maglim);
+
+    /** @short Start the background loader if there are trixels to load and it is not running */
+    void startLoader();
+
+    /** @short Background loader, fills the queued trixels until the queue is empty */
+    void loadPending();
+
     SkyMesh *m_skyMesh { nullptr };
     KSNumbers m_reindexNum;
 
@@ -137,6 +210,18 @@ class DeepStarComponent : public ListComponent
 
     bool staticStars { false };
 
+    /// Focus, field of view radius and magnitude limit at the last draw, to follow the motion of the map
+    SkyPoint m_lastFocus;
+    double m_lastRadius { 0 };
+    float m_lastMagLim { 0 };
+    bool m_hasLastFocus { false };
+
+    /// Trixels waiting to be loaded in the background, with the magnitude limit to fill them to
+    QHash<Trixel, float> m_pendingLoads;
+    QMutex m_pendingLock;
+    bool m_loaderRunning { false };
+    QFuture<void> m_loader;
+
     // Stuff required for reading data
     DeepStarData deepstardata;
     StarData stardata;
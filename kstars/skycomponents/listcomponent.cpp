@@ -18,6 +18,8 @@
 #include "listcomponent.h"
 
 #include "kstarsdata.h"
+#include "skymesh.h"
+#include "htmesh/MeshIterator.h"
 #ifndef KSTARS_LITE
 #include "skymap.h"
 #endif
@@ -43,6 +45,8 @@ void ListComponent::clear()
         removeFromNames(o);
         delete o;
     }
+
+    m_IndexValid = false;
 }
 
 void ListComponent::appendListObject(SkyObject *object)
@@ -54,6 +58,8 @@ void ListComponent::appendListObject(SkyObject *object)
     m_ObjectHash.insert(object->name().toLower(), object);
     m_ObjectHash.insert(object->longname().toLower(), object);
     m_ObjectHash.insert(object->name2().toLower(), object);
+
+    m_IndexValid = false;
 }
 
 void ListComponent::update(KSNumbers *num)
@@ -79,15 +85,72 @@ SkyObject *ListComponent::objectNearest(SkyPoint *p, double &maxrad)
     if (!selected())
         return nullptr;
 
+    return indexedObjectNearest(p, maxrad);
+}
+
+SkyObject *ListComponent::indexedObjectNearest(SkyPoint *p, double &maxrad,
+        const std::function<bool(SkyObject *)> &accept)
+{
+    if (!isIndexValid())
+        buildIndex();
+
     SkyObject *oBest = nullptr;
-    foreach (SkyObject *o, m_ObjectList)
+    MeshIterator region(SkyMesh::Instance(), OBJ_NEAREST_BUF);
+
+    while (region.hasNext())
     {
-        double r = o->angularDistanceTo(p).Degrees();
-        if (r < maxrad)
+        auto trixel = m_ObjectIndex.constFind(region.next());
+        if (trixel == m_ObjectIndex.constEnd())
+            continue;
+
+        for (SkyObject *o : *trixel)
         {
-            oBest  = o;
-            maxrad = r;
+            if (accept && !accept(o))
+                continue;
+
+            double r = o->angularDistanceTo(p).Degrees();
+            if (r < maxrad)
+            {
+                oBest  = o;
+                maxrad = r;
+            }
         }
     }
     return oBest;
 }
+
+void ListComponent::buildIndex()
+{
+    SkyMesh *skyMesh = SkyMesh::Instance();
+
+    m_ObjectIndex.clear();
+    m_ObjectTrixels.resize(m_ObjectList.size());
+
+    for (int i = 0; i < m_ObjectList.size(); i++)
+    {
+        Trixel trixel = skyMesh->index(m_ObjectList[i]);
+        m_ObjectTrixels[i] = trixel;
+        m_ObjectIndex[trixel].append(m_ObjectList[i]);
+    }
+
+    m_IndexValid = true;
+}
+
+void ListComponent::updateIndex()
+{
+    if (!isIndexValid())
+        return;
+
+    SkyMesh *skyMesh = SkyMesh::Instance();
+
+    for (int i = 0; i < m_ObjectList.size(); i++)
+    {
+        Trixel trixel = skyMesh->index(m_ObjectList[i]);
+        if (trixel == m_ObjectTrixels[i])
+            continue;
+
+        m_ObjectIndex[m_ObjectTrixels[i]].removeOne(m_ObjectList[i]);
+        m_ObjectIndex[trixel].append(m_ObjectList[i]);
+        m_ObjectTrixels[i] = trixel;
+    }
+}
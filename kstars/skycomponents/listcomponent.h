@@ -18,8 +18,13 @@
 #pragma once
 
 #include "skycomponent.h"
+#include "typedef.h"
 
+#include <QHash>
 #include <QList>
+#include <QVector>
+
+#include <functional>
 
 class SkyComposite;
 class SkyMap;
@@ -28,6 +33,11 @@ class SkyMap;
  * @class ListComponent
  * An abstract parent class, to be inherited by SkyComponents that store a QList of SkyObjects.
  *
+ * The objects are indexed by trixel of the SkyMesh so that objectNearest() only looks at the objects
+ * close to the search point. The index is built on the first search, and rebuilt after objects are
+ * added through appendListObject(), or after invalidateIndex() is called. Components whose objects
+ * move call updateIndex() after updating their positions.
+ *
  * @author Jason Harris
  * @version 0.1
  */
@@ -69,6 +79,38 @@ class ListComponent : public SkyComponent
     void appendListObject(SkyObject * object);
 
   protected:
+    /**
+     * @short Find the nearest object among the objects in the trixels of the OBJ_NEAREST_BUF aperture.
+     *
+     * The aperture must have been set up by the caller, as SkyMapComposite::objectNearest() does.
+     * @param p search point
+     * @param maxrad search radius in degrees, set to the distance of the object found if any
+     * @param accept optional filter, objects for which it returns false are ignored
+     * @return the nearest object closer than maxrad, or nullptr
+     */
+    SkyObject *indexedObjectNearest(SkyPoint *p, double &maxrad,
+                                    const std::function<bool(SkyObject *)> &accept = nullptr);
+
+    /**
+     * @short Move the objects whose position changed to their new trixel.
+     *
+     * Only the objects that changed trixel are moved. Does nothing if the index was not built yet.
+     */
+    void updateIndex();
+
+    /** @short Rebuild the index on the next search. Call after adding or removing objects of m_ObjectList directly. */
+    void invalidateIndex() { m_IndexValid = false; }
+
     QList<SkyObject *> m_ObjectList;
     QHash<QString, SkyObject *> m_ObjectHash;
+
+  private:
+    bool isIndexValid() const { return m_IndexValid && m_ObjectTrixels.size() == m_ObjectList.size(); }
+    void buildIndex();
+
+    /// Objects of m_ObjectList by trixel
+    QHash<Trixel, QVector<SkyObject *>> m_ObjectIndex;
+    /// Trixel of each object of m_ObjectList, in the same order
+    QVector<Trixel> m_ObjectTrixels;
+    bool m_IndexValid { false };
 };
@@ -0,0 +1,342 @@
+/***************************************************************************
+                 objectnameindex.cpp  -  K Desktop Planetarium
+                             -------------------
+    begin                : 2026-10-18
+    copyright            : (C) 2026 by agent
+    email                : agent@local
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "objectnameindex.h"
+
+#include <QtConcurrent>
+
+#include <algorithm>
+#include <numeric>
+
+// Most approximate matches returned by a search
+#define MAX_APPROXIMATE_MATCHES 50
+
+namespace
+{
+/** @return the distinct trigrams of the key, each packed in an integer. */
+QVector<quint64> trigrams(const QStringRef &key)
+{
+    QVector<quint64> result;
+    for (int i = 0; i + 3 <= key.size(); i++)
+        result.append(quint64(key.at(i).unicode()) << 32 | quint64(key.at(i + 1).unicode()) << 16 |
+                      key.at(i + 2).unicode());
+
+    std::sort(result.begin(), result.end());
+    result.erase(std::unique(result.begin(), result.end()), result.end());
+    return result;
+}
+}
+
+/** Normalized names of an object list, sorted and indexed by trigram. */
+class ObjectNameIndex::Table
+{
+  public:
+    explicit Table(const QVector<Entry> &list);
+
+    /** @short Append the entries whose key starts with the argument key, then the entries containing it. */
+    void match(const QString &key, QVector<Entry> &prefixed, QVector<Entry> &others) const;
+
+    /** @short Append the entries sharing at least minCount of the trigrams, with the number of trigrams shared. */
+    void matchTrigrams(const QVector<quint64> &grams, int minCount, QVector<QPair<int, Entry>> &matches) const;
+
+    /** @return the first object whose key is the argument key, or nullptr. */
+    const SkyObject *find(const QString &key) const;
+
+    /** Shallow copy of the indexed object list, which the list detaches from when changed */
+    QVector<Entry> entries;
+
+  private:
+    QStringRef key(int i) const { return QStringRef(&m_Keys, m_Offsets[i], m_Offsets[i + 1] - m_Offsets[i]); }
+
+    /** @return the first position in m_Sorted whose key is not less than the argument key. */
+    QVector<int>::const_iterator lowerBound(const QString &key) const;
+
+    /** All keys, concatenated to save memory */
+    QString m_Keys;
+    /** Offset of each key in m_Keys, followed by the size of m_Keys */
+    QVector<int> m_Offsets;
+    /** Entries sorted by key */
+    QVector<int> m_Sorted;
+    /** Entries by trigram of their key */
+    QHash<quint64, QVector<int>> m_Trigrams;
+};
+
+ObjectNameIndex::Table::Table(const QVector<Entry> &list) : entries(list)
+{
+    m_Offsets.reserve(entries.size() + 1);
+    m_Offsets.append(0);
+    for (const Entry &entry : entries)
+    {
+        m_Keys += normalize(entry.first);
+        m_Offsets.append(m_Keys.size());
+    }
+
+    m_Sorted.resize(entries.size());
+    std::iota(m_Sorted.begin(), m_Sorted.end(), 0);
+    std::stable_sort(m_Sorted.begin(), m_Sorted.end(), [this](int a, int b)
+    {
+        return key(a).compare(key(b)) < 0;
+    });
+
+    for (int i = 0; i < entries.size(); i++)
+    {
+        for (quint64 gram : trigrams(key(i)))
+            m_Trigrams[gram].append(i);
+    }
+}
+
+QVector<int>::const_iterator ObjectNameIndex::Table::lowerBound(const QString &key) const
+{
+    return std::lower_bound(m_Sorted.constBegin(), m_Sorted.constEnd(), key, [this](int i, const QString &k)
+    {
+        return this->key(i).compare(k) < 0;
+    });
+}
+
+void ObjectNameIndex::Table::match(const QString &key, QVector<Entry> &prefixed, QVector<Entry> &others) const
+{
+    for (auto i = lowerBound(key); i != m_Sorted.constEnd() && this->key(*i).startsWith(key); ++i)
+        prefixed.append(entries[*i]);
+
+    // Keys shorter than a trigram would have to be searched in every name, they only match the start of names
+    if (key.size() < 3)
+        return;
+
+    auto contains = [&](int i)
+    {
+        QStringRef const ref = this->key(i);
+        return ref.size() > key.size() && !ref.startsWith(key) && ref.contains(key);
+    };
+
+    // Candidates hold every trigram of the key, so scan the shortest list of entries by trigram
+    const QVector<int> *candidates = nullptr;
+    for (quint64 gram : trigrams(QStringRef(&key)))
+    {
+        auto list = m_Trigrams.constFind(gram);
+        if (list == m_Trigrams.constEnd())
+            return;
+        if (candidates == nullptr || list->size() < candidates->size())
+            candidates = &list.value();
+    }
+
+    for (int i : *candidates)
+    {
+        if (contains(i))
+            others.append(entries[i]);
+    }
+}
+
+void ObjectNameIndex::Table::matchTrigrams(const QVector<quint64> &grams, int minCount,
+        QVector<QPair<int, Entry>> &matches) const
+{
+    QHash<int, int> counts;
+    for (quint64 gram : grams)
+    {
+        auto list = m_Trigrams.constFind(gram);
+        if (list == m_Trigrams.constEnd())
+            continue;
+        for (int i : list.value())
+            counts[i]++;
+    }
+
+    for (auto count = counts.constBegin(); count != counts.constEnd(); ++count)
+    {
+        if (count.value() >= minCount)
+            matches.append(qMakePair(count.value(), entries[count.key()]));
+    }
+}
+
+const SkyObject *ObjectNameIndex::Table::find(const QString &key) const
+{
+    auto i = lowerBound(key);
+    if (i != m_Sorted.constEnd() && this->key(*i).compare(key) == 0)
+        return entries[*i].second;
+
+    return nullptr;
+}
+
+ObjectNameIndex::ObjectNameIndex(const ObjectLists &lists) : m_Lists(lists)
+{
+}
+
+ObjectNameIndex::~ObjectNameIndex()
+{
+    m_Build.waitForFinished();
+}
+
+QString ObjectNameIndex::normalize(const QString &name)
+{
+    QString key;
+    key.reserve(name.size());
+    for (const QChar &c : name)
+    {
+        if (!c.isSpace())
+            key += c.toLower();
+    }
+    return key;
+}
+
+ObjectNameIndex::Tables ObjectNameIndex::build(const ObjectLists &lists)
+{
+    Tables tables;
+    for (auto list = lists.constBegin(); list != lists.constEnd(); ++list)
+        tables.insert(list.key(), QSharedPointer<const Table>(new Table(list.value())));
+
+    return tables;
+}
+
+void ObjectNameIndex::collect()
+{
+    if (!m_Build.isFinished() || m_Build.resultCount() == 0)
+        return;
+
+    Tables const tables = m_Build.result();
+    for (auto table = tables.constBegin(); table != tables.constEnd(); ++table)
+        m_Tables.insert(table.key(), table.value());
+
+    m_Build = QFuture<Tables>();
+}
+
+void ObjectNameIndex::update()
+{
+    if (m_Build.isRunning())
+        return;
+
+    collect();
+
+    // The copies share their data with the object lists, so this is cheap and safe to pass to the thread
+    ObjectLists changed;
+    for (auto list = m_Lists.constBegin(); list != m_Lists.constEnd(); ++list)
+    {
+        if (table(list.key(), list.value()) == nullptr)
+            changed.insert(list.key(), list.value());
+    }
+
+    if (!changed.isEmpty())
+        m_Build = QtConcurrent::run(&ObjectNameIndex::build, changed);
+}
+
+const ObjectNameIndex::Table *ObjectNameIndex::table(int type, const QVector<Entry> &list) const
+{
+    const Table *table = m_Tables.value(type).data();
+    if (table && table->entries.constData() == list.constData() && table->entries.size() == list.size())
+        return table;
+
+    return nullptr;
+}
+
+QVector<ObjectNameIndex::Entry> ObjectNameIndex::search(const QString &text, const QList<int> &types)
+{
+    collect();
+
+    QString const key = normalize(text);
+    if (key.isEmpty())
+        return QVector<Entry>();
+
+    QVector<Entry> prefixed, others;
+    QVector<const Table *> tables;
+    bool outdated = false;
+
+    for (int type : (types.isEmpty() ? m_Lists.keys() : types))
+    {
+        auto list = m_Lists.constFind(type);
+        if (list == m_Lists.constEnd())
+            continue;
+
+        const Table *typeTable = table(type, list.value());
+        if (typeTable)
+        {
+            typeTable->match(key, prefixed, others);
+            tables.append(typeTable);
+            continue;
+        }
+
+        // Not indexed yet, scan the list
+        outdated = true;
+        for (const Entry &entry : list.value())
+        {
+            QString const name = normalize(entry.first);
+            if (name.startsWith(key))
+                prefixed.append(entry);
+            else if (key.size() >= 3 && name.contains(key))
+                others.append(entry);
+        }
+    }
+
+    if (outdated)
+        update();
+
+    if (!prefixed.isEmpty() || !others.isEmpty())
+        return prefixed + others;
+
+    // Nothing contains the text, so look for the names sharing most of its trigrams, as with a typo
+    QVector<quint64> const grams = trigrams(QStringRef(&key));
+    if (grams.size() < 2)
+        return QVector<Entry>();
+
+    QVector<QPair<int, Entry>> matches;
+    for (const Table *typeTable : tables)
+        typeTable->matchTrigrams(grams, (2 * grams.size() + 2) / 3, matches);
+
+    std::stable_sort(matches.begin(), matches.end(), [](const QPair<int, Entry> &a, const QPair<int, Entry> &b)
+    {
+        return a.first > b.first;
+    });
+
+    QVector<Entry> result;
+    for (int i = 0; i < matches.size() && i < MAX_APPROXIMATE_MATCHES; i++)
+        result.append(matches[i].second);
+
+    return result;
+}
+
+const SkyObject *ObjectNameIndex::find(const QString &name)
+{
+    collect();
+
+    QString const key = normalize(name);
+    if (key.isEmpty())
+        return nullptr;
+
+    bool outdated = false;
+    const SkyObject *object = nullptr;
+
+    for (auto list = m_Lists.constBegin(); list != m_Lists.constEnd() && object == nullptr; ++list)
+    {
+        const Table *typeTable = table(list.key(), list.value());
+        if (typeTable)
+        {
+            object = typeTable->find(key);
+            continue;
+        }
+
+        outdated = true;
+        for (const Entry &entry : list.value())
+        {
+            if (normalize(entry.first) == key)
+            {
+                object = entry.second;
+                break;
+            }
+        }
+    }
+
+    if (outdated)
+        update();
+
+    return object;
+}
@@ -0,0 +1,94 @@
+/***************************************************************************
+                 objectnameindex.h  -  K Desktop Planetarium
+                             -------------------
+    begin                : 2026-10-18
+    copyright            : (C) 2026 by agent
+    email                : agent@local
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#pragma once
+
+#include <QFuture>
+#include <QHash>
+#include <QList>
+#include <QPair>
+#include <QSharedPointer>
+#include <QString>
+#include <QVector>
+
+class SkyObject;
+
+/**
+ * @class ObjectNameIndex
+ * @short Index of the names of the sky objects, for fast name searches.
+ *
+ * The index is built from the object lists of the SkyMapComposite, one table per object type. Names are
+ * normalized to lower case without spaces, so that "M31", "m 31" and "M 31" are the same key. Each table
+ * keeps its keys sorted for prefix searches, and a trigram index for substring and approximate searches.
+ *
+ * Tables are built on a background thread. A table is rebuilt when the object list of its type changes,
+ * which is detected because the table holds a shallow copy of the list: any change to the list detaches it
+ * from the copy. Until the new table is ready, searches of that type scan the list.
+ *
+ * The index must be used from the main thread only.
+ *
+ * @version 1.0
+ */
+class ObjectNameIndex
+{
+  public:
+    typedef QPair<QString, const SkyObject *> Entry;
+    typedef QHash<int, QVector<Entry>> ObjectLists;
+
+    /** @param lists object lists to index, by object type. They must outlive the index. */
+    explicit ObjectNameIndex(const ObjectLists &lists);
+
+    ~ObjectNameIndex();
+
+    /** @short Start indexing the object lists that changed since they were last indexed, on a background thread. */
+    void update();
+
+    /**
+     * @short Search objects by name.
+     * @param text text to search, normalized like the names.
+     * @param types object types to search, or all types if empty.
+     * @return objects whose name starts with the text first, then objects whose name contains the text.
+     * If there is none, objects whose name shares most trigrams with the text, best matches first.
+     * Texts shorter than 3 characters only match the start of names.
+     */
+    QVector<Entry> search(const QString &text, const QList<int> &types = QList<int>());
+
+    /**
+     * @short Find an object by its normalized name.
+     * @return the first object found with this name, or nullptr.
+     */
+    const SkyObject *find(const QString &name);
+
+    /** @return the name in lower case without spaces. */
+    static QString normalize(const QString &name);
+
+  private:
+    class Table;
+    typedef QHash<int, QSharedPointer<const Table>> Tables;
+
+    static Tables build(const ObjectLists &lists);
+
+    /** @short Take the tables built in the background, if done. */
+    void collect();
+
+    /** @return the table of the type if it is up to date with the object list, or nullptr. */
+    const Table *table(int type, const QVector<Entry> &list) const;
+
+    const ObjectLists &m_Lists;
+    Tables m_Tables;
+    QFuture<Tables> m_Build;
+};
@@ -25,6 +25,7 @@
 #include "Options.h"
 #include "kstarsdata.h" // MINZOOM
 #include "skymap.h"
+#include "skymapprofiler.h"
 #include "projections/projector.h"
 
 //---------------------------------------------------------------------------//
@@ -166,6 +167,7 @@ bool SkyLabeler::drawGuideLabel(QPointF &o, const QString &text, double angle)
     m_p.drawText(QPointF(-w2, h), text);
     m_p.restore(); //reset coordinate system
 
+    SkyMapProfiler::Instance()->count(SkyMapProfiler::LABELLED);
     return true;
 }
 
@@ -190,6 +192,7 @@ bool SkyLabeler::drawNameLabel(SkyObject *obj, const QPointF &_p)
         zoomFont.setPointSizeF(newPointSize);
         m_p.setFont(zoomFont);
         m_p.drawText(p, sLabel);
+        SkyMapProfiler::Instance()->count(SkyMapProfiler::LABELLED);
         return true;
     }
 }
@@ -662,6 +665,7 @@ void SkyLabeler::drawRudeNameLabel(SkyObject *obj, const QPointF &p)
     color.setAlpha(m_p.pen().color().alpha()); //same transparency for the text and the background
     m_p.fillRect(rect2, QBrush(color));
     m_p.drawText(rect.topLeft(), sLabel);
+    SkyMapProfiler::Instance()->count(SkyMapProfiler::LABELLED);
 }
 
 //----- Diagnostic and information routines -----
@@ -39,8 +39,10 @@
 #endif
 #include "kstarsdata.h"
 #include "milkyway.h"
+#include "objectnameindex.h"
 #include "satellitescomponent.h"
 #include "skylabeler.h"
+#include "skymapprofiler.h"
 #include "skypainter.h"
 #include "solarsystemcomposite.h"
 #include "starcomponent.h"
@@ -61,6 +63,7 @@
 #endif
 
 #include <QApplication>
+#include <QThread>
 
 #include <kstars_debug.h>
 
@@ -69,6 +72,7 @@ SkyMapComposite::SkyMapComposite(SkyComposite *parent) : SkyComposite(parent), m
     m_skyLabeler.reset(SkyLabeler::Instance());
     m_skyMesh.reset(SkyMesh::Create(3)); // level 5 mesh = 8192 trixels
     m_skyMesh->debug(0);
+    m_NameIndex.reset(new ObjectNameIndex(m_ObjectLists));
     //  1 => print "indexing ..."
     //  2 => prints totals too
     // 10 => prints detailed lists
@@ -182,15 +186,23 @@ SkyMapComposite::SkyMapComposite(SkyComposite *parent) : SkyComposite(parent), m
     connect(this, SIGNAL(progressText(QString)), KStarsData::Instance(), SIGNAL(progressText(QString)));
 }
 
+SkyMapComposite::~SkyMapComposite()
+{
+}
+
 void SkyMapComposite::update(KSNumbers *num)
 {
+    SkyMapProfiler::Timer timer;
+
     //printf("updating SkyMapComposite\n");
     //1. Milky Way
     //m_MilkyWay->update( data, num );
     //2. Coordinate grid
     //m_EquatorialCoordinateGrid->update( num );
+    timer.start("Horizontal Grid");
     m_HorizontalCoordinateGrid->update(num);
 #ifndef KSTARS_LITE
+    timer.start("Local Meridian");
     m_LocalMeridianComponent->update(num);
 #endif
     //3. Constellation boundaries
@@ -198,6 +210,7 @@ void SkyMapComposite::update(KSNumbers *num)
     //4. Constellation lines
     //m_CLines->update( data, num );
     //5. Constellation names
+    timer.start("Constellation Names");
     if (m_CNames)
         m_CNames->update(num);
     //6. Equator
@@ -207,6 +220,7 @@ void SkyMapComposite::update(KSNumbers *num)
     //8. Deep sky
     //m_DeepSky->update( data, num );
     //9. Custom catalogs
+    timer.start("Custom Catalogs");
     m_CustomCatalogs->update(num);
     m_internetResolvedComponent->update(num);
     m_manualAdditionsComponent->update(num);
@@ -215,27 +229,34 @@ void SkyMapComposite::update(KSNumbers *num)
     //m_CLines->update( data, num );  // MUST follow stars.
 
     //12. Solar system
+    timer.start("Solar System");
     m_SolarSystem->update(num);
     //13. Satellites
+    timer.start("Satellites");
     m_Satellites->update(num);
     //14. Supernovae
+    timer.start("Supernovae");
     m_Supernovae->update(num);
     //15. Horizon
+    timer.start("Horizon");
     m_Horizon->update(num);
 #ifndef KSTARS_LITE
     //16. Flags
+    timer.start("Flags");
     m_Flags->update(num);
 #endif
 }
 
 void SkyMapComposite::updateSolarSystemBodies(KSNumbers *num)
 {
+    SkyMapProfiler::Timer timer("Solar System Bodies");
     m_SolarSystem->updateSolarSystemBodies(num);
 }
 
 
 void SkyMapComposite::updateMoons(KSNumbers *num )
 {
+    SkyMapProfiler::Timer timer("Moons");
     m_SolarSystem->updateMoons( num );
 }
 
@@ -311,16 +332,20 @@ void SkyMapComposite::draw(SkyPainter *skyp)
             }
     }
 
+    SkyMapProfiler::Timer timer("Milky Way");
     m_MilkyWay->draw(skyp);
 
     // Draw HIPS after milky way but before everything else
+    timer.start("HiPS");
     m_HiPS->draw(skyp);
 
+    timer.start("Coordinate Grids");
     m_EquatorialCoordinateGrid->draw(skyp);
     m_HorizontalCoordinateGrid->draw(skyp);
     m_LocalMeridianComponent->draw(skyp);
 
     //Draw constellation boundary lines only if we draw western constellations
+    timer.start("Constellation Bounds & Art");
     if (m_Cultures->current() == "Western")
     {
         m_CBoundLines->draw(skyp);
@@ -331,27 +356,37 @@ void SkyMapComposite::draw(SkyPainter *skyp)
         m_ConstellationArt->draw(skyp);
     }
 
+    timer.start("Constellation Lines");
     m_CLines->draw(skyp);
 
+    timer.start("Equator");
     m_Equator->draw(skyp);
 
+    timer.start("Ecliptic");
     m_Ecliptic->draw(skyp);
 
+    timer.start("Deep Sky");
     m_DeepSky->draw(skyp);
 
+    timer.start("Custom Catalogs");
     m_CustomCatalogs->draw(skyp);
     m_internetResolvedComponent->draw(skyp);
     m_manualAdditionsComponent->draw(skyp);
 
+    timer.start("Stars");
     m_Stars->draw(skyp);
 
+    timer.start("Solar System");
     m_SolarSystem->drawTrails(skyp);
     m_SolarSystem->draw(skyp);
 
+    timer.start("Satellites");
     m_Satellites->draw(skyp);
 
+    timer.start("Supernovae");
     m_Supernovae->draw(skyp);
 
+    timer.start("Labels");
     map->drawObjectLabels(labelObjects());
 
     m_skyLabeler->drawQueuedLabels();
@@ -359,19 +394,25 @@ void SkyMapComposite::draw(SkyPainter *skyp)
     m_Stars->drawLabels();
     m_DeepSky->drawLabels();
 
+    timer.start("Observing List");
     m_ObservingList->pen = QPen(QColor(data->colorScheme()->colorNamed("ObsListColor")), 1.);
     m_ObservingList->list2 = KStarsData::Instance()->observingList()->sessionList();
     m_ObservingList->draw(skyp);
 
+    timer.start("Flags");
     m_Flags->draw(skyp);
 
+    timer.start("Star Hop Route");
     m_StarHopRouteList->pen = QPen(QColor(data->colorScheme()->colorNamed("StarHopRouteColor")), 1.);
     m_StarHopRouteList->draw(skyp);
 
+    timer.start("Horizon");
     m_ArtificialHorizon->draw(skyp);
 
     m_Horizon->draw(skyp);
 
+    timer.stop();
+
     m_skyMesh->inDraw(false);
 
     // DEBUG Edit. Keywords: Trixel boundaries. Currently works only in QPainter mode
@@ -623,6 +664,10 @@ SkyObject *SkyMapComposite::findByName(const QString &name)
     if (o)
         return o;
 
+    // The name index ignores case and spaces, so that "M31" finds "M 31". It is not thread-safe.
+    if (QThread::currentThread() == thread())
+        return const_cast<SkyObject *>(m_NameIndex->find(name));
+
     return nullptr;
 }
 
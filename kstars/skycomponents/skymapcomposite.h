@@ -49,6 +49,7 @@ class HorizonComponent;
 class KSPlanet;
 class KSPlanetBase;
 class MilkyWay;
+class ObjectNameIndex;
 class SatellitesComponent;
 class SkyMap;
 class SkyObject;
@@ -81,7 +82,7 @@ class SkyMapComposite : public QObject, public SkyComposite
      */
     explicit SkyMapComposite(SkyComposite *parent = nullptr);
 
-    virtual ~SkyMapComposite() override = default;
+    ~SkyMapComposite() override;
 
     void update(KSNumbers *num = nullptr) override;
 
@@ -148,12 +149,17 @@ class SkyMapComposite : public QObject, public SkyComposite
      * all be checked for a match.
      * @note Overloaded from SkyComposite.  In this version, we search
      * the most likely object classes first to be more efficient.
+     * If no component knows the name, it is looked up in the name index,
+     * which ignores case and spaces.
      * @p name the name to be matched
      * @return a pointer to the SkyObject whose name matches
      * the argument, or a nullptr pointer if no match was found.
      */
     SkyObject *findByName(const QString &name) override;
 
+    /** @return the index of the object names, for searches by name. */
+    inline ObjectNameIndex *nameIndex() { return m_NameIndex.get(); }
+
     /**
      * @return the list of objects in the region defined by skypoints
      * @param p1 first sky point (top-left vertex of rectangular region)
@@ -278,6 +284,7 @@ class SkyMapComposite : public QObject, public SkyComposite
     QList<SkyObject *> m_LabeledObjects;
     QHash<int, QStringList> m_ObjectNames;
     QHash<int, QVector<QPair<QString, const SkyObject *>>> m_ObjectLists;
+    std::unique_ptr<ObjectNameIndex> m_NameIndex;
     QHash<QString, QString> m_ConstellationNames;
     QString m_internetResolvedCat; // Holds the name of the internet resolved catalog
     QString m_manualAdditionsCat;
@@ -69,6 +69,8 @@ void SolarSystemListComponent::updateSolarSystemBodies(KSNumbers *num)
             if (p->hasTrail())
                 p->updateTrail(data->lst(), data->geo()->lat());
         }
+
+        updateIndex();
     }
 }
 
@@ -42,7 +42,7 @@ StarNode::~StarNode()
 #endif
 
 StarBlock::StarBlock(int nstars)
-    : faintMag(-5), brightMag(35), parent(nullptr), prev(nullptr), next(nullptr), drawID(0), nStars(0),
+    : faintMag(-5), brightMag(35), parent(nullptr), drawID(0), nStars(0),
 #ifdef KSTARS_LITE
       stars(nstars, StarNode())
 #else
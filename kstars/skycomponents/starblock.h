@@ -60,6 +60,9 @@ class StarBlock
     typedef StarObject StarBlockEntry;
 #endif
 
+    /** Number of stars held by the blocks of dynamically loaded catalogs */
+    static constexpr int DEFAULT_SIZE = 100;
+
     /**
      * Constructor
      *
@@ -67,7 +70,7 @@ class StarBlock
      *
      * @param nstars   Number of stars to hold in this StarBlock
      */
-    explicit StarBlock(int nstars = 100);
+    explicit StarBlock(int nstars = DEFAULT_SIZE);
 
     ~StarBlock() = default;
 
@@ -146,9 +149,12 @@ class StarBlock
     float faintMag { 0 };
     float brightMag { 0 };
     StarBlockList *parent;
-    std::shared_ptr<StarBlock> prev;
-    std::shared_ptr<StarBlock> next;
-    quint32 drawID { 0 };
+    quint32 drawID { 0 }; // Last draw cycle this block was used in
+    /**
+     * The block is never recycled if set: it is being filled by the background loader, or pointers
+     * to its stars were handed out, see DeepStarComponent::objectNearest() and starsInAperture()
+     */
+    bool pinned { false };
 
   private:
     // Disallow copying and assignment. Just in case.
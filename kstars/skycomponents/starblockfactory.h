@@ -19,14 +19,24 @@
 
 #include "typedef.h"
 
+#include <QMutex>
+#include <QVector>
+
+#include <memory>
+
 class StarBlock;
 
 /**
  * @class StarBlockFactory
  *
  * @short A factory that creates StarBlocks and recycles them in an LRU Cache
+ *
+ * Blocks are stamped with the current draw cycle when they are used, instead of being
+ * moved in a linked list. The least recently used blocks are looked up when a block has
+ * to be recycled, which only happens once the memory budget of the cache is reached.
+ *
  * @author Akarsh Simha
- * @version 0.1
+ * @version 0.2
  */
 
 class StarBlockFactory
@@ -36,39 +46,28 @@ class StarBlockFactory
 
     /**
      * Destructor
-     * Deletes the linked list that maintains the Cache, sets the pointer to nullptr
+     * Drops the blocks of the cache, sets the pointer to nullptr
      */
     ~StarBlockFactory();
 
     /**
      * @short  Return a StarBlock available for use
      *
-     * This method first checks if there are any cached StarBlocks that are not in use.
-     * If such a StarBlock is found, it returns the same for use. Else it freshly allocates
-     * a StarBlock and returns the same. It also moves the StarBlock to the front, marking it
-     * as the most recently used. If the StarBlock had a parent StarBlockList, this method
-     * detaches the StarBlock from the StarBlockList
+     * This method allocates a new StarBlock as long as the cache is within its memory budget.
+     * Past the budget, it recycles the least recently used StarBlock that is neither used in the
+     * current draw cycle nor pinned, detaching it from its StarBlockList. If every StarBlock is in
+     * use, a StarBlock is allocated anyway, so that the stars in view are drawn.
      *
      * @return A StarBlock that is available for use
      */
     std::shared_ptr<StarBlock> getBlock();
 
     /**
-     * @short  Mark a StarBlock as most recently used and sync its drawID with the current drawID
+     * @short  Mark a StarBlock as used in the current draw cycle
      *
-     * @return true on success, false if the StarBlock supplied was not on our list at all
+     * @return true on success, false if no StarBlock was supplied
      */
-    bool markFirst(std::shared_ptr<StarBlock>& block);
-
-    /**
-     * @short  Rank a given StarBlock after another given StarBlock in the LRU list
-     * and sync its drawID with the current drawID
-     *
-     * @param  after  The block after which 'block' should be put
-     * @param  block  The block to mark for use
-     * @return true on success, false on failure
-     */
-    bool markNext(std::shared_ptr<StarBlock>& after, std::shared_ptr<StarBlock>& block);
+    bool mark(const std::shared_ptr<StarBlock> &block);
 
     /**
      * @short  Returns the number of StarBlocks currently produced
@@ -78,42 +77,62 @@ class StarBlockFactory
     inline int getBlockCount() const { return nBlocks; }
 
     /**
-     * @short  Frees all StarBlocks that are in the cache
-     * @return The number of StarBlocks freed
+     * @short  Set the memory budget of the cache
+     *
+     * Blocks above the budget are not freed at once, they are recycled first.
+     *
+     * @param  megabytes  Memory for star blocks, in MB
      */
-    inline int freeAll() { return deleteBlocks(nBlocks); }
+    void setCacheSize(int megabytes);
 
     /**
-     * @short  Frees all StarBlocks that are not used in this draw cycle
-     * @return The number of StarBlocks freed
+     * @short  Returns the number of StarBlocks the cache holds before recycling them
      */
-    int freeUnused();
+    inline int getCacheSize() const { return nCache; }
 
     /**
      * @short  Prints the structure of the cache, for debugging
      */
     void printStructure() const;
 
+    /**
+     * @short  Lock serializing the use of the cache and of the dynamic StarBlockLists
+     *
+     * Star blocks may be filled in the background, see DeepStarComponent. Code that reads or
+     * changes the blocks of dynamically loaded StarBlockLists must hold this lock.
+     */
+    inline QMutex *mutex() { return &blockMutex; }
+
     quint32 drawID; // A number identifying the current draw cycle
 
   private:
     /**
      * Constructor
-     * Initializes first and last StarBlock pointers to nullptr
+     * Sets the memory budget of the cache from the options
      */
     StarBlockFactory();
 
     /**
-     * @short  Deletes the N least recently used blocks
+     * @short  Find the least recently used block that can be recycled
+     *
+     * A block can be recycled if it is not used in this draw cycle, if it is not pinned and if it
+     * is the last block of its StarBlockList, as blocks are released from the end of the list.
      *
-     * @param  nblocks  Number of blocks to delete
-     * @return Number of blocks successfully deleted
+     * The candidates are sorted by age on the first call of a draw cycle only. Once they are used
+     * up, no block is recycled until the next draw cycle.
+     *
+     * @return The block to recycle, or nullptr if there is none
      */
-    int deleteBlocks(int nblocks);
+    std::shared_ptr<StarBlock> findUnusedBlock();
+
+    bool isRecyclable(const std::shared_ptr<StarBlock> &block) const;
 
-    std::shared_ptr<StarBlock> first, last; // Pointers to the beginning and end of the linked list
+    QVector<std::shared_ptr<StarBlock>> blocks;       // All blocks of the cache
+    QVector<std::shared_ptr<StarBlock>> recycleQueue; // Candidates for recycling, least recently used last
+    qint64 recycleQueueDrawID { -1 };                  // Draw cycle the recycling candidates were sorted in
     int nBlocks;             // Number of blocks we currently have in the cache
     int nCache;              // Number of blocks to start recycling cached blocks at
+    QMutex blockMutex;
 
     static StarBlockFactory *pInstance;
 };
@@ -28,6 +28,7 @@
 #endif
 
 #include <QDebug>
+#include <QMutexLocker>
 
 StarBlockList::StarBlockList(const Trixel &tr, DeepStarComponent *parent)
 {
@@ -75,12 +76,8 @@ bool StarBlockList::fillToMag(float maglim)
     // TODO: Remove staticity of BinFileHelper
     BinFileHelper *dSReader;
     StarBlockFactory *SBFactory;
-    StarData stardata;
-    DeepStarData deepstardata;
-    FILE *dataFile;
 
     dSReader  = parent->getStarReader();
-    dataFile  = dSReader->getFileHandle();
     SBFactory = StarBlockFactory::Instance();
 
     if (staticStars)
@@ -89,80 +86,187 @@ bool StarBlockList::fillToMag(float maglim)
     if (faintMag >= maglim)
         return true;
 
-    if (!dataFile)
+    if (!dSReader->getFileHandle())
     {
         qDebug() << "dataFile not opened!";
         return false;
     }
 
-    Trixel trixelId =
-        trixel; //( ( trixel < 256 ) ? ( trixel + 256 ) : ( trixel - 256 ) ); // Trixel ID on datafile is assigned differently
-
-    if (readOffset <= 0)
-        readOffset = dSReader->getOffset(trixelId);
-
     Q_ASSERT(nBlocks == (unsigned int)blocks.size());
 
-    BinFileHelper::unsigned_KDE_fseek(dataFile, readOffset, SEEK_SET);
-
     /*
-    qDebug() << "Reading trixel" << trixel << ", id on disk =" << trixelId << ", currently nStars =" << nStars
-             << ", record count =" << dSReader->getRecordCount( trixelId ) << ", first block = " << blocks[0]->getStarCount()
+    qDebug() << "Reading trixel" << trixel << ", currently nStars =" << nStars
+             << ", record count =" << dSReader->getRecordCount( trixel ) << ", first block = " << blocks[0]->getStarCount()
              << "to maglim =" << maglim << "with current faintMag =" << faintMag;
     */
 
-    while (maglim >= faintMag && nStars < dSReader->getRecordCount(trixelId))
+    while (needsFill(maglim))
     {
-        int ret = 0;
+        // Getting a block may recycle the last block of this list, so the read position is taken afterwards
+        std::shared_ptr<StarBlock> newBlock = SBFactory->getBlock();
 
-        if (nBlocks == 0 || blocks[nBlocks - 1]->isFull())
+        if (!newBlock.get())
         {
-            std::shared_ptr<StarBlock> newBlock = SBFactory->getBlock();
+            qWarning() << "ERROR: Could not get a new block from StarBlockFactory::getBlock() in trixel " << trixel
+                       << ", while trying to create block #" << nBlocks + 1;
+            return false;
+        }
+
+        long offset = readOffset;
+        if (!readBlock(newBlock.get(), nStars, offset))
+        {
+            newBlock->reset();
+            return false;
+        }
 
+        appendBlock(newBlock, offset);
+    }
+
+    return ((maglim < faintMag) ? true : false);
+}
+
+bool StarBlockList::loadToMag(float maglim, bool &loaded)
+{
+    BinFileHelper *dSReader     = parent->getStarReader();
+    StarBlockFactory *SBFactory = StarBlockFactory::Instance();
+
+    loaded = false;
+
+    if (!dSReader->isMapped())
+    {
+        QMutexLocker locker(SBFactory->mutex());
+        unsigned long const count = nStars;
+        bool const result         = fillToMag(maglim);
+        loaded                    = (nStars > count);
+        return result;
+    }
+
+    forever
+    {
+        std::shared_ptr<StarBlock> newBlock;
+        unsigned long first;
+        long offset;
+
+        {
+            QMutexLocker locker(SBFactory->mutex());
+
+            if (!needsFill(maglim))
+                return (staticStars ? false : (maglim < faintMag));
+
+            newBlock = SBFactory->getBlock();
             if (!newBlock.get())
             {
                 qWarning() << "ERROR: Could not get a new block from StarBlockFactory::getBlock() in trixel " << trixel
                            << ", while trying to create block #" << nBlocks + 1;
                 return false;
             }
-            blocks.append(newBlock);
-            blocks[nBlocks]->parent = this;
-            if (nBlocks == 0)
-                SBFactory->markFirst(blocks[0]);
-            else if (!SBFactory->markNext(blocks[nBlocks - 1], blocks[nBlocks]))
-                qWarning() << "ERROR: markNext() failed on block #" << nBlocks + 1 << "in trixel" << trixel;
-
-            ++nBlocks;
+
+            // Keep the block from being recycled while it is filled
+            newBlock->pinned = true;
+            first            = nStars;
+            offset           = readOffset;
         }
+
+        // The mapped catalog is read without the lock, as reading it may wait for the disk
+        bool const read = readBlock(newBlock.get(), first, offset);
+
+        QMutexLocker locker(SBFactory->mutex());
+        newBlock->pinned = false;
+
+        if (!read)
+        {
+            newBlock->reset();
+            return false;
+        }
+
+        // The list was filled or recycled while the block was read, read it again from the new end of the list
+        if (nStars != first)
+        {
+            newBlock->reset();
+            continue;
+        }
+
+        appendBlock(newBlock, offset);
+        loaded = true;
+    }
+}
+
+bool StarBlockList::readBlock(StarBlock *block, unsigned long first, long &offset) const
+{
+    BinFileHelper *dSReader     = parent->getStarReader();
+    unsigned long const records = dSReader->getRecordCount(trixel);
+
+    if (offset <= 0)
+        offset = dSReader->getOffset(trixel);
+
+    // Mapped catalogs are read in place, without seeking the file
+    if (!dSReader->isMapped())
+        BinFileHelper::unsigned_KDE_fseek(dSReader->getFileHandle(), offset, SEEK_SET);
+
+    StarData stardata;
+    DeepStarData deepstardata;
+
+    for (unsigned long i = first; i < records && !block->isFull(); ++i)
+    {
         // TODO: Make this more general
         if (dSReader->guessRecordSize() == 32)
         {
-            ret = fread(&stardata, sizeof(StarData), 1, dataFile);
-            if (dSReader->getByteSwap())
-                DeepStarComponent::byteSwap(&stardata);
-            readOffset += sizeof(StarData);
-            blocks[nBlocks - 1]->addStar(stardata);
+            const StarData *record = DeepStarComponent::readRecord(*dSReader, offset, stardata);
+            if (!record)
+            {
+                qWarning() << "ERROR: Could not read star #" << i << "in trixel" << trixel;
+                return false;
+            }
+            offset += sizeof(StarData);
+            block->addStar(*record);
         }
         else
         {
-            ret = fread(&deepstardata, sizeof(DeepStarData), 1, dataFile);
-            if (dSReader->getByteSwap())
-                DeepStarComponent::byteSwap(&deepstardata);
-            readOffset += sizeof(DeepStarData);
-            blocks[nBlocks - 1]->addStar(deepstardata);
+            const DeepStarData *record = DeepStarComponent::readRecord(*dSReader, offset, deepstardata);
+            if (!record)
+            {
+                qWarning() << "ERROR: Could not read star #" << i << "in trixel" << trixel;
+                return false;
+            }
+            offset += sizeof(DeepStarData);
+            block->addStar(*record);
         }
-
-        /*
-          if( faintMag > -5.0 && fabs(faintMag - blocks[nBlocks - 1]->getFaintMag()) > 0.2 ) {
-          qDebug() << "Encountered a jump from mag" << faintMag << "to mag"
-          << blocks[nBlocks - 1]->getFaintMag() << "in trixel" << trixel;
-          }
-        */
-        faintMag = blocks[nBlocks - 1]->getFaintMag();
-        nStars++;
     }
 
-    return ((maglim < faintMag) ? true : false);
+    return true;
+}
+
+void StarBlockList::appendBlock(const std::shared_ptr<StarBlock> &block, long offset)
+{
+    blocks.append(block);
+    block->parent = this;
+    StarBlockFactory::Instance()->mark(block);
+    ++nBlocks;
+
+    nStars += block->getStarCount();
+    readOffset = offset;
+    faintMag   = block->getFaintMag();
+}
+
+bool StarBlockList::needsFill(float maglim) const
+{
+    return (!staticStars && maglim >= faintMag && nStars < parent->getStarReader()->getRecordCount(trixel));
+}
+
+void StarBlockList::prefetch()
+{
+    if (staticStars)
+        return;
+
+    BinFileHelper *dSReader = parent->getStarReader();
+    unsigned int records    = dSReader->getRecordCount(trixel);
+
+    if (!dSReader->isMapped() || nStars >= records)
+        return;
+
+    // Records are sorted by magnitude, so the stars that are not loaded yet follow each other
+    long offset = ((readOffset > 0) ? readOffset : dSReader->getOffset(trixel));
+    dSReader->prefetch(offset, quint64(records - nStars) * dSReader->guessRecordSize());
 }
 
 void StarBlockList::setStaticBlock(std::shared_ptr<StarBlock> &block)
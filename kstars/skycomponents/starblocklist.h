@@ -43,11 +43,45 @@ class StarBlockList
     /**
      * @short Ensures that the list is loaded with stars to given magnitude limit
      *
+     * Blocks are always filled whole, or up to the last star of the trixel, so that loadToMag()
+     * only ever appends blocks.
+     *
+     * @note The caller must hold the StarBlockFactory lock
      * @param maglim Magnitude limit to load stars upto
      * @return true on success, false on failure (data file not found, bad seek etc)
      */
     bool fillToMag(float maglim);
 
+    /**
+     * @short Same as fillToMag(), for the background loader
+     *
+     * Each block is filled while detached from the list, without the StarBlockFactory lock, so
+     * that reading the mapped catalog does not hold up drawing. The lock is only taken to get the
+     * block and to append it. Catalogs that are not mapped are read with fillToMag() under the lock.
+     *
+     * @note The caller must not hold the StarBlockFactory lock
+     * @param maglim Magnitude limit to load stars upto
+     * @param loaded Set to true if stars were added to the list
+     * @return true on success, false on failure (data file not found, bad seek etc)
+     */
+    bool loadToMag(float maglim, bool &loaded);
+
+    /**
+     * @short Check whether fillToMag() would load stars
+     *
+     * @param maglim Magnitude limit to load stars upto
+     * @return true if stars up to maglim are not all loaded yet
+     */
+    bool needsFill(float maglim) const;
+
+    /**
+     * @short Hints that the stars of this trixel will be needed soon
+     *
+     * If the catalog is mapped in memory, the records that fillToMag() has not loaded yet are
+     * read ahead from disk in the background, so that loading them later does not wait for I/O.
+     */
+    void prefetch();
+
     /**
      * @short Sets the first StarBlock in the list to point to the given StarBlock
      *
@@ -104,6 +138,18 @@ class StarBlockList
     inline Trixel getTrixel() const { return trixel; }
 
   private:
+    /**
+     * @short Read the stars of the trixel following star number first into a block, until it is full
+     * @param block block to fill
+     * @param first number of the first star to read
+     * @param offset offset of the first star in the catalog, set past the last star read
+     * @return false if a star could not be read
+     */
+    bool readBlock(StarBlock *block, unsigned long first, long &offset) const;
+
+    /** @short Append a block filled by readBlock(), offset being the offset past its last star */
+    void appendBlock(const std::shared_ptr<StarBlock> &block, long offset);
+
     Trixel trixel;
     unsigned long nStars { 0 };
     long readOffset { 0 };
@@ -211,6 +211,15 @@ void StarComponent::reindexAll(KSNumbers *num)
     //m_reindexSplash = 0;
 }
 
+bool StarComponent::waitForPendingLoads()
+{
+    bool waited = false;
+
+    for (auto &component : m_DeepStarComponents)
+        waited |= component->waitForPendingLoads();
+    return waited;
+}
+
 float StarComponent::faintMagnitude() const
 {
     float faintmag = m_FaintMagnitude;
@@ -312,35 +321,46 @@ void StarComponent::draw(SkyPainter *skyp)
     if (hideFaintStars && maglim > hideStarsMag)
         maglim = hideStarsMag;
 
-    m_StarBlockFactory->drawID = m_skyMesh->drawID();
+    {
+        // The background loader of the deep star catalogs reads the draw cycle when it reuses blocks
+        QMutexLocker locker(m_StarBlockFactory->mutex());
+        m_StarBlockFactory->drawID = m_skyMesh->drawID();
+    }
 
     int nTrixels = 0;
 
+    QVector<StarObject *> starBatch;
+    QVector<bool> drawn;
+
     while (region.hasNext())
     {
         ++nTrixels;
         Trixel currentRegion = region.next();
         StarList *starList   = m_starIndex->at(currentRegion);
 
+        starBatch.clear();
         for (auto &star : *starList)
         {
             if (!star)
                 continue;
 
-            float mag = star->mag();
-
             // break loop if maglim is reached
-            if (mag > maglim)
+            if (star->mag() > maglim)
                 break;
 
             if (star->updateID != updateID)
                 star->JITupdate();
 
-            bool drawn = skyp->drawPointSource(star, mag, star->spchar());
+            starBatch.append(star);
+        }
+
+        skyp->drawPointSources(starBatch, &drawn);
 
-            //FIXME_SKYPAINTER: find a better way to do this.
-            if (drawn && !(m_hideLabels || mag > labelMagLim))
-                addLabel(proj->toScreen(star), star);
+        //FIXME_SKYPAINTER: find a better way to do this.
+        for (int i = 0; i < starBatch.size(); i++)
+        {
+            if (drawn[i] && !(m_hideLabels || starBatch[i]->mag() > labelMagLim))
+                addLabel(proj->toScreen(starBatch[i]), starBatch[i]);
         }
     }
 
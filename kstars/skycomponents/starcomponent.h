@@ -89,6 +89,12 @@ class StarComponent : public ListComponent
 
     static float zoomMagnitudeLimit();
 
+    /**
+     * @short Wait until the deep star catalogs have loaded the trixels queued by the last draw
+     * @return true if there were trixels to load
+     */
+    bool waitForPendingLoads();
+
     SkyObject *objectNearest(SkyPoint *p, double &maxrad) override;
 
     virtual SkyObject *findStarByGenetiveName(const QString name);
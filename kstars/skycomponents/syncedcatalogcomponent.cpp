@@ -111,6 +111,7 @@ DeepSkyObject *SyncedCatalogComponent::addObject(CatalogEntryData &catalogEntry)
         objectLists()[newObj->type()].append(QPair<QString, const SkyObject *>(newObj->name(), newObj));
     }
     m_ObjectList.append(newObj);
+    invalidateIndex();
     qDebug() << "Added new SkyObject " << newObj->name() << " to synced catalog " << m_catName << " which now contains "
              << m_ObjectList.count() << " objects.";
     return newObj;
@@ -155,6 +156,7 @@ bool SyncedCatalogComponent::removeObject(SkyObject &object)
         return false;
     }
     m_ObjectList.removeAll(&object);
+    invalidateIndex();
     qDebug() << "Remove SkyObject " << name << " from synced catalog " << m_catName;
     // Remove the catalog entry
     CatalogEntryData cedata = NameResolver::resolveName(name);
@@ -33,6 +33,7 @@
 #include "ksutils.h"
 #include "Options.h"
 #include "skymapcomposite.h"
+#include "skymapprofiler.h"
 #ifdef HAVE_OPENGL
 #include "skymapgldraw.h"
 #endif
@@ -227,6 +228,8 @@ SkyMap::SkyMap()
     m_iboxes->addInfoBox(m_timeBox);
     m_iboxes->addInfoBox(m_geoBox);
     m_iboxes->addInfoBox(m_objBox);
+
+    SkyMapProfiler::Instance()->setEnabled(Options::showRenderProfiler());
 }
 
 void SkyMap::slotToggleGeoBox(bool flag)
@@ -250,6 +253,13 @@ void SkyMap::slotToggleInfoboxes(bool flag)
     Options::setShowInfoBoxes(flag);
 }
 
+void SkyMap::slotToggleRenderProfiler(bool flag)
+{
+    SkyMapProfiler::Instance()->setEnabled(flag);
+    Options::setShowRenderProfiler(flag);
+    forceUpdate();
+}
+
 SkyMap::~SkyMap()
 {
     /* == Save infoxes status into Options == */
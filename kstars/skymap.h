@@ -398,6 +398,9 @@ class SkyMap : public QGraphicsView
         /** Toggle visibility of all infoboxes */
         void slotToggleInfoboxes(bool);
 
+        /** Toggle the render profiler and its display over the sky map */
+        void slotToggleRenderProfiler(bool);
+
         /** Step the Focus point toward the Destination point.  Do this iteratively, redrawing the Sky
              * Map after each step, until the Focus point is within 1 step of the Destination point.
              * For the final step, snap directly to Destination, and redraw the map.
@@ -0,0 +1,307 @@
+/*  Sky Map Profiler
+    Copyright (C) 2026 agent <agent@local>
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+*/
+
+#include "skymapprofiler.h"
+
+#include <QFile>
+#include <QFontDatabase>
+#include <QFontMetrics>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QPainter>
+#include <QTextStream>
+
+#include <algorithm>
+#include <cstring>
+
+#include <kstars_debug.h>
+
+// Oldest sections and frames are dropped past these limits
+#define MAX_SECTIONS 200000
+#define MAX_FRAMES   20000
+// Number of sections listed in the display
+#define HUD_SECTIONS 12
+
+SkyMapProfiler *SkyMapProfiler::_SkyMapProfiler = nullptr;
+
+SkyMapProfiler::Timer::Timer(const char *name)
+{
+    if (name)
+        start(name);
+}
+
+SkyMapProfiler::Timer::~Timer()
+{
+    stop();
+}
+
+void SkyMapProfiler::Timer::start(const char *name)
+{
+    stop();
+
+    SkyMapProfiler *profiler = SkyMapProfiler::Instance();
+    if (!profiler->isEnabled())
+        return;
+
+    m_Name  = name;
+    m_Start = profiler->now();
+}
+
+void SkyMapProfiler::Timer::stop()
+{
+    if (m_Name == nullptr)
+        return;
+
+    SkyMapProfiler *profiler = SkyMapProfiler::Instance();
+    if (profiler->isEnabled())
+        profiler->record(m_Name, m_Start, profiler->now() - m_Start);
+
+    m_Name = nullptr;
+}
+
+SkyMapProfiler *SkyMapProfiler::Instance()
+{
+    if (_SkyMapProfiler == nullptr)
+        _SkyMapProfiler = new SkyMapProfiler();
+
+    return _SkyMapProfiler;
+}
+
+SkyMapProfiler::SkyMapProfiler()
+{
+    m_Clock.start();
+}
+
+void SkyMapProfiler::setEnabled(bool enabled)
+{
+    if (enabled == m_Enabled)
+        return;
+
+    m_Enabled = enabled;
+    m_InFrame = false;
+
+    if (enabled)
+    {
+        m_Sections.clear();
+        m_Frames.clear();
+        m_FrameSections.clear();
+        m_LastFrameSections.clear();
+        m_LastUpdates.clear();
+        m_LastFrame         = Frame();
+        m_LastFrameInterval = 0;
+    }
+}
+
+void SkyMapProfiler::beginFrame()
+{
+    if (!m_Enabled)
+        return;
+
+    qint64 const start = now();
+    if (!m_Frames.isEmpty())
+        m_LastFrameInterval = start - m_Frames.last().start;
+
+    m_InFrame    = true;
+    m_FrameStart = start;
+    std::fill(m_Counters, m_Counters + COUNTER_COUNT, 0);
+    m_FrameSections.clear();
+}
+
+void SkyMapProfiler::endFrame()
+{
+    if (!m_Enabled || !m_InFrame)
+        return;
+
+    Frame frame;
+    frame.start    = m_FrameStart;
+    frame.duration = now() - m_FrameStart;
+    std::copy(m_Counters, m_Counters + COUNTER_COUNT, frame.counters);
+
+    if (m_Frames.size() >= MAX_FRAMES)
+        m_Frames.remove(0, MAX_FRAMES / 2);
+    m_Frames.append(frame);
+
+    m_InFrame           = false;
+    m_LastFrame         = frame;
+    m_LastFrameSections = m_FrameSections;
+}
+
+void SkyMapProfiler::record(const char *name, qint64 start, qint64 duration)
+{
+    Section const section { name, start, duration };
+
+    if (m_Sections.size() >= MAX_SECTIONS)
+        m_Sections.remove(0, MAX_SECTIONS / 2);
+    m_Sections.append(section);
+
+    if (m_InFrame)
+    {
+        m_FrameSections.append(section);
+        return;
+    }
+
+    // Keep the last duration of each section recorded outside frames
+    auto update = std::find_if(m_LastUpdates.begin(), m_LastUpdates.end(), [name](const Section &other)
+    {
+        return strcmp(other.name, name) == 0;
+    });
+    if (update == m_LastUpdates.end())
+        m_LastUpdates.append(section);
+    else
+        *update = section;
+}
+
+QList<QPair<QString, double>> SkyMapProfiler::lastFrameSections() const
+{
+    QList<QPair<QString, double>> sections;
+    for (const Section &section : m_LastFrameSections)
+        sections.append(qMakePair(QString::fromLatin1(section.name), section.duration / 1.0e6));
+
+    return sections;
+}
+
+void SkyMapProfiler::drawHUD(QPainter &p) const
+{
+    if (!m_Enabled)
+        return;
+
+    auto ms = [](qint64 ns)
+    {
+        return QString::number(ns / 1.0e6, 'f', 2);
+    };
+
+    QStringList lines;
+    double const fps = (m_LastFrameInterval > 0) ? 1.0e9 / m_LastFrameInterval : 0;
+    lines << QString("Frame %1 ms, %2 fps").arg(ms(m_LastFrame.duration)).arg(fps, 0, 'f', 1);
+    lines << QString("Projected %1, drawn %2, labelled %3")
+          .arg(m_LastFrame.counters[PROJECTED])
+          .arg(m_LastFrame.counters[DRAWN])
+          .arg(m_LastFrame.counters[LABELLED]);
+
+    // Slowest sections of the last frame first
+    QVector<Section> sections = m_LastFrameSections;
+    std::sort(sections.begin(), sections.end(), [](const Section &a, const Section &b)
+    {
+        return a.duration > b.duration;
+    });
+    for (int i = 0; i < sections.size() && i < HUD_SECTIONS; i++)
+        lines << QString("%1 %2 ms").arg(QString::fromLatin1(sections[i].name), -20).arg(ms(sections[i].duration), 8);
+
+    if (!m_LastUpdates.isEmpty())
+    {
+        lines << "Updates";
+        for (const Section &update : m_LastUpdates)
+            lines << QString("%1 %2 ms").arg(QString::fromLatin1(update.name), -20).arg(ms(update.duration), 8);
+    }
+
+    p.save();
+
+    p.setFont(QFontDatabase::systemFont(QFontDatabase::FixedFont));
+    QFontMetrics const metrics = p.fontMetrics();
+
+    int width = 0;
+    for (const QString &line : lines)
+        width = std::max(width, metrics.width(line));
+
+    int const margin = 6;
+    QRect const box(p.viewport().left() + margin,
+                    p.viewport().bottom() - margin - lines.size() * metrics.lineSpacing() - 2 * margin,
+                    width + 2 * margin, lines.size() * metrics.lineSpacing() + 2 * margin);
+
+    p.setPen(Qt::NoPen);
+    p.setBrush(QColor(0, 0, 0, 160));
+    p.drawRect(box);
+
+    p.setPen(Qt::white);
+    int y = box.top() + margin + metrics.ascent();
+    for (const QString &line : lines)
+    {
+        p.drawText(box.left() + margin, y, line);
+        y += metrics.lineSpacing();
+    }
+
+    p.restore();
+}
+
+bool SkyMapProfiler::exportTrace(const QString &fileName) const
+{
+    if (fileName.endsWith(".csv", Qt::CaseInsensitive))
+        return exportCSV(fileName);
+
+    return exportChromeTrace(fileName);
+}
+
+bool SkyMapProfiler::exportCSV(const QString &fileName) const
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text))
+    {
+        qCWarning(KSTARS) << "Failed to open" << fileName << "to export the render trace.";
+        return false;
+    }
+
+    QTextStream out(&file);
+    out << "type,name,start_us,duration_us,projected,drawn,labelled\n";
+
+    for (const Frame &frame : m_Frames)
+        out << "frame,Frame," << frame.start / 1000 << ',' << frame.duration / 1000 << ',' << frame.counters[PROJECTED]
+            << ',' << frame.counters[DRAWN] << ',' << frame.counters[LABELLED] << '\n';
+
+    for (const Section &section : m_Sections)
+        out << "section," << section.name << ',' << section.start / 1000 << ',' << section.duration / 1000 << ",,,\n";
+
+    return true;
+}
+
+bool SkyMapProfiler::exportChromeTrace(const QString &fileName) const
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly))
+    {
+        qCWarning(KSTARS) << "Failed to open" << fileName << "to export the render trace.";
+        return false;
+    }
+
+    // Complete events for frames and sections, nested by time, and a counter event per frame
+    QJsonArray events;
+
+    for (const Frame &frame : m_Frames)
+    {
+        events.append(QJsonObject
+        {
+            {"name", "Frame"}, {"cat", "frame"}, {"ph", "X"}, {"pid", 1}, {"tid", 1},
+            {"ts", frame.start / 1000.0}, {"dur", frame.duration / 1000.0}
+        });
+        events.append(QJsonObject
+        {
+            {"name", "Objects"}, {"ph", "C"}, {"pid", 1}, {"tid", 1}, {"ts", frame.start / 1000.0},
+            {
+                "args", QJsonObject
+                {
+                    {"projected", frame.counters[PROJECTED]},
+                    {"drawn", frame.counters[DRAWN]},
+                    {"labelled", frame.counters[LABELLED]}
+                }
+            }
+        });
+    }
+
+    for (const Section &section : m_Sections)
+    {
+        events.append(QJsonObject
+        {
+            {"name", section.name}, {"cat", "section"}, {"ph", "X"}, {"pid", 1}, {"tid", 1},
+            {"ts", section.start / 1000.0}, {"dur", section.duration / 1000.0}
+        });
+    }
+
+    QJsonObject const trace { {"traceEvents", events}, {"displayTimeUnit", "ms"} };
+    return file.write(QJsonDocument(trace).toJson(QJsonDocument::Compact)) >= 0;
+}
@@ -0,0 +1,162 @@
+/*  Sky Map Profiler
+    Copyright (C) 2026 agent <agent@local>
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+*/
+
+#pragma once
+
+#include <QElapsedTimer>
+#include <QList>
+#include <QPair>
+#include <QString>
+#include <QVector>
+
+class QPainter;
+
+/**
+ * @class SkyMapProfiler
+ * @short Run-time timing of the sky map rendering.
+ *
+ * The profiler records timed sections, such as the draw or update of each sky component, and counts
+ * the objects projected, drawn and labelled in each frame. A frame is a full recompute of the sky map.
+ * Sections recorded outside frames, such as component updates, are kept as well.
+ *
+ * The last frame is summarized in a display drawn over the sky map, and the recorded sections can be
+ * exported in the Chrome trace format, to be read in chrome://tracing or Perfetto, or as CSV.
+ *
+ * Nothing is recorded while the profiler is disabled, in which case timers and counters only cost a test.
+ * The profiler must only be used from the main thread.
+ *
+ * @version 1.0
+ */
+class SkyMapProfiler
+{
+    public:
+        typedef enum
+        {
+            PROJECTED,
+            DRAWN,
+            LABELLED,
+            COUNTER_COUNT
+        } Counter;
+
+        /**
+         * @class Timer
+         * @short Time the sections of a function.
+         *
+         * A section lasts until the next one is started, until stop() is called, or until the timer is
+         * destroyed. Section names must be string literals.
+         */
+        class Timer
+        {
+            public:
+                explicit Timer(const char *name = nullptr);
+                ~Timer();
+
+                /** @brief start End the current section if any, and start a new one. */
+                void start(const char *name);
+
+                /** @brief stop End the current section if any. */
+                void stop();
+
+            private:
+                const char *m_Name { nullptr };
+                qint64 m_Start { 0 };
+        };
+
+        static SkyMapProfiler *Instance();
+
+        inline bool isEnabled() const
+        {
+            return m_Enabled;
+        }
+
+        /** @brief setEnabled Start or stop recording. Recorded sections are dropped when recording starts. */
+        void setEnabled(bool enabled);
+
+        /** @brief beginFrame Mark the start of a full recompute of the sky map. */
+        void beginFrame();
+
+        /** @brief endFrame Mark the end of a full recompute of the sky map, and summarize it. */
+        void endFrame();
+
+        /** @brief count Add n objects to a counter of the current frame. */
+        inline void count(Counter counter, int n = 1)
+        {
+            if (m_Enabled)
+                m_Counters[counter] += n;
+        }
+
+        /** @brief lastFrameSections Get the time spent in each section of the last frame, in milliseconds. */
+        QList<QPair<QString, double>> lastFrameSections() const;
+
+        /** @brief lastFrameCount Get a counter of the last frame. */
+        inline int lastFrameCount(Counter counter) const
+        {
+            return m_LastFrame.counters[counter];
+        }
+
+        /** @brief drawHUD Draw the summary of the last frame in the bottom left corner of the painter. */
+        void drawHUD(QPainter &p) const;
+
+        /**
+         * @brief exportTrace Save the recorded sections.
+         * @param fileName path of the file. Files ending with ".csv" are saved as CSV, other files in the
+         * Chrome trace JSON format.
+         * @return true if the file was saved.
+         */
+        bool exportTrace(const QString &fileName) const;
+
+    private:
+        SkyMapProfiler();
+
+        typedef struct
+        {
+            const char *name;
+            /** Start time and duration, in nanoseconds */
+            qint64 start;
+            qint64 duration;
+        } Section;
+
+        typedef struct
+        {
+            qint64 start;
+            qint64 duration;
+            int counters[COUNTER_COUNT];
+        } Frame;
+
+        void record(const char *name, qint64 start, qint64 duration);
+
+        inline qint64 now() const
+        {
+            return m_Clock.nsecsElapsed();
+        }
+
+        bool exportCSV(const QString &fileName) const;
+        bool exportChromeTrace(const QString &fileName) const;
+
+        static SkyMapProfiler *_SkyMapProfiler;
+
+        bool m_Enabled { false };
+        QElapsedTimer m_Clock;
+
+        /** Recorded sections and frames, the oldest are dropped past a limit */
+        QVector<Section> m_Sections;
+        QVector<Frame> m_Frames;
+
+        /** Current frame */
+        bool m_InFrame { false };
+        qint64 m_FrameStart { 0 };
+        int m_Counters[COUNTER_COUNT] {};
+        QVector<Section> m_FrameSections;
+
+        /** Summary of the last frame, and last duration of the sections recorded outside frames */
+        Frame m_LastFrame {};
+        qint64 m_LastFrameInterval { 0 };
+        QVector<Section> m_LastFrameSections;
+        QVector<Section> m_LastUpdates;
+};
@@ -16,6 +16,7 @@
 
 #include "skymapqdraw.h"
 #include "skymapcomposite.h"
+#include "skymapprofiler.h"
 #include "skyqpainter.h"
 #include "skymap.h"
 #include "projections/projector.h"
@@ -59,14 +60,19 @@ void SkyMapQDraw::paintEvent(QPaintEvent *event)
         p.drawLine(0, 0, 1, 1); // Dummy operation to circumvent bug. TODO: Add details
         p.drawPixmap(0, 0, *m_SkyPixmap);
         drawOverlays(p);
+        SkyMapProfiler::Instance()->drawHUD(p);
         p.end();
 
         setDrawLock(false);
         return; // exit because the pixmap is repainted and that's all what we want
     }
 
+    SkyMapProfiler *profiler = SkyMapProfiler::Instance();
+    profiler->beginFrame();
+
     // FIXME: used to notify infobox about possible change of object coordinates
     // Not elegant at all. Should find better option
+    SkyMapProfiler::Timer timer("Setup");
     m_SkyMap->showFocusCoords();
     m_SkyMap->setupProjector();
 
@@ -75,7 +81,9 @@ void SkyMapQDraw::paintEvent(QPaintEvent *event)
     psky.begin();
 
     //Draw all sky elements
+    timer.start("Background");
     psky.drawSkyBackground();
+    timer.stop();
 
     // Set Clipping
     QPainterPath path;
@@ -87,11 +95,16 @@ void SkyMapQDraw::paintEvent(QPaintEvent *event)
     //Finish up
     psky.end();
 
+    timer.start("Overlays");
     QPainter psky2;
     psky2.begin(this);
     psky2.drawLine(0, 0, 1, 1); // Dummy op.
     psky2.drawPixmap(0, 0, *m_SkyPixmap);
     drawOverlays(psky2);
+    timer.stop();
+
+    profiler->endFrame();
+    profiler->drawHUD(psky2);
     psky2.end();
 
     if (m_SkyMap->m_previewLegend)
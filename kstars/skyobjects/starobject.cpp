@@ -28,6 +28,8 @@
 #include "skymap.h"
 #include "stardata.h"
 
+#include <algorithm>
+#include <cmath>
 #include <typeinfo>
 
 #ifdef PROFILE_UPDATECOORDS
@@ -91,6 +93,7 @@ StarObject::StarObject(dms r, dms d, float m, const QString &n, const QString &n
 
     setLongName(lname);
     updateID = updateNumID = 0;
+    updateCartesian();
 }
 
 StarObject::StarObject(double r, double d, float m, const QString &n, const QString &n2, const QString &sptype,
@@ -120,11 +123,13 @@ StarObject::StarObject(double r, double d, float m, const QString &n, const QStr
 
     setLongName(lname);
     updateID = updateNumID = 0;
+    updateCartesian();
 }
 
 StarObject::StarObject(const StarObject &o)
     : SkyObject(o), PM_RA(o.PM_RA), PM_Dec(o.PM_Dec), Parallax(o.Parallax), Multiplicity(o.Multiplicity),
-      Variability(o.Variability), HD(o.HD)
+      Variability(o.Variability), HD(o.HD), J2000Vector(o.J2000Vector),
+      ProperMotionVector(o.ProperMotionVector)
 {
     SpType[0] = o.SpType[0];
     SpType[1] = o.SpType[1];
@@ -185,6 +190,7 @@ void StarObject::init(const StarData *stardata)
     // END DEBUG.
 
     lastPrecessJD = J2000;
+    updateCartesian();
 }
 
 void StarObject::init(const DeepStarData *stardata)
@@ -232,6 +238,7 @@ void StarObject::init(const DeepStarData *stardata)
     B                      = stardata->B / 1000.0;
     V                      = stardata->V / 1000.0;
     lastPrecessJD          = J2000;
+    updateCartesian();
 }
 
 void StarObject::setNames(const QString &name, const QString &name2)
@@ -261,30 +268,50 @@ void StarObject::initPopupMenu(KSPopupMenu *pmenu)
 #endif
 }
 
-void StarObject::updateCoords(const KSNumbers *num, bool, const CachingDms *, const CachingDms *, bool)
+void StarObject::updateCoords(const KSNumbers *num, bool, const CachingDms *, const CachingDms *, bool forceRecompute)
 {
-//Correct for proper motion of stars.  Determine RA and Dec offsets.
-//Proper motion is given im milliarcsec per year by the pmRA() and pmDec() functions.
-//That is numerically identical to the number of arcsec per millenium, so multiply by
-//KSNumbers::julianMillenia() to find the offsets in arcsec.
-
-// Correction:  The method below computes the proper motion before the
-// precession.  If we precessed first then the direction of the proper
-// motion correction would depend on how far we've precessed.  -jbb
 #ifdef PROFILE_UPDATECOORDS
     std::clock_t start, stop;
     start = std::clock();
 #endif
-    CachingDms saveRA = ra0(), saveDec = dec0();
-    CachingDms newRA, newDec;
+    if (Options::useRelativistic() && checkBendLight())
+    {
+        //Correct for proper motion of stars.  Determine RA and Dec offsets.
+        //Proper motion is given im milliarcsec per year by the pmRA() and pmDec() functions.
+        //That is numerically identical to the number of arcsec per millenium, so multiply by
+        //KSNumbers::julianMillenia() to find the offsets in arcsec.
+
+        // Correction:  The method below computes the proper motion before the
+        // precession.  If we precessed first then the direction of the proper
+        // motion correction would depend on how far we've precessed.  -jbb
+
+        // The deflection of light is only computed in spherical coordinates,
+        // so stars close to the Sun go through the complete computation.
+        CachingDms saveRA = ra0(), saveDec = dec0();
+        CachingDms newRA, newDec;
+
+        getIndexCoords(num, newRA, newDec);
+
+        setRA0(newRA);
+        setDec0(newDec);
+        SkyPoint::updateCoords(num, true, nullptr, nullptr, forceRecompute);
+        setRA0(saveRA);
+        setDec0(saveDec);
+    }
+    else if (Options::alwaysRecomputeCoordinates() || forceRecompute ||
+             std::abs(lastPrecessJD - num->getJD()) >= 0.00069444) // Update once per solar minute, like SkyPoint
+    {
+        Eigen::Vector3d const v = apparentVector(num);
+        CachingDms newRA, newDec;
 
-    getIndexCoords(num, newRA, newDec);
+        newRA.setUsing_atan2(v.y(), v.x());
+        newRA.reduceToRange(dms::ZERO_TO_2PI);
+        newDec.setUsing_asin(std::max(-1.0, std::min(1.0, v.z())));
 
-    setRA0(newRA);
-    setDec0(newDec);
-    SkyPoint::updateCoords(num);
-    setRA0(saveRA);
-    setDec0(saveDec);
+        setRA(newRA);
+        setDec(newDec);
+        lastPrecessJD = num->getJD();
+    }
 
 #ifdef PROFILE_UPDATECOORDS
     stop = std::clock();
@@ -293,6 +320,49 @@ void StarObject::updateCoords(const KSNumbers *num, bool, const CachingDms *, co
 #endif
 }
 
+Eigen::Vector3d StarObject::apparentVector(const KSNumbers *num) const
+{
+    // Proper motion is a displacement along a great circle. Moving along the tangent by tan(d)
+    // and normalizing gives an angular distance of d, and tan(d) ~ d + d^3/3 for small angles.
+    double const t  = num->julianMillenia();
+    double const d2 = ProperMotionVector.squaredNorm() * t * t;
+    Eigen::Vector3d v = J2000Vector + ProperMotionVector.cast<double>() * (t * (1.0 + d2 / 3.0));
+
+    // Precession and nutation, then the annual aberration
+    v = num->precessionNutation() * v;
+    v.normalize();
+    v += num->aberrationVector();
+    v.normalize();
+
+    return v;
+}
+
+void StarObject::updateCartesian()
+{
+    double sinRA, cosRA, sinDec, cosDec;
+
+    ra0().SinCos(sinRA, cosRA);
+    dec0().SinCos(sinDec, cosDec);
+    J2000Vector = Eigen::Vector3d(cosDec * cosRA, cosDec * sinRA, sinDec);
+
+    // Same motion as getIndexCoords(): pmMagnitude() in the direction of atan2(pmRA(), pmDec())
+    double const pmms = pmMagnitudeSquared();
+    double const norm = std::hypot(pmRA(), pmDec());
+
+    if (std::isnan(pmms) || pmms == 0 || norm == 0)
+    {
+        ProperMotionVector.setZero();
+        return;
+    }
+
+    // Milliarcsec per year is arcsec per millennium
+    double const rate = std::sqrt(pmms) * dms::DegToRad / 3600.0;
+    Eigen::Vector3d const east(-sinRA, cosRA, 0);
+    Eigen::Vector3d const north(-sinDec * cosRA, -sinDec * sinRA, cosDec);
+
+    ProperMotionVector = (rate * (pmRA() / norm * east + pmDec() / norm * north)).cast<float>();
+}
+
 bool StarObject::getIndexCoords(const KSNumbers *num, CachingDms &ra, CachingDms &dec)
 {
     static double pmms;
@@ -467,7 +537,20 @@ void StarObject::JITupdate()
 
         updateNumID = data->updateNumID();
     }
-    EquatorialToHorizontal(data->lst(), data->geo()->lat());
+
+    // Same as EquatorialToHorizontal(), as one more rotation of the unit vector
+    double sinRA, cosRA, sinDec, cosDec;
+    ra().SinCos(sinRA, cosRA);
+    dec().SinCos(sinDec, cosDec);
+
+    Eigen::Vector3d const horizontal = KSUtils::equatorialToHorizontal(*data->lst(), *data->geo()->lat()) *
+                                       Eigen::Vector3d(cosDec * cosRA, cosDec * sinRA, sinDec);
+    dms newAlt, newAz;
+    newAlt.setRadians(asin(std::max(-1.0, std::min(1.0, horizontal.z()))));
+    newAz.setRadians(atan2(horizontal.y(), horizontal.x()));
+    setAlt(newAlt);
+    setAz(newAz.reduce());
+
     updateID = data->updateID();
 }
 
@@ -23,6 +23,18 @@
 
 #include <QString>
 
+#if __GNUC__ > 5
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wignored-attributes"
+#endif
+#if __GNUC__ > 6
+#pragma GCC diagnostic ignored "-Wint-in-bool-context"
+#endif
+#include <Eigen/Core>
+#if __GNUC__ > 5
+#pragma GCC diagnostic pop
+#endif
+
 struct DeepStarData;
 class KSNumbers;
 class KSPopupMenu;
@@ -172,6 +184,9 @@ class StarObject : public SkyObject
      * Determine the current coordinates (RA, Dec) from the catalog
      * coordinates (RA0, Dec0), accounting for both precession and nutation.
      *
+     * The computation is done in vector form, see apparentVector(), except for stars
+     * close enough to the Sun for the deflection of light to be applied.
+     *
      * @param num pointer to KSNumbers object containing current values of
      * time-dependent variables.
      * @param includePlanets does nothing in this implementation (see KSPlanetBase::updateCoords()).
@@ -196,6 +211,20 @@ class StarObject : public SkyObject
     /** @short added for JIT updates from both StarComponent and ConstellationLines */
     void JITupdate();
 
+    /**
+     * @short Compute the apparent direction of the star, accounting for proper motion,
+     * precession, nutation and aberration.
+     *
+     * This is the vector form of updateCoords(): the cached J2000 unit vector of the star is
+     * moved by its proper motion, rotated by the precession-nutation matrix of num, and
+     * aberrated. There is no trigonometry involved.
+     *
+     * @param num pointer to KSNumbers object containing current values of
+     * time-dependent variables.
+     * @return unit vector of the apparent equatorial coordinates of date
+     */
+    Eigen::Vector3d apparentVector(const KSNumbers *num) const;
+
     /** @short returns the magnitude of the proper motion correction in milliarcsec/year */
     inline double pmMagnitude() const
     {
@@ -223,6 +252,7 @@ class StarObject : public SkyObject
     {
         PM_RA  = pmra;
         PM_Dec = pmdec;
+        updateCartesian();
     }
 
     /** @return the RA component of the star's proper motion, in mas/yr (multiplied by cos(dec)) */
@@ -303,6 +333,9 @@ class StarObject : public SkyObject
     // END DEBUG
 
   private:
+    /** @short Compute the cached J2000 unit vector and proper motion vector, from the catalog coordinates */
+    void updateCartesian();
+
     double PM_RA { 0 };
     double PM_Dec { 0 };
     double Parallax { 0 };
@@ -314,4 +347,8 @@ class StarObject : public SkyObject
     // See init( const DeepStarData *); 2) This applies only to deep stars at the moment
     float B { 0 };
     float V { 0 };
+    // Unit vector of the catalog (J2000) coordinates
+    Eigen::Vector3d J2000Vector;
+    // Proper motion as a vector tangent to J2000Vector, in radians per Julian millennium
+    Eigen::Vector3f ProperMotionVector;
 };
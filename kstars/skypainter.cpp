@@ -27,6 +27,7 @@
 #include "skycomponents/linelistlabel.h"
 #include "skyobjects/deepskyobject.h"
 #include "skyobjects/kscomet.h"
+#include "skyobjects/starobject.h"
 #include "skyobjects/ksasteroid.h"
 #include "skyobjects/ksplanetbase.h"
 #include "skyobjects/trailobject.h"
@@ -42,6 +43,25 @@ void SkyPainter::setSizeMagLimit(float sizeMagLim)
     m_sizeMagLim = sizeMagLim;
 }
 
+int SkyPainter::drawPointSources(const QVector<StarObject *> &stars, QVector<bool> *drawn)
+{
+    int count = 0;
+
+    if (drawn)
+        drawn->resize(stars.size());
+
+    for (int i = 0; i < stars.size(); i++)
+    {
+        bool const isDrawn = drawPointSource(stars[i], stars[i]->mag(), stars[i]->spchar());
+        if (drawn)
+            (*drawn)[i] = isDrawn;
+        if (isDrawn)
+            count++;
+    }
+
+    return count;
+}
+
 float SkyPainter::starWidth(float mag) const
 {
     //adjust maglimit for ZoomLevel
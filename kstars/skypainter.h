@@ -24,6 +24,7 @@
 
 #include <QList>
 #include <QPainter>
+#include <QVector>
 
 class ConstellationsArt;
 class DeepSkyObject;
@@ -37,6 +38,7 @@ class SkipHashList;
 class SkyMap;
 class SkyObject;
 class SkyPoint;
+class StarObject;
 class Supernova;
 
 /**
@@ -128,6 +130,15 @@ class SkyPainter
      */
     virtual bool drawPointSource(SkyPoint *loc, float mag, char sp = 'A') = 0;
 
+    /**
+     * @short Draw a batch of stars as point sources.
+     * @param stars the stars to draw
+     * @param drawn if not null, receives whether each star was drawn
+     * @return the number of stars drawn
+     * @note The default implementation draws stars one at a time with drawPointSource().
+     */
+    virtual int drawPointSources(const QVector<StarObject *> &stars, QVector<bool> *drawn = nullptr);
+
     /**
      * @short Draw a deep sky object
      * @param obj the object to draw
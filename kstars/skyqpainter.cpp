@@ -24,6 +24,7 @@
 #include "kstarsdata.h"
 #include "Options.h"
 #include "skymap.h"
+#include "skymapprofiler.h"
 #include "projections/projector.h"
 #include "skycomponents/flagcomponent.h"
 #include "skycomponents/linelist.h"
@@ -39,6 +40,7 @@
 #include "skyobjects/kscomet.h"
 #include "skyobjects/kssun.h"
 #include "skyobjects/satellite.h"
+#include "skyobjects/starobject.h"
 #include "skyobjects/supernova.h"
 #include "skyobjects/ksearthshadow.h"
 #include "hips/hipsrenderer.h"
@@ -89,6 +91,16 @@ const int nSPclasses = 7;
 // These pixmaps are never deallocated. Not really good...
 QPixmap *imageCache[nSPclasses][nStarSizes] = { { nullptr } };
 
+// All star images packed in a single pixmap, one row per spectral class, so that
+// a batch of stars is drawn with a single call.
+std::unique_ptr<QPixmap> starAtlas;
+
+// Location of the image of a given spectral class and size in the star atlas
+QRectF starAtlasRect(int index, int size)
+{
+    return QRectF(size * (size - 1) / 2, index * nStarSizes, size, size);
+}
+
 std::unique_ptr<QPixmap> visibleSatPixmap, invisibleSatPixmap;
 }
 
@@ -110,6 +122,8 @@ void SkyQPainter::releaseImageCache()
             pmap[size] = nullptr;
         }
     }
+
+    starAtlas.reset();
 }
 
 SkyQPainter::SkyQPainter(QPaintDevice *pd) : SkyPainter(), QPainter()
@@ -263,6 +277,19 @@ void SkyQPainter::initStarImages()
     }
     starColorMode = Options::starColorMode();
 
+    starAtlas.reset(new QPixmap(nStarSizes * (nStarSizes - 1) / 2, nSPclasses * nStarSizes));
+    starAtlas->fill(Qt::transparent);
+
+    QPainter atlas;
+    atlas.begin(starAtlas.get());
+    for (char &color : ColorMap.keys())
+    {
+        int const index = harvardToIndex(color);
+        for (int size = 1; size < nStarSizes; size++)
+            atlas.drawPixmap(starAtlasRect(index, size).topLeft(), *imageCache[index][size]);
+    }
+    atlas.end();
+
     if (!visibleSatPixmap.get())
         visibleSatPixmap.reset(new QPixmap(":/icons/kstars_satellites_visible.svg"));
     if (!invisibleSatPixmap.get())
@@ -410,6 +437,7 @@ bool SkyQPainter::drawPlanet(KSPlanetBase *planet)
         return false;
 
     bool visible = false;
+    SkyMapProfiler::Instance()->count(SkyMapProfiler::PROJECTED);
     QPointF pos  = m_proj->toScreen(planet, true, &visible);
     if (!visible || !m_proj->onScreen(pos))
         return false;
@@ -468,6 +496,7 @@ bool SkyQPainter::drawPlanet(KSPlanetBase *planet)
             drawEllipse(pos, size * .5, size * .5);
         }
     }
+    SkyMapProfiler::Instance()->count(SkyMapProfiler::DRAWN);
     return true;
 }
 
@@ -505,6 +534,7 @@ bool SkyQPainter::drawComet(KSComet *com)
         size = 1;
 
     bool visible = false;
+    SkyMapProfiler::Instance()->count(SkyMapProfiler::PROJECTED);
     QPointF pos  = m_proj->toScreen(com, true, &visible);
 
     // Draw the coma. FIXME: Another Check??
@@ -549,6 +579,7 @@ bool SkyQPainter::drawComet(KSComet *com)
             restore();
         }
 
+        SkyMapProfiler::Instance()->count(SkyMapProfiler::DRAWN);
         return true;
     }
     else
@@ -564,12 +595,14 @@ bool SkyQPainter::drawPointSource(SkyPoint *loc, float mag, char sp)
         return false;
 
     bool visible = false;
+    SkyMapProfiler::Instance()->count(SkyMapProfiler::PROJECTED);
     QPointF pos  = m_proj->toScreen(loc, true, &visible);
     if (visible &&
             m_proj->onScreen(
                 pos)) // FIXME: onScreen here should use canvas size rather than SkyMap size, especially while printing in portrait mode!
     {
         drawPointSource(pos, starWidth(mag), sp);
+        SkyMapProfiler::Instance()->count(SkyMapProfiler::DRAWN);
         return true;
     }
     else
@@ -578,6 +611,47 @@ bool SkyQPainter::drawPointSource(SkyPoint *loc, float mag, char sp)
     }
 }
 
+int SkyQPainter::drawPointSources(const QVector<StarObject *> &stars, QVector<bool> *drawn)
+{
+    // Vector stars are only used for export, draw them one at a time
+    if ((m_vectorStars && starColorMode != 0) || !starAtlas)
+        return SkyPainter::drawPointSources(stars, drawn);
+
+    int const count = stars.size();
+
+    m_pointBatch.resize(count, 3);
+    for (int i = 0; i < count; i++)
+        Projector::setBatchPoint(m_pointBatch, i, stars[i]);
+
+    // FIXME: like drawPointSource(), this should use canvas size rather than SkyMap size
+    int const visibleCount = m_proj->toScreenBatch(m_pointBatch, m_screenBatch, m_visibleBatch);
+    SkyMapProfiler::Instance()->count(SkyMapProfiler::PROJECTED, count);
+
+    if (drawn)
+    {
+        drawn->resize(count);
+        for (int i = 0; i < count; i++)
+            (*drawn)[i] = m_visibleBatch(i);
+    }
+
+    m_starFragments.clear();
+    m_starFragments.reserve(visibleCount);
+    for (int i = 0; i < count; i++)
+    {
+        if (!m_visibleBatch(i))
+            continue;
+
+        int const isize = qBound(1, static_cast<int>(starWidth(stars[i]->mag())), nStarSizes - 1);
+        QPointF const pos(m_screenBatch(i, 0), m_screenBatch(i, 1));
+        m_starFragments.append(QPainter::PixmapFragment::create(pos, starAtlasRect(harvardToIndex(stars[i]->spchar()), isize)));
+    }
+
+    drawPixmapFragments(m_starFragments.constData(), m_starFragments.size(), *starAtlas);
+    SkyMapProfiler::Instance()->count(SkyMapProfiler::DRAWN, visibleCount);
+
+    return visibleCount;
+}
+
 void SkyQPainter::drawPointSource(const QPointF &pos, float size, char sp)
 {
     int isize = qMin(static_cast<int>(size), 14);
@@ -666,6 +740,7 @@ bool SkyQPainter::drawDeepSkyObject(DeepSkyObject *obj, bool drawImage)
         return false;
 
     bool visible = false;
+    SkyMapProfiler::Instance()->count(SkyMapProfiler::PROJECTED);
     QPointF pos  = m_proj->toScreen(obj, true, &visible);
     if (!visible || !m_proj->onScreen(pos))
         return false;
@@ -690,6 +765,7 @@ bool SkyQPainter::drawDeepSkyObject(DeepSkyObject *obj, bool drawImage)
     //Draw Symbol
     drawDeepSkySymbol(pos, obj->type(), size, obj->e(), positionAngle);
 
+    SkyMapProfiler::Instance()->count(SkyMapProfiler::DRAWN);
     return true;
 }
 
@@ -1020,6 +1096,7 @@ bool SkyQPainter::drawSatellite(Satellite *sat)
 
     //sat->HorizontalToEquatorial( data->lst(), data->geo()->lat() );
 
+    SkyMapProfiler::Instance()->count(SkyMapProfiler::PROJECTED);
     pos = m_proj->toScreen(sat, true, &visible);
 
     if (!visible || !m_proj->onScreen(pos))
@@ -1043,6 +1120,7 @@ bool SkyQPainter::drawSatellite(Satellite *sat)
         drawLine( QPoint( pos.x() - 0.5, pos.y() + 0.5 ), QPoint( pos.x() - 0.5, pos.y() - 0.5 ) );*/
     }
 
+    SkyMapProfiler::Instance()->count(SkyMapProfiler::DRAWN);
     return true;
 
     //if ( Options::showSatellitesLabels() )
@@ -1058,6 +1136,7 @@ bool SkyQPainter::drawSupernova(Supernova *sup)
     }
 
     bool visible = false;
+    SkyMapProfiler::Instance()->count(SkyMapProfiler::PROJECTED);
     QPointF pos  = m_proj->toScreen(sup, true, &visible);
     //qDebug()<<"sup->ra() = "<<(sup->ra()).toHMSString()<<"sup->dec() = "<<sup->dec().toDMSString();
     //qDebug()<<"pos = "<<pos<<"m_proj->onScreen(pos) = "<<m_proj->onScreen(pos);
@@ -1068,5 +1147,6 @@ bool SkyQPainter::drawSupernova(Supernova *sup)
     //qDebug()<<"Here";
     drawLine(QPoint(pos.x() - 2.0, pos.y()), QPoint(pos.x() + 2.0, pos.y()));
     drawLine(QPoint(pos.x(), pos.y() - 2.0), QPoint(pos.x(), pos.y() + 2.0));
+    SkyMapProfiler::Instance()->count(SkyMapProfiler::DRAWN);
     return true;
 }
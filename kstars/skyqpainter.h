@@ -20,6 +20,7 @@
 #pragma once
 
 #include "skypainter.h"
+#include "projections/projector.h"
 
 #include <QColor>
 #include <QMap>
@@ -87,6 +88,7 @@ class SkyQPainter : public SkyPainter, public QPainter
                          LineListLabel *label = nullptr) override;
     void drawSkyPolygon(LineList *list, bool forceClip = true) override;
     bool drawPointSource(SkyPoint *loc, float mag, char sp = 'A') override;
+    int drawPointSources(const QVector<StarObject *> &stars, QVector<bool> *drawn = nullptr) override;
     bool drawDeepSkyObject(DeepSkyObject *obj, bool drawImage = false) override;
     bool drawPlanet(KSPlanetBase *planet) override;
     bool drawEarthShadow(KSEarthShadow *shadow) override;
@@ -110,6 +112,11 @@ private:
     bool m_vectorStars { false };
     HIPSRenderer *m_hipsRender { nullptr };
     QSize m_size;
+    // Reused by drawPointSources()
+    Projector::PointBatch m_pointBatch;
+    Projector::ScreenBatch m_screenBatch;
+    Projector::VisibilityMask m_visibleBatch;
+    QVector<QPainter::PixmapFragment> m_starFragments;
     static int starColorMode;
     static QColor m_starColor;
     static QMap<char, QColor> ColorMap;
@@ -475,6 +475,20 @@ void ObsListWizard::applyFilters(bool doBuildList)
             ObjectCount -= StarCount;
             ObjectCount += starIndex;
         }
+
+        //There may be thousands of stars to filter by constellation, so look them up at once
+        if (needRegion && isItemSelected(i18n("by constellation"), olw->RegionList))
+        {
+            QList<SkyPoint *> points;
+            points.reserve(starIndex);
+            for (int i = 0; i < starIndex; ++i)
+                points.append(starList[i]);
+
+            QStringList const names = data->skyComposite()->constellationBoundary()->constellationName(points);
+            for (int i = 0; i < starIndex; ++i)
+                ConstellationNames.insert(starList[i], names[i]);
+        }
+
         for (int i = 0; i < starIndex; ++i)
         {
             SkyObject *o = (SkyObject *)(starList[i]);
@@ -493,6 +507,8 @@ void ObsListWizard::applyFilters(bool doBuildList)
             if (olw->SelectByDate->isChecked() && filterPass)
                 applyObservableFilter(o, doBuildList, !doBuildList);
         }
+
+        ConstellationNames.clear();
     }
 
     //Sun, Moon, Planets
@@ -822,7 +838,9 @@ bool ObsListWizard::applyRegionFilter(SkyObject *o, bool doBuildList, bool doAdj
     //select by constellation
     if (isItemSelected(i18n("by constellation"), olw->RegionList))
     {
-        QString c = KStarsData::Instance()->skyComposite()->constellationBoundary()->constellationName(o);
+        auto const known = ConstellationNames.constFind(o);
+        QString c = (known != ConstellationNames.constEnd()) ?
+                    known.value() : KStarsData::Instance()->skyComposite()->constellationBoundary()->constellationName(o);
 
         if (isItemSelected(c, olw->ConstellationList))
         {
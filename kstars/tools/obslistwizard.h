@@ -20,6 +20,7 @@
 #include "skyobjects/skypoint.h"
 
 #include <QDialog>
+#include <QHash>
 
 class QListWidget;
 class QPushButton;
@@ -97,6 +98,8 @@ class ObsListWizard : public QDialog
     void setItemSelected(const QString &name, QListWidget *listWidget, bool value, bool *ok = nullptr);
 
     QList<SkyObject *> ObsList;
+    /** Constellations of the stars being filtered, looked up in one batch */
+    QHash<SkyObject *, QString> ConstellationNames;
     ObsListWizardUI *olw { nullptr };
     uint ObjectCount { 0 };
     uint StarCount { 0 };